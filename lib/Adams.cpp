@@ -0,0 +1,320 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+
+#include "Adams.h"
+#include "ExplicitRK.h"
+#include "Trace.h"
+
+namespace OrangeDrumExplorer{
+
+    namespace {
+        // Derivatives of the last steps in a fixed ring of vectors, the newest first
+        class History {
+            private:
+                vec times;
+                std::vector<vec> derivatives;
+                size_t newest = 0;
+                size_t count = 0;
+            public:
+                History(size_t capacity, size_t n)
+                    : times(capacity), derivatives(capacity, vec(n))
+                {}
+                // Slot of the derivative at t, overwrites the oldest one when full
+                vec& push(double t){
+                    newest = (newest + 1) % times.size();
+                    count = std::min(count + 1, times.size());
+                    times[newest] = t;
+                    return derivatives[newest];
+                }
+                size_t size() const {
+                    return count;
+                }
+                // j = 0 is the newest
+                double time(size_t j) const {
+                    return times[(newest + times.size() - j) % times.size()];
+                }
+                const vec& derivative(size_t j) const {
+                    return derivatives[(newest + times.size() - j) % times.size()];
+                }
+        };
+
+        // Gauss-Legendre rule with 7 points on [0, 1], exact up to degree 13
+        const std::array<double, 7> gauss_nodes = {
+            0.5 - 0.4745539561713792, 0.5 - 0.3707655927996972, 0.5 - 0.2029225756886986, 0.5,
+            0.5 + 0.2029225756886986, 0.5 + 0.3707655927996972, 0.5 + 0.4745539561713792};
+        const std::array<double, 7> gauss_weights = {
+            0.0647424830771353, 0.1398526957446383, 0.1909150252525595, 0.2089795918367347,
+            0.1909150252525595, 0.1398526957446383, 0.0647424830771353};
+
+        /**
+         * Integrals w_j of the Lagrange polynomials through the nodes s_0..s_{m-1} from 0 to upper,
+         * so that the integral of the polynomial through (s_j, f_j) is sum_j w_j*f_j
+         *
+         * The polynomials are evaluated in product form at the quadrature points, which stays
+         * accurate for unequal and widely spread nodes.
+         */
+        void integrate_lagrange(const double* s, size_t m, double upper, double* w){
+            std::fill(w, w + m, 0.);
+            for (size_t q = 0; q < gauss_nodes.size(); ++q){
+                const double x = upper*gauss_nodes[q];
+                for (size_t j = 0; j < m; ++j){
+                    double L = 1.;
+                    for (size_t i = 0; i < m; ++i){
+                        if (i != j){
+                            L *= (x - s[i])/(s[j] - s[i]);
+                        }
+                    }
+                    w[j] += upper*gauss_weights[q]*L;
+                }
+            }
+        }
+
+        /**
+         * out = y + h*sum_j w_j*f_j over the m derivatives history.derivative(first + j), whose
+         * times relative to t in units of h are the nodes s_j
+         */
+        void adams_sum(const History& history, size_t first, size_t m, double t, double h, double upper,
+                       const vec& y, vec& out){
+            std::array<double, AdamsPECE::highest_order + 2> s, w;
+            std::array<const double*, AdamsPECE::highest_order + 2> f;
+            for (size_t j = 0; j < m; ++j){
+                s[j] = (history.time(first + j) - t)/h;
+                f[j] = history.derivative(first + j).data();
+            }
+            integrate_lagrange(s.data(), m, upper, w.data());
+            for (size_t i = 0; i < y.size(); ++i){
+                double sum = 0.;
+                for (size_t j = 0; j < m; ++j){
+                    sum += w[j]*f[j][i];
+                }
+                out[i] = y[i] + h*sum;
+            }
+        }
+
+        // Root mean square of (x - z)/(absolute + relative*max(|y|, |y_new|))
+        double error_norm(const vec& x, const vec& z, const vec& y, const vec& y_new, double relative,
+                          double absolute){
+            double sum = 0.;
+            for (size_t i = 0; i < x.size(); ++i){
+                const double scale = absolute + relative*std::max(std::abs(y[i]), std::abs(y_new[i]));
+                const double e = (x[i] - z[i])/scale;
+                sum += e*e;
+            }
+            return x.empty() ? 0. : std::sqrt(sum/x.size());
+        }
+
+        // Factor of the next step size for a local error estimate of a method of the given order
+        double step_factor(double error, size_t order){
+            if (!(error > 0.)){
+                return std::isnan(error) ? 0.2 : 2.;
+            }
+            return std::min(2., std::max(0.2, 0.9*std::pow(error, -1./(order + 1))));
+        }
+    }
+
+    void AdamsPECE::set_tolerances(double relative, double absolute){
+        if (relative < 0. || absolute <= 0.){
+            throw std::invalid_argument("The absolute tolerance has to be positive, the relative one non-negative");
+        }
+        relative_tolerance = relative;
+        absolute_tolerance = absolute;
+    }
+
+    void AdamsPECE::set_max_order(size_t order){
+        if (order < 1 || order > highest_order){
+            throw std::invalid_argument("The order of the Adams method has to be between 1 and 12");
+        }
+        max_order = order;
+    }
+
+    AdamsPECE::Statistics AdamsPECE::get_statistics(){
+        return statistics;
+    }
+
+    vec AdamsPECE::solve(sysfunc dydt, const vec& y0, const sink& output){
+        const double a = limit_low;
+        const double b = limit_high;
+        const double dt = time_step;
+        const size_t N = (b-a)/dt;
+        const size_t n = y0.size();
+        const double rtol = relative_tolerance;
+        const double atol = absolute_tolerance;
+        statistics = Statistics();
+        auto f = [&dydt, this](double t, const vec& y, vec& dydt_out){
+            ++statistics.evaluations;
+            dydt(t, y, dydt_out);
+        };
+
+        History history(max_order + 1, n);
+        vec y = y0;
+        vec predicted(n), corrected(n), derivative(n), estimate(n), interpolated(n);
+        double t = a;
+        f(t, y, history.push(t));
+        output(a, y);
+        size_t next = 1;
+        // the grid point next is reached by a step ending within round-off of it
+        const double reach = 1e-9*dt;
+
+        // initial step size, Hairer, Norsett and Wanner, Solving ODE I, II.4, for order 4
+        double h;
+        {
+            const vec zero(n, 0.);
+            const vec& f0 = history.derivative(0);
+            const double d0 = error_norm(y, zero, y, y, rtol, atol);
+            const double d1 = error_norm(f0, zero, y, y, rtol, atol);
+            double h0 = (d0 < 1e-5 || d1 < 1e-5) ? 1e-6 : 0.01*d0/d1;
+            h0 = std::min(h0, b - a);
+            for (size_t i = 0; i < n; ++i){
+                estimate[i] = y[i] + h0*f0[i];
+            }
+            f(t + h0, estimate, derivative);
+            const double d2 = error_norm(derivative, f0, y, y, rtol, atol)/h0;
+            const double d = std::max(d1, d2);
+            const double h1 = d <= 1e-15 ? std::max(1e-6, 1e-3*h0) : std::pow(0.01/d, 1./5.);
+            h = std::min(100.*h0, h1);
+        }
+
+        // Runge-Kutta steps until the history holds the derivatives of the starting order
+        const size_t start_order = std::min<size_t>(4, max_order);
+        typedef ExplicitRK<Tableaus::rk4> Starter;
+        std::array<vec, Starter::stages> stages;
+        for (vec& k : stages){
+            k.resize(n);
+        }
+
+        size_t order = start_order;
+        size_t steps_at_order = 0;
+        bool failed = false;
+        while (t < b && !failed){
+            ODE_TRACE_SCOPE("step");
+            // don't leave a sliver before the upper limit
+            if (t + 1.1*h >= b){
+                h = b - t;
+            }
+            if (h <= 1e-14*std::max(std::abs(t), b - a)){
+                failed = true;
+                break;
+            }
+            if (history.size() < start_order){
+                // one-step start, the derivative at the new point completes the history
+                corrected = y;
+                Starter::advance(f, t, h, corrected, estimate, stages);
+                vec& derivative_new = history.push(t + h);
+                f(t + h, corrected, derivative_new);
+                ++statistics.steps;
+                // cubic Hermite interpolation between the two points
+                const vec& derivative_old = history.derivative(1);
+                for (; next <= N && a + next*dt <= t + h + reach; ++next){
+                    const double theta = std::min(1., (a + next*dt - t)/h);
+                    const double h00 = (1. + 2.*theta)*(1. - theta)*(1. - theta);
+                    const double h10 = theta*(1. - theta)*(1. - theta);
+                    const double h01 = theta*theta*(3. - 2.*theta);
+                    const double h11 = theta*theta*(theta - 1.);
+                    for (size_t i = 0; i < n; ++i){
+                        interpolated[i] = h00*y[i] + h10*h*derivative_old[i] + h01*corrected[i]
+                                          + h11*h*derivative_new[i];
+                    }
+                    output(a + next*dt, interpolated);
+                }
+                t += h;
+                y.swap(corrected);
+                continue;
+            }
+
+            // P: Adams-Bashforth of order k through the derivatives at the last k points
+            adams_sum(history, 0, order, t, h, 1., y, predicted);
+            // E
+            f(t + h, predicted, derivative);
+            // C: Adams-Moulton of order k+1, with the predicted derivative at t + h
+            {
+                std::array<double, highest_order + 2> s, w;
+                s[0] = 1.;
+                for (size_t j = 0; j < order; ++j){
+                    s[j+1] = (history.time(j) - t)/h;
+                }
+                integrate_lagrange(s.data(), order + 1, 1., w.data());
+                for (size_t i = 0; i < n; ++i){
+                    double sum = w[0]*derivative[i];
+                    for (size_t j = 0; j < order; ++j){
+                        sum += w[j+1]*history.derivative(j)[i];
+                    }
+                    corrected[i] = y[i] + h*sum;
+                }
+            }
+            const double error = error_norm(corrected, predicted, y, corrected, rtol, atol);
+            if (!(error <= 1.)){
+                ++statistics.rejected;
+                double factor = step_factor(error, order);
+                if (order > 1){
+                    // the next lower order may take a larger step
+                    adams_sum(history, 0, order - 1, t, h, 1., y, estimate);
+                    const double lower = step_factor(error_norm(corrected, estimate, y, corrected, rtol, atol), order - 1);
+                    if (lower > factor){
+                        factor = lower;
+                        --order;
+                        steps_at_order = 0;
+                    }
+                }
+                h *= std::min(factor, 0.9);
+                continue;
+            }
+
+            // E: the derivative at the accepted point enters the history
+            const double t_new = t + h;
+            f(t_new, corrected, history.push(t_new));
+            ++statistics.steps;
+            ++steps_at_order;
+
+            // interpolate the corrector polynomial through the new derivative onto the grid
+            for (; next <= N && a + next*dt <= t_new + reach; ++next){
+                const double theta = (a + next*dt - t)/h;
+                if (theta >= 1.){
+                    output(a + next*dt, corrected);
+                    continue;
+                }
+                adams_sum(history, 0, order + 1, t, h, theta, y, interpolated);
+                output(a + next*dt, interpolated);
+            }
+
+            // the errors of the other orders, from the predictors of the step just taken
+            double factor = step_factor(error, order);
+            size_t new_order = order;
+            if (order > 1){
+                adams_sum(history, 1, order - 1, t, h, 1., y, estimate);
+                const double lower = step_factor(error_norm(corrected, estimate, y, corrected, rtol, atol), order - 1);
+                if (lower > factor){
+                    factor = lower;
+                    new_order = order - 1;
+                }
+            }
+            if (order < max_order && history.size() >= order + 2 && steps_at_order > order){
+                // predictor of order k+1 against the corrector of order k+2 through the new derivative
+                adams_sum(history, 1, order + 1, t, h, 1., y, estimate);
+                adams_sum(history, 0, order + 2, t, h, 1., y, predicted);
+                const double higher = step_factor(error_norm(predicted, estimate, y, corrected, rtol, atol), order + 1);
+                if (higher > 1.1*factor){
+                    factor = higher;
+                    new_order = order + 1;
+                }
+            }
+            if (new_order != order){
+                order = new_order;
+                steps_at_order = 0;
+            }
+            t = t_new;
+            y.swap(corrected);
+            h *= std::max(factor, 0.5);
+        }
+        if (failed){
+            std::fill(y.begin(), y.end(), std::nan(""));
+        }
+        // grid points within round-off of the upper limit
+        for (; next <= N; ++next){
+            output(a + next*dt, y);
+        }
+        return y;
+    }
+
+}
@@ -0,0 +1,63 @@
+#ifndef ORANGE_DRUM_EXPLORER_ADAMS_H
+#define ORANGE_DRUM_EXPLORER_ADAMS_H
+
+#include <cstddef>
+
+#include "Solver.h"
+
+namespace OrangeDrumExplorer
+{
+    /**
+     * Variable step, variable order Adams-Bashforth-Moulton method in PECE mode.\n
+     *
+     * Every step predicts with the Adams-Bashforth formula of order k, evaluates the system,
+     * corrects with the Adams-Moulton formula of order k+1 and evaluates again, two evaluations of
+     * the system per step at any order. The formulas are integrals of the polynomial through the
+     * derivatives of the last steps, at their actual (unequal) spacing; the derivatives are kept
+     * in a ring buffer of max_order + 1 vectors. The corrector minus the predictor estimates the
+     * local error, and the step size and the order (1 to max_order) are chosen to take the
+     * largest next step within the tolerances. The method starts with classic Runge-Kutta steps
+     * of order 4 until enough derivatives are known.
+     *
+     * The steps don't follow time_step, it's the spacing of the stored solution only, which is
+     * interpolated between the steps. Non-stiff problems only: on stiff ones the step size is
+     * bounded by stability and not by the tolerances.
+     */
+    class AdamsPECE : public StreamingSolver {
+        public:
+            static constexpr size_t highest_order = 12;
+            // Work of the last solve
+            struct Statistics {
+                size_t steps = 0;
+                size_t rejected = 0;
+                size_t evaluations = 0;
+            };
+
+            using StreamingSolver::StreamingSolver;
+            using StreamingSolver::solve;
+            /**
+             * Tolerances of the local error, per component |error_i| <= absolute + relative*|y_i| in the
+             * root mean square over the components
+             */
+            void set_tolerances(double relative, double absolute);
+            // Highest order of the Adams-Bashforth predictor, 1 to highest_order
+            void set_max_order(size_t);
+            Statistics get_statistics();
+            /**
+             * Solve a system without storing the solution
+             *
+             * @param output - called with the initial state and the state interpolated every time_step;
+             *      the state is only valid during the call
+             * @return the state at the upper limit, NaN if the step size underflows
+             */
+            vec solve(sysfunc dydt, const vec& y0, const sink& output) override;
+
+        protected:
+            double relative_tolerance = 1e-6;
+            double absolute_tolerance = 1e-8;
+            size_t max_order = highest_order;
+            Statistics statistics;
+    };
+}
+
+#endif /*ORANGE_DRUM_EXPLORER_ADAMS_H*/
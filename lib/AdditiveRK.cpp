@@ -0,0 +1,445 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "AdditiveRK.h"
+#include "LinearSolver.h"
+#include "Trace.h"
+
+namespace OrangeDrumExplorer{
+
+    namespace {
+        // simplified Newton iterations of a stage before the Jacobian is evaluated again
+        const size_t stage_iterations = 10;
+        // a stage has converged at this fraction of the tolerances of the step control
+        const double stage_tolerance = 0.01;
+    }
+
+    AdditiveRK::Tableau AdditiveRK::imex_euler(){
+        return {{{},
+                 {1.}},
+                {{0.},
+                 {0., 1.}},
+                {1., 0.},
+                {0., 1.},
+                {},
+                {},
+                {0., 1.},
+                1, 0};
+    }
+
+    AdditiveRK::Tableau AdditiveRK::ars222(){
+        const double g = 1. - std::sqrt(2.)/2.;
+        const double d = 1. - 1./(2.*g);
+        return {{{},
+                 {g},
+                 {d, 1. - d}},
+                {{0.},
+                 {0., g},
+                 {0., 1. - g, g}},
+                {d, 1. - d, 0.},
+                {0., 1. - g, g},
+                {},
+                {},
+                {0., g, 1.},
+                2, 0};
+    }
+
+    AdditiveRK::Tableau AdditiveRK::ars443(){
+        return {{{},
+                 {1./2.},
+                 {11./18., 1./18.},
+                 {5./6., -5./6., 1./2.},
+                 {1./4., 7./4., 3./4., -7./4.}},
+                {{0.},
+                 {0., 1./2.},
+                 {0., 1./6., 1./2.},
+                 {0., -1./2., 1./2., 1./2.},
+                 {0., 3./2., -3./2., 1./2., 1./2.}},
+                {1./4., 7./4., 3./4., -7./4., 0.},
+                {0., 3./2., -3./2., 1./2., 1./2.},
+                {},
+                {},
+                {0., 1./2., 2./3., 1./2., 1.},
+                3, 0};
+    }
+
+    AdditiveRK::Tableau AdditiveRK::ark324(){
+        const double g = 1767732205903./4055673282236.;
+        const vec b = {1471266399579./7840856788654., -4482444167858./7529755066697.,
+                       11266239266428./11593286722821., g};
+        const vec b_hat = {2756255671327./12835298489170., -10771552573575./22201958757719.,
+                           9247589265047./10645013368117., 2193209047091./5459859503100.};
+        return {{{},
+                 {1767732205903./2027836641118.},
+                 {5535828885825./10492691773637., 788022342437./10882634858940.},
+                 {6485989280629./16251701735622., -4246266847089./9704473918619., 10755448449292./10357097424841.}},
+                {{0.},
+                 {g, g},
+                 {2746238789719./10658868560708., -640167445237./6845629431997., g},
+                 b},
+                b,
+                b,
+                b_hat,
+                b_hat,
+                {0., 1767732205903./2027836641118., 3./5., 1.},
+                3, 2};
+    }
+
+    AdditiveRK::AdditiveRK()
+        : AdditiveRK(0., 1.)
+    {}
+
+    AdditiveRK::AdditiveRK(double low, double high, Tableau new_tableau)
+        : DiagonallyImplicitRK(low, high)
+    {
+        set_tableau(new_tableau);
+    }
+
+    void AdditiveRK::set_tableau(const Tableau& new_tableau){
+        set_pair(new_tableau);
+    }
+
+    DiagonallyImplicitRK::DiagonallyImplicitRK(double low, double high)
+        : EulerImplicit(low, high)
+    {
+        // the stages are solved to the accuracy of the higher orders
+        threshold = 1e-10;
+    }
+
+    void DiagonallyImplicitRK::set_pair(const Tableau& new_tableau){
+        const size_t s = new_tableau.c.size();
+        if (s == 0 || new_tableau.a_explicit.size() != s || new_tableau.a_implicit.size() != s
+            || new_tableau.b_explicit.size() != s || new_tableau.b_implicit.size() != s){
+            throw std::invalid_argument("The tableau needs both a, both b and c for every stage");
+        }
+        if (new_tableau.b_hat_explicit.size() != new_tableau.b_hat_implicit.size()
+            || (!new_tableau.b_hat_explicit.empty() && new_tableau.b_hat_explicit.size() != s)){
+            throw std::invalid_argument("The embedded weights are given for every stage of both tableaus, or not at all");
+        }
+        for (size_t i = 0; i < s; ++i){
+            if (new_tableau.a_explicit[i].size() != i || new_tableau.a_implicit[i].size() != i + 1){
+                throw std::invalid_argument("Row i of the tableaus needs aE_i0 to aE_i(i-1) and aI_i0 to aI_ii");
+            }
+        }
+        const double diagonal = new_tableau.a_implicit[s-1][s-1];
+        for (size_t i = 0; i < s; ++i){
+            const double a_ii = new_tableau.a_implicit[i][i];
+            if (diagonal <= 0. || (a_ii != diagonal && !(i == 0 && a_ii == 0.))){
+                throw std::invalid_argument("The diagonal needs a single gamma > 0, only the first stage may be explicit");
+            }
+        }
+        tableau = new_tableau;
+        gamma = diagonal;
+    }
+
+    void DiagonallyImplicitRK::set_tolerances(double relative, double absolute){
+        if (relative < 0. || absolute < 0. || (absolute == 0. && relative != 0.)){
+            throw std::invalid_argument("The absolute tolerance has to be positive, or both 0 for fixed steps");
+        }
+        relative_tolerance = relative;
+        absolute_tolerance = absolute;
+    }
+
+    DiagonallyImplicitRK::Statistics DiagonallyImplicitRK::get_statistics(){
+        return statistics;
+    }
+
+    vec& AdditiveRK::solve(adfunc stiff, func nonstiff_part, const vec& y0){
+        // the lower derivatives of the companion system belong to the stiff part
+        nonstiff = [nonstiff_part](double t, const vec& y, vec& dydt){
+            const size_t n = y.size();
+            std::fill(dydt.begin(), dydt.end() - 1, 0.);
+            dydt[n-1] = nonstiff_part(t, y);
+        };
+        try{
+            EulerImplicit::solve(stiff, y0);
+        }
+        catch (...){
+            nonstiff = nullptr;
+            throw;
+        }
+        nonstiff = nullptr;
+        return result;
+    }
+
+    vec& AdditiveRK::solve(adsysfunc stiff, sysfunc nonstiff_part, const vec& y0){
+        nonstiff = nonstiff_part;
+        try{
+            EulerImplicit::solve(stiff, y0);
+        }
+        catch (...){
+            nonstiff = nullptr;
+            throw;
+        }
+        nonstiff = nullptr;
+        return result;
+    }
+
+    void DiagonallyImplicitRK::integrate(const linearization& f, const vec& y0, size_t stored, const Sparsity& pattern,
+                               LinearSolver& solver, size_t jacobian_size){
+        const bool adaptive = absolute_tolerance > 0.;
+        if (adaptive && tableau.b_hat_implicit.empty()){
+            throw std::invalid_argument("The step control needs a tableau with embedded weights");
+        }
+        const double a = limit_low;
+        const double dt = time_step;
+        const size_t N = (limit_high - limit_low)/dt;
+        const double end = a + N*dt;
+        const size_t n = y0.size();
+        const size_t s = tableau.c.size();
+        const bool explicit_first = tableau.a_implicit[0][0] == 0.;
+        // the non-stiff part is only evaluated at the stages whose derivative has a weight
+        std::vector<bool> weighted(s, false);
+        for (size_t i = 0; i < s; ++i){
+            weighted[i] = tableau.b_explicit[i] != 0. || (adaptive && tableau.b_hat_explicit[i] != 0.);
+            for (size_t l = i + 1; l < s; ++l){
+                weighted[i] = weighted[i] || tableau.a_explicit[l][i] != 0.;
+            }
+        }
+        statistics = Statistics();
+        state_size = stored;
+        result.resize((N+1)*stored);
+        std::copy(y0.begin(), y0.begin() + stored, result.begin());
+        // grid points stored so far
+        size_t written = 1;
+
+        // J is evaluated with f0 at the start of every step, `none` only evaluates f; J_start keeps
+        // the Jacobian of the start while J holds the one of a stage
+        vec J(jacobian_size), J_start, none;
+        bool refreshed = false;
+        vec y = y0, y_new(n), f0(n), x0(n), x(n), fx(n), F(n), delta(n), err(n), err_explicit(n), filtered(n);
+        // stage derivatives of the implicit and the explicit part
+        std::vector<vec> k_implicit(s, vec(n)), k_explicit(s, vec(n, 0.));
+        double t = a;
+        double h = dt;
+        double gh = gamma*h;
+
+        // error weight of the step control
+        auto weight = [this](double magnitude){ return absolute_tolerance + relative_tolerance*magnitude; };
+        auto explicit_part = [&](size_t i, double ti, const vec& xi, vec& k){
+            if (nonstiff && weighted[i]){
+                ++statistics.nonstiff_evaluations;
+                nonstiff(ti, xi, k);
+            }
+        };
+        // x = x0 + gh*f(ti, x) by simplified Newton with the last factorization, false if it doesn't converge;
+        // `full` takes the Jacobian in every iteration up to max_iterations as NewtonSolve, keeping the last iterate
+        auto newton = [&](double ti, bool full) -> bool {
+            double previous = 0.;
+            for (size_t iter = 0; iter < (full ? max_iterations : stage_iterations); ++iter){
+                ++statistics.newton_iterations;
+                if (full){
+                    f(ti, x, fx, J);
+                    ++statistics.jacobians;
+                    ++statistics.factorizations;
+                    if (!solver.factorize(J, n, gh, pattern)){
+                        return false;
+                    }
+                }
+                else{
+                    f(ti, x, fx, none);
+                }
+                for (size_t j = 0; j < n; ++j){
+                    F[j] = x0[j] + gh*fx[j] - x[j];
+                }
+                if (!solver.solve(F, delta)){
+                    return false;
+                }
+                double norm = 0.;
+                for (size_t j = 0; j < n; ++j){
+                    if (std::isnan(delta[j])){
+                        return false;
+                    }
+                    x[j] -= delta[j];
+                    if (adaptive){
+                        const double scaled = delta[j]/weight(std::abs(x[j]));
+                        norm += scaled*scaled;
+                    }
+                    else{
+                        norm = std::max(norm, std::abs(delta[j]));
+                    }
+                }
+                norm = adaptive ? std::sqrt(norm/n) : norm;
+                if (norm < (adaptive ? stage_tolerance : threshold)){
+                    return true;
+                }
+                if (iter > 0 && norm >= previous && !full){
+                    // no contraction, the Jacobian is too far off
+                    return false;
+                }
+                previous = norm;
+            }
+            return full;
+        };
+        // the stages of a step of h from (t, y), y_new and the error estimate; false if a stage diverges
+        auto stages = [&]() -> bool {
+            gh = gamma*h;
+            ++statistics.factorizations;
+            if (!solver.factorize(J, n, gh, pattern)){
+                return false;
+            }
+            for (size_t i = 0; i < s; ++i){
+                const double ti = t + tableau.c[i]*h;
+                if (i == 0 && explicit_first){
+                    k_implicit[0] = f0;
+                    explicit_part(0, ti, y, k_explicit[0]);
+                    continue;
+                }
+                const vec& previous = i == 0 ? f0 : k_implicit[i-1];
+                for (size_t j = 0; j < n; ++j){
+                    double sum = 0.;
+                    for (size_t l = 0; l < i; ++l){
+                        sum += tableau.a_explicit[i][l]*k_explicit[l][j] + tableau.a_implicit[i][l]*k_implicit[l][j];
+                    }
+                    x0[j] = y[j] + h*sum;
+                    x[j] = x0[j] + gh*previous[j];
+                }
+                ODE_TRACE_SCOPE("stage");
+                while (!newton(ti, false)){
+                    if (refreshed){
+                        // fixed steps can't shrink, they fall back to full Newton iterations
+                        x = x0;
+                        if (adaptive || !newton(ti, true)){
+                            return false;
+                        }
+                        break;
+                    }
+                    // Jacobian at the stage instead of the start of the step, once per step
+                    x = x0;
+                    J_start = J;
+                    refreshed = true;
+                    f(ti, x, fx, J);
+                    ++statistics.jacobians;
+                    ++statistics.factorizations;
+                    if (!solver.factorize(J, n, gh, pattern)){
+                        return false;
+                    }
+                }
+                for (size_t j = 0; j < n; ++j){
+                    k_implicit[i][j] = (x[j] - x0[j])/gh;
+                }
+                explicit_part(i, ti, x, k_explicit[i]);
+            }
+            for (size_t j = 0; j < n; ++j){
+                double sum = 0., difference = 0., difference_explicit = 0.;
+                for (size_t i = 0; i < s; ++i){
+                    sum += tableau.b_explicit[i]*k_explicit[i][j] + tableau.b_implicit[i]*k_implicit[i][j];
+                    if (adaptive){
+                        difference += (tableau.b_implicit[i] - tableau.b_hat_implicit[i])*k_implicit[i][j];
+                        difference_explicit += (tableau.b_explicit[i] - tableau.b_hat_explicit[i])*k_explicit[i][j];
+                    }
+                }
+                y_new[j] = y[j] + h*sum;
+                err[j] = h*difference;
+                err_explicit[j] = h*difference_explicit;
+            }
+            return true;
+        };
+        // one step of h from (t, y) into y_new, and the filtered error estimate; false if a stage diverges
+        auto step = [&]() -> bool {
+            ODE_TRACE_SCOPE("step");
+            refreshed = false;
+            const bool solved = stages();
+            if (refreshed){
+                // the retry of a rejected step and the filter factorize the Jacobian of the start again
+                J.swap(J_start);
+                if (solved && adaptive){
+                    ++statistics.factorizations;
+                    if (!solver.factorize(J, n, gh, pattern)){
+                        return false;
+                    }
+                }
+            }
+            if (!solved){
+                return false;
+            }
+            if (adaptive){
+                // (I - gh*J)^-1 damps the stiff components of the implicit part; the explicit part
+                // is added after the last stage solve, its error isn't damped at the end of the step
+                if (solver.solve(err, filtered)){
+                    for (size_t j = 0; j < n; ++j){
+                        filtered[j] = err_explicit[j] - filtered[j];
+                    }
+                }
+                else{
+                    for (size_t j = 0; j < n; ++j){
+                        filtered[j] = err[j] + err_explicit[j];
+                    }
+                }
+            }
+            return true;
+        };
+
+        if (!adaptive){
+            for (size_t i = 0; i < N; ++i){
+                t = a + i*dt;
+                f(t, y, f0, J);
+                ++statistics.jacobians;
+                if (!step()){
+                    std::fill(result.begin() + written*stored, result.end(), std::nan(""));
+                    break;
+                }
+                ++statistics.steps;
+                y.swap(y_new);
+                std::copy(y.begin(), y.begin() + stored, result.begin() + (written++)*stored);
+            }
+            has_been_solved = true;
+            return;
+        }
+
+        const int q = std::min(tableau.order, tableau.embedded_order);
+        // proposed step size, cut to end on the next grid point
+        double proposal = dt;
+        f(t, y, f0, J);
+        ++statistics.jacobians;
+        while (written <= N){
+            const double grid = written == N ? end : a + written*dt;
+            const bool cut = proposal >= grid - t;
+            h = cut ? grid - t : proposal;
+            double factor = 0.25;
+            bool accepted = false;
+            if (step()){
+                double error = 0.;
+                for (size_t j = 0; j < n; ++j){
+                    const double scaled = filtered[j]/weight(std::max(std::abs(y[j]), std::abs(y_new[j])));
+                    error += scaled*scaled;
+                }
+                error = std::sqrt(error/n);
+                factor = error == 0. ? 5. : 0.9*std::pow(error, -1./(q + 1));
+                factor = std::isnan(factor) ? 0.2 : std::min(5., std::max(0.2, factor));
+                accepted = error <= 1.;
+            }
+            if (!accepted){
+                ++statistics.rejected;
+                proposal = h*std::min(factor, 0.9);
+                if (proposal < 1e-14*std::max(1., std::abs(t))){
+                    std::fill(result.begin() + written*stored, result.end(), std::nan(""));
+                    break;
+                }
+                continue;
+            }
+            ++statistics.steps;
+            y.swap(y_new);
+            // a step cut short by the grid doesn't shrink the next one
+            proposal = cut ? std::max(proposal, h*factor) : h*factor;
+            if (cut){
+                t = grid;
+                std::copy(y.begin(), y.begin() + stored, result.begin() + (written++)*stored);
+            }
+            else{
+                t += h;
+            }
+            if (written <= N){
+                f(t, y, f0, J);
+                ++statistics.jacobians;
+            }
+        }
+        has_been_solved = true;
+    }
+
+    void DiagonallyImplicitRK::integrate(JacobianProduct&, const vec&, size_t){
+        throw std::invalid_argument("The diagonally implicit methods factorize the Newton matrix, Newton-Krylov isn't supported");
+    }
+
+}
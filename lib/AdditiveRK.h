@@ -0,0 +1,146 @@
+#ifndef ORANGE_DRUM_EXPLORER_ADDITIVE_RK_H
+#define ORANGE_DRUM_EXPLORER_ADDITIVE_RK_H
+
+#include <cstddef>
+#include <vector>
+
+#include "Solver.h"
+
+namespace OrangeDrumExplorer
+{
+    /**
+     * Stages and step size control of the diagonally implicit Runge-Kutta methods, shared by AdditiveRK
+     * and SDIRK.\n
+     *
+     * Stage i solves
+     *   Y_i = y + dt*sum_{j<i} (aE_ij*f_nonstiff(Y_j) + aI_ij*f_stiff(Y_j)) + gamma*dt*f_stiff(t + c_i*dt, Y_i),
+     * one implicit Euler step of length gamma*dt each. All stages share the diagonal gamma, so the Newton
+     * matrix gamma*dt*J - I is the same for every stage: one Jacobian and one factorization per step at
+     * its start, simplified Newton iterations for the stages. If a stage doesn't converge, the Jacobian is
+     * evaluated again at the stage once; if it still doesn't, the adaptive steps shrink and fixed steps
+     * fall back to the full Newton iterations of EulerImplicit. The error estimate and a rejected step
+     * then factorize the Jacobian of the start again. Without f_nonstiff the explicit tableau is unused.
+     *
+     * The solve overloads of EulerImplicit integrate f_stiff alone with any of its Jacobians, with the
+     * factorization of set_linear_solver. Newton-Krylov isn't supported. The tableaus are set by the
+     * derived classes.
+     */
+    class DiagonallyImplicitRK : public EulerImplicit {
+        public:
+            /**
+             * Pair of Butcher tableaus on the same nodes c, with the embedded weights b_hat
+             *
+             * a_explicit is strictly lower triangular, row i holds aE_i0 ... aE_i(i-1). a_implicit is lower
+             * triangular, row i holds aI_i0 ... aI_ii; the diagonal is the same gamma for all rows, or 0
+             * in the first row only. The embedded weights are empty if the pair has no error estimate.
+             */
+            struct Tableau {
+                std::vector<vec> a_explicit;
+                std::vector<vec> a_implicit;
+                vec b_explicit;
+                vec b_implicit;
+                vec b_hat_explicit;
+                vec b_hat_implicit;
+                vec c;
+                int order;
+                int embedded_order;
+            };
+            // Work of the last solve
+            struct Statistics {
+                size_t steps = 0;
+                size_t rejected = 0;
+                size_t jacobians = 0;
+                size_t factorizations = 0;
+                size_t newton_iterations = 0;
+                size_t nonstiff_evaluations = 0;
+            };
+
+            /**
+             * Control the step size by the embedded error estimate
+             *
+             * The difference of the solution and its embedded formula estimates the error of the step.
+             * Its implicit part is filtered by the factorized Newton matrix, (I - gamma*dt*J)^-1 err, so
+             * stiff components don't reject the steps. The root mean square over the components of
+             * err_i/(absolute + relative*|y_i|) is kept below 1; the steps are at most time_step and are
+             * cut to end on every point of its grid.
+             * @param relative, absolute - 0, 0 (default) for fixed steps of time_step; otherwise
+             *      the tableau needs embedded weights
+             */
+            void set_tolerances(double relative, double absolute);
+            Statistics get_statistics();
+
+        protected:
+            Tableau tableau;
+            // diagonal of the implicit tableau
+            double gamma = 0.;
+            double relative_tolerance = 0.;
+            double absolute_tolerance = 0.;
+            Statistics statistics;
+            // non-stiff part of the running solve, empty for f_stiff alone
+            sysfunc nonstiff;
+            // The Newton iterations of the stages converge at a threshold of 1e-10
+            DiagonallyImplicitRK(double limit_low, double limit_high);
+            void set_pair(const Tableau&);
+            void integrate(const linearization& f, const vec& y0, size_t stored, const Sparsity& pattern,
+                           LinearSolver& solver, size_t jacobian_size) override;
+            void integrate(JacobianProduct& f, const vec& y0, size_t stored) override;
+    };
+
+    /**
+     * Implicit-explicit additive Runge-Kutta methods (IMEX ARK) for y' = f_stiff(t, y) + f_nonstiff(t, y).\n
+     *
+     * The stiff part is integrated by the diagonally implicit tableau, the non-stiff part by the
+     * explicit one on the same stages, see DiagonallyImplicitRK. Only f_stiff goes through the Newton
+     * iterations and their Jacobian. f_nonstiff is a plain double function, evaluated at most once per
+     * stage and never differentiated.
+     *
+     * The two-function solve overloads take f_stiff instrumented for adept and f_nonstiff plain.
+     * The solve overloads of EulerImplicit integrate f_stiff alone.
+     *
+     * With set_tolerances the embedded formula of ark324 controls the step size; the other pairs have
+     * no error estimate and take steps of time_step.
+     */
+    class AdditiveRK : public DiagonallyImplicitRK {
+        public:
+            // Forward-backward Euler, order 1, without error estimate
+            static Tableau imex_euler();
+            // Ascher, Ruuth and Spiteri (1997), ARS(2,2,2), order 2, L-stable, without error estimate.
+            // Like ARS(4,4,3), both tableaus end the step on the last stage, which relaxes the stiff part.
+            static Tableau ars222();
+            // Ascher, Ruuth and Spiteri (1997), ARS(4,4,3), order 3, L-stable, without error estimate
+            static Tableau ars443();
+            /**
+             * Kennedy and Carpenter (2003), ARK3(2)4L[2]SA, order 3, L-stable, with an embedded order 2
+             *
+             * Unlike the ARS pairs, the step doesn't end on its last stage: once the stiff part relaxes
+             * within a step, the explicit stages leave an error of order 2 that the embedded formula
+             * doesn't see.
+             */
+            static Tableau ark324();
+
+            AdditiveRK();
+            AdditiveRK(double limit_low, double limit_high, Tableau tableau = ars443());
+            void set_tableau(const Tableau&);
+
+            using EulerImplicit::solve;
+            /**
+             * Solve the split function over the domain, given the initial value
+             *
+             * @param stiff(t,y) - stiff part of the highest order derivative, recorded on the adept tape
+             *      for its Jacobian; the lower derivatives y'[j] = y[j+1] are part of it
+             * @param nonstiff(t,y) - non-stiff part of the highest order derivative, evaluated explicitly
+             * @param y0 - initial value of the function and n-1 lowest derivatives at the lower limit
+             */
+            vec& solve(adfunc stiff, func nonstiff, const vec& y0);
+            /**
+             * Solve the split system over the domain, given the initial state
+             *
+             * @param stiff(t,y,dydt) - stiff part, recorded on the adept tape for its Jacobian
+             * @param nonstiff(t,y,dydt) - non-stiff part, evaluated explicitly
+             * @param y0 - initial state at the lower limit
+             */
+            vec& solve(adsysfunc stiff, sysfunc nonstiff, const vec& y0);
+    };
+}
+
+#endif /*ORANGE_DRUM_EXPLORER_ADDITIVE_RK_H*/
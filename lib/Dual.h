@@ -0,0 +1,155 @@
+#ifndef ORANGE_DRUM_EXPLORER_DUAL_H
+#define ORANGE_DRUM_EXPLORER_DUAL_H
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+namespace OrangeDrumExplorer
+{
+    /**
+     * Dual number for forward-mode automatic differentiation.\n
+     *
+     * Carries a value and its derivatives in N directions on the stack, without a tape.
+     * Seeding the N directions with unit vectors gives N columns of a Jacobian in one
+     * evaluation of the function. The operators and math functions are found by
+     * argument dependent lookup, so call them unqualified (sin(x), not std::sin(x)).
+     *
+     * @param v - value
+     * @param d - derivatives in the N directions
+     */
+    template <typename T, size_t N>
+    class Dual
+    {
+        public:
+            typedef T scalar_type;
+            static constexpr size_t directions = N;
+
+            T v;
+            std::array<T, N> d;
+
+            Dual() : v(0) { d.fill(0); }
+            // Constant, all derivatives are zero
+            Dual(T value) : v(value) { d.fill(0); }
+            // Independent variable, seeded in the given direction
+            Dual(T value, size_t direction) : v(value) {
+                d.fill(0);
+                d[direction] = 1;
+            }
+
+            const T& value() const { return v; }
+            const T& derivative(size_t direction) const { return d[direction]; }
+
+            Dual& operator+= (const Dual& b){
+                v += b.v;
+                for (size_t k = 0; k < N; ++k){ d[k] += b.d[k]; }
+                return *this;
+            }
+            Dual& operator-= (const Dual& b){
+                v -= b.v;
+                for (size_t k = 0; k < N; ++k){ d[k] -= b.d[k]; }
+                return *this;
+            }
+            Dual& operator*= (const Dual& b){
+                for (size_t k = 0; k < N; ++k){ d[k] = d[k]*b.v + v*b.d[k]; }
+                v *= b.v;
+                return *this;
+            }
+            Dual& operator/= (const Dual& b){
+                const T inv = T(1)/b.v;
+                for (size_t k = 0; k < N; ++k){ d[k] = (d[k] - v*inv*b.d[k])*inv; }
+                v *= inv;
+                return *this;
+            }
+            Dual& operator+= (T b){ v += b; return *this; }
+            Dual& operator-= (T b){ v -= b; return *this; }
+            Dual& operator*= (T b){
+                v *= b;
+                for (size_t k = 0; k < N; ++k){ d[k] *= b; }
+                return *this;
+            }
+            Dual& operator/= (T b){ return *this *= T(1)/b; }
+
+            // Arithmetic, mixed with the scalar type without promoting it to a Dual
+            friend Dual operator+ (const Dual& a){ return a; }
+            friend Dual operator- (const Dual& a){ return chain(a, -a.v, T(-1)); }
+            friend Dual operator+ (Dual a, const Dual& b){ return a += b; }
+            friend Dual operator- (Dual a, const Dual& b){ return a -= b; }
+            friend Dual operator* (Dual a, const Dual& b){ return a *= b; }
+            friend Dual operator/ (Dual a, const Dual& b){ return a /= b; }
+            friend Dual operator+ (Dual a, T b){ return a += b; }
+            friend Dual operator- (Dual a, T b){ return a -= b; }
+            friend Dual operator* (Dual a, T b){ return a *= b; }
+            friend Dual operator/ (Dual a, T b){ return a /= b; }
+            friend Dual operator+ (T a, Dual b){ return b += a; }
+            friend Dual operator- (T a, const Dual& b){ return chain(b, a - b.v, T(-1)); }
+            friend Dual operator* (T a, Dual b){ return b *= a; }
+            friend Dual operator/ (T a, const Dual& b){ return chain(b, a/b.v, -a/(b.v*b.v)); }
+
+            // Comparisons act on the value only
+            friend bool operator< (const Dual& a, const Dual& b){ return a.v < b.v; }
+            friend bool operator> (const Dual& a, const Dual& b){ return a.v > b.v; }
+            friend bool operator<= (const Dual& a, const Dual& b){ return a.v <= b.v; }
+            friend bool operator>= (const Dual& a, const Dual& b){ return a.v >= b.v; }
+            friend bool operator== (const Dual& a, const Dual& b){ return a.v == b.v; }
+            friend bool operator!= (const Dual& a, const Dual& b){ return a.v != b.v; }
+
+            // Elementary functions
+            friend Dual sqrt(const Dual& a){
+                const T s = std::sqrt(a.v);
+                return chain(a, s, T(0.5)/s);
+            }
+            friend Dual exp(const Dual& a){
+                const T e = std::exp(a.v);
+                return chain(a, e, e);
+            }
+            friend Dual log(const Dual& a){ return chain(a, std::log(a.v), T(1)/a.v); }
+            friend Dual sin(const Dual& a){ return chain(a, std::sin(a.v), std::cos(a.v)); }
+            friend Dual cos(const Dual& a){ return chain(a, std::cos(a.v), -std::sin(a.v)); }
+            friend Dual tan(const Dual& a){
+                const T tn = std::tan(a.v);
+                return chain(a, tn, T(1) + tn*tn);
+            }
+            friend Dual atan(const Dual& a){ return chain(a, std::atan(a.v), T(1)/(T(1) + a.v*a.v)); }
+            friend Dual sinh(const Dual& a){ return chain(a, std::sinh(a.v), std::cosh(a.v)); }
+            friend Dual cosh(const Dual& a){ return chain(a, std::cosh(a.v), std::sinh(a.v)); }
+            friend Dual tanh(const Dual& a){
+                const T th = std::tanh(a.v);
+                return chain(a, th, T(1) - th*th);
+            }
+            friend Dual abs(const Dual& a){ return chain(a, std::abs(a.v), a.v < 0 ? T(-1) : T(1)); }
+            friend Dual fabs(const Dual& a){ return abs(a); }
+            friend Dual pow(const Dual& a, T b){
+                return chain(a, std::pow(a.v, b), power_derivative(a.v, b));
+            }
+            friend Dual pow(T a, const Dual& b){
+                const T p = std::pow(a, b.v);
+                return chain(b, p, p*std::log(a));
+            }
+            // As on the Tape, the derivative by the exponent only exists for a positive base; a negative
+            // base takes integer exponents
+            friend Dual pow(const Dual& a, const Dual& b){
+                const T p = std::pow(a.v, b.v);
+                const T da = power_derivative(a.v, b.v);
+                const T db = a.v > T(0) ? p*std::log(a.v) : T(0);
+                Dual out(p);
+                for (size_t k = 0; k < N; ++k){ out.d[k] = da*a.d[k] + db*b.d[k]; }
+                return out;
+            }
+            friend const T& value(const Dual& a){ return a.v; }
+
+        private:
+            // d(a^b)/da, zero for b = 0 also at a = 0
+            static T power_derivative(T a, T b){
+                return b == T(0) ? T(0) : b*std::pow(a, b - T(1));
+            }
+            // f(a) with value fa and derivative dfa = f'(a.v)
+            static Dual chain(const Dual& a, T fa, T dfa){
+                Dual out(fa);
+                for (size_t k = 0; k < N; ++k){ out.d[k] = dfa*a.d[k]; }
+                return out;
+            }
+    };
+}
+
+#endif /*ORANGE_DRUM_EXPLORER_DUAL_H*/
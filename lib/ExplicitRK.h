@@ -0,0 +1,170 @@
+#ifndef ORANGE_DRUM_EXPLORER_EXPLICIT_RK_H
+#define ORANGE_DRUM_EXPLORER_EXPLICIT_RK_H
+
+#include <array>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "Solver.h"
+#include "Trace.h"
+
+namespace OrangeDrumExplorer
+{
+    /**
+     * Butcher tableau of an explicit Runge-Kutta method with S stages.\n
+     *
+     * Only the strictly lower triangle of a is used. Declare it constexpr at namespace scope
+     * to instantiate ExplicitRK with it.
+     */
+    template <size_t S>
+    struct ButcherTableau {
+        static constexpr size_t stages = S;
+        double a[S][S];
+        double b[S];
+        double c[S];
+        int order;
+    };
+
+    namespace Tableaus
+    {
+        inline constexpr ButcherTableau<1> euler = {{{0.}}, {1.}, {0.}, 1};
+        inline constexpr ButcherTableau<2> midpoint = {{{0., 0.}, {1./2., 0.}}, {0., 1.}, {0., 1./2.}, 2};
+        inline constexpr ButcherTableau<2> heun = {{{0., 0.}, {1., 0.}}, {1./2., 1./2.}, {0., 1.}, 2};
+        inline constexpr ButcherTableau<2> ralston = {{{0., 0.}, {2./3., 0.}}, {1./4., 3./4.}, {0., 2./3.}, 2};
+        inline constexpr ButcherTableau<3> kutta3 = {{{0., 0., 0.}, {1./2., 0., 0.}, {-1., 2., 0.}},
+                                                     {1./6., 2./3., 1./6.}, {0., 1./2., 1.}, 3};
+        // strong stability preserving, Shu and Osher
+        inline constexpr ButcherTableau<3> ssprk3 = {{{0., 0., 0.}, {1., 0., 0.}, {1./4., 1./4., 0.}},
+                                                     {1./6., 1./6., 2./3.}, {0., 1., 1./2.}, 3};
+        inline constexpr ButcherTableau<4> rk4 = {{{0., 0., 0., 0.}, {1./2., 0., 0., 0.}, {0., 1./2., 0., 0.},
+                                                   {0., 0., 1., 0.}},
+                                                  {1./6., 1./3., 1./3., 1./6.}, {0., 1./2., 1./2., 1.}, 4};
+        // Kutta's 3/8 rule
+        inline constexpr ButcherTableau<4> rk38 = {{{0., 0., 0., 0.}, {1./3., 0., 0., 0.}, {-1./3., 1., 0., 0.},
+                                                    {1., -1., 1., 0.}},
+                                                   {1./8., 3./8., 3./8., 1./8.}, {0., 1./3., 2./3., 1.}, 4};
+    }
+
+    /**
+     * Explicit Runge-Kutta method given by a constexpr Butcher tableau.\n
+     *
+     * The stage loops are unrolled at compile time, the coefficients are constants of the
+     * generated code and the terms of zero coefficients are left out, e.g.
+     *      ExplicitRK<Tableaus::rk4> solver(0., 1.);
+     * The system can be any callable f(t, y, dydt) in solve(dydt, y0, sink), which is then
+     * inlined into the stages. The solver holds S + 2 vectors of the state size.
+     */
+    template <const auto& Tableau>
+    class ExplicitRK : public StreamingSolver {
+        public:
+            static constexpr size_t stages = std::decay_t<decltype(Tableau)>::stages;
+            static constexpr int order = Tableau.order;
+
+            using StreamingSolver::StreamingSolver;
+            using StreamingSolver::solve;
+
+            /**
+             * Solve a system without storing the solution
+             *
+             * @param dydt(t, y, dydt) - any callable system, e.g. a sysfunc or a lambda
+             * @param output - called with the initial state and after every step
+             * @return the state at the last step
+             */
+            template <typename F>
+            vec solve(const F& dydt, const vec& y0, const sink& output){
+                const double a = limit_low;
+                const double dt = time_step;
+                const size_t N = (limit_high - limit_low)/dt;
+                const size_t n = y0.size();
+                vec y = y0;
+                vec stage_state(n);
+                std::array<vec, stages> k;
+                for (vec& ki : k){
+                    ki.resize(n);
+                }
+                output(a, y);
+                for (size_t i = 0; i < N; ++i){
+                    ODE_TRACE_SCOPE("step");
+                    advance(dydt, a + i*dt, dt, y, stage_state, k);
+                    output(a + (i+1)*dt, y);
+                }
+                return y;
+            }
+
+            /**
+             * Single step of size dt from (t, y), e.g. to start a multistep method
+             *
+             * @param stage_state, k - scratch of the state size; k[0] holds dydt(t, y) afterwards
+             */
+            template <typename F>
+            static void advance(const F& dydt, double t, double dt, vec& y, vec& stage_state,
+                                std::array<vec, stages>& k){
+                step(dydt, t, dt, y, stage_state, k, std::make_index_sequence<stages>());
+            }
+
+            vec solve(sysfunc dydt, const vec& y0, const sink& output) override {
+                return solve<sysfunc>(dydt, y0, output);
+            }
+
+        protected:
+            // First non-zero entry of a row of length `length`, `length` if all are zero
+            static constexpr size_t first_nonzero(const double* row, size_t length){
+                size_t j = 0;
+                while (j < length && row[j] == 0.){
+                    ++j;
+                }
+                return j;
+            }
+
+            // Weight of stage J in row Row of a, or in b for Row == stages
+            static constexpr double weight(size_t row, size_t j){
+                return row < stages ? Tableau.a[row][j] : Tableau.b[j];
+            }
+
+            // sum += weight*k[J][m] for the non-zero weights after the first one
+            template <size_t Row, size_t First, size_t J>
+            static void accumulate(double& sum, const std::array<vec, stages>& k, size_t m){
+                if constexpr (J > First && weight(Row, J) != 0.){
+                    sum += weight(Row, J)*k[J][m];
+                }
+            }
+
+            // Stage I: k[I] = f(t + c[I]*dt, y + dt*sum_J a[I][J]*k[J])
+            template <size_t I, typename F, size_t... J>
+            static void stage(const F& dydt, double t, double dt, const vec& y, vec& stage_state,
+                              std::array<vec, stages>& k, std::index_sequence<J...>){
+                constexpr size_t first = first_nonzero(Tableau.a[I], I);
+                if constexpr (first == I){
+                    // no earlier stage enters, e.g. the first one
+                    dydt(t + Tableau.c[I]*dt, y, k[I]);
+                }
+                else{
+                    const size_t n = y.size();
+                    for (size_t m = 0; m < n; ++m){
+                        double sum = Tableau.a[I][first]*k[first][m];
+                        (accumulate<I, first, J>(sum, k, m), ...);
+                        stage_state[m] = y[m] + dt*sum;
+                    }
+                    dydt(t + Tableau.c[I]*dt, stage_state, k[I]);
+                }
+            }
+
+            template <typename F, size_t... I>
+            static void step(const F& dydt, double t, double dt, vec& y, vec& stage_state,
+                             std::array<vec, stages>& k, std::index_sequence<I...>){
+                (stage<I>(dydt, t, dt, y, stage_state, k, std::make_index_sequence<I>()), ...);
+                // y += dt*sum_I b[I]*k[I]
+                constexpr size_t first = first_nonzero(Tableau.b, stages);
+                static_assert(first < stages, "The weights b of the tableau are all zero");
+                const size_t n = y.size();
+                for (size_t m = 0; m < n; ++m){
+                    double sum = Tableau.b[first]*k[first][m];
+                    (accumulate<stages, first, I>(sum, k, m), ...);
+                    y[m] += dt*sum;
+                }
+            }
+    };
+}
+
+#endif /*ORANGE_DRUM_EXPLORER_EXPLICIT_RK_H*/
@@ -0,0 +1,504 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include <Eigen/Core>
+#include <Eigen/LU>
+
+#include "Exponential.h"
+#include "Krylov.h"
+#include "Trace.h"
+
+namespace OrangeDrumExplorer{
+
+    namespace {
+        typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> RowMatrix;
+        const double eps = std::numeric_limits<double>::epsilon();
+        // largest 1-norms for the Pade degrees 3, 5, 7, 9 and 13, Higham (2005) table 2.3
+        const double theta[5] = {1.495585217958292e-2, 2.539398330063230e-1, 9.504178996162932e-1,
+                                 2.097847961257068, 5.371920351148152};
+        const double pade3[4] = {120., 60., 12., 1.};
+        const double pade5[6] = {30240., 15120., 3360., 420., 30., 1.};
+        const double pade7[8] = {17297280., 8648640., 1995840., 277200., 25200., 1512., 56., 1.};
+        const double pade9[10] = {17643225600., 8821612800., 2075673600., 302702400., 30270240., 2162160.,
+                                  110880., 3960., 90., 1.};
+        const double pade13[14] = {64764752532480000., 32382376266240000., 7771770303897600., 1187353796428800.,
+                                   129060195264000., 10559470521600., 670442572800., 33522128640., 1323241920.,
+                                   40840800., 960960., 16380., 182., 1.};
+        // the Jacobian and f at the samples agree with those at y0 within these fractions
+        const double jacobian_tolerance = 1e-10;
+        const double affine_tolerance = 1e-8;
+        // Krylov substeps below this fraction of the step fail
+        const double smallest_substep = 1e-12;
+
+        Eigen::MatrixXd exponential(const Eigen::MatrixXd& A){
+            const Eigen::Index n = A.rows();
+            const Eigen::MatrixXd I = Eigen::MatrixXd::Identity(n, n);
+            const double norm = n ? A.cwiseAbs().colwise().sum().maxCoeff() : 0.;
+            Eigen::MatrixXd U, V;
+            int squarings = 0;
+            const double* low[4] = {pade3, pade5, pade7, pade9};
+            size_t degree = 0;
+            while (degree < 4 && !(norm <= theta[degree])){
+                ++degree;
+            }
+            if (degree < 4){
+                // U = A*(b1 + b3 A^2 + ...), V = b0 + b2 A^2 + ...
+                const double* b = low[degree];
+                const Eigen::MatrixXd A2 = A*A;
+                Eigen::MatrixXd power = I;
+                Eigen::MatrixXd odd = b[1]*I;
+                V = b[0]*I;
+                for (size_t k = 2; k <= 2*degree + 3; k += 2){
+                    power = power*A2;
+                    odd += b[k + 1]*power;
+                    V += b[k]*power;
+                }
+                U = A*odd;
+            }
+            else{
+                squarings = std::max(0, static_cast<int>(std::ceil(std::log2(norm/theta[4]))));
+                const double* b = pade13;
+                const Eigen::MatrixXd As = A*std::ldexp(1., -squarings);
+                const Eigen::MatrixXd A2 = As*As;
+                const Eigen::MatrixXd A4 = A2*A2;
+                const Eigen::MatrixXd A6 = A4*A2;
+                U = As*(A6*(b[13]*A6 + b[11]*A4 + b[9]*A2) + b[7]*A6 + b[5]*A4 + b[3]*A2 + b[1]*I);
+                V = A6*(b[12]*A6 + b[10]*A4 + b[8]*A2) + b[6]*A6 + b[4]*A4 + b[2]*A2 + b[0]*I;
+            }
+            Eigen::MatrixXd E = (V - U).partialPivLu().solve(V + U);
+            for (int s = 0; s < squarings; ++s){
+                E = E*E;
+            }
+            return E;
+        }
+
+        double norm1(const vec& x){
+            double sum = 0.;
+            for (double xi : x){
+                sum += std::abs(xi);
+            }
+            return sum;
+        }
+
+        /**
+         * phi_1(h*J) w[0] + ... + phi_p(h*J) w[p-1] from the exponential of the augmented matrix
+         * [[h*J, W], [0, K]] of size n + p, W = [w[p-1] ... w[0]] and K the p*p shift, Al-Mohy and Higham (2011)
+         */
+        void phi_dense(const vec& J, size_t n, double h, const std::vector<vec>& w, vec& out){
+            const size_t p = w.size();
+            // the columns of W are scaled to 1, which keeps the scaling of the exponential to that of h*J
+            double scale = 0.;
+            for (const vec& wk : w){
+                scale = std::max(scale, norm1(wk));
+            }
+            out.assign(n, 0.);
+            if (!(scale > 0.)){
+                return;
+            }
+            Eigen::MatrixXd A = Eigen::MatrixXd::Zero(n + p, n + p);
+            A.topLeftCorner(n, n) = h*Eigen::Map<const RowMatrix>(J.data(), n, n);
+            for (size_t k = 0; k < p; ++k){
+                for (size_t i = 0; i < n; ++i){
+                    A(i, n + p - 1 - k) = w[k][i]/scale;
+                }
+            }
+            for (size_t i = 0; i + 1 < p; ++i){
+                A(n + i, n + i + 1) = 1.;
+            }
+            const Eigen::MatrixXd E = exponential(A);
+            for (size_t i = 0; i < n; ++i){
+                out[i] = scale*E(i, n + p - 1);
+            }
+        }
+
+        /**
+         * The same sum of phi-functions as phi_dense by the Krylov approximation of the exponential of the
+         * augmented matrix applied to its last unit vector, with Jacobian-vector products only.
+         *
+         * The exponential is taken in substeps whose Krylov subspace of at most `dimension` vectors reaches
+         * the tolerance by the estimate of Saad (1992), as in expv of Expokit (Sidje 1998).
+         * @return false if the substeps become too short
+         */
+        bool phi_krylov(JacobianProduct& f, size_t n, double h, const std::vector<vec>& w, vec& out,
+                        size_t dimension, double tolerance, size_t& products){
+            const size_t p = w.size();
+            const size_t N = n + p;
+            double scale = 0.;
+            for (const vec& wk : w){
+                scale = std::max(scale, norm1(wk));
+            }
+            out.assign(n, 0.);
+            if (!(scale > 0.)){
+                return true;
+            }
+            vec top(n), Jv(n);
+            auto product = [&](const vec& x, vec& y){
+                std::copy(x.begin(), x.begin() + n, top.begin());
+                f.apply(top, Jv);
+                ++products;
+                for (size_t i = 0; i < n; ++i){
+                    y[i] = h*Jv[i];
+                    for (size_t k = 0; k < p; ++k){
+                        y[i] += w[k][i]/scale*x[n + p - 1 - k];
+                    }
+                }
+                for (size_t i = 0; i + 1 < p; ++i){
+                    y[n + i] = x[n + i + 1];
+                }
+                y[N - 1] = 0.;
+            };
+            auto norm2 = [](const vec& x){
+                double sum = 0.;
+                for (double xi : x){
+                    sum += xi*xi;
+                }
+                return std::sqrt(sum);
+            };
+            const size_t m_max = std::min(dimension, N);
+            std::vector<vec> V(m_max + 1, vec(N));
+            vec x(N, 0.);
+            x[N - 1] = 1.;
+            double remaining = 1.;
+            double tau = 1.;
+            while (remaining > 0.){
+                const double beta = norm2(x);
+                for (size_t i = 0; i < N; ++i){
+                    V[0][i] = x[i]/beta;
+                }
+                // Arnoldi with modified Gram-Schmidt
+                Eigen::MatrixXd H = Eigen::MatrixXd::Zero(m_max + 1, m_max);
+                size_t m = m_max;
+                bool breakdown = false;
+                for (size_t j = 0; j < m_max; ++j){
+                    product(V[j], V[j + 1]);
+                    const double before = norm2(V[j + 1]);
+                    for (size_t i = 0; i <= j; ++i){
+                        double dot = 0.;
+                        for (size_t l = 0; l < N; ++l){
+                            dot += V[i][l]*V[j + 1][l];
+                        }
+                        H(i, j) = dot;
+                        for (size_t l = 0; l < N; ++l){
+                            V[j + 1][l] -= dot*V[i][l];
+                        }
+                    }
+                    H(j + 1, j) = norm2(V[j + 1]);
+                    if (H(j + 1, j) <= 1e-12*before){
+                        // the subspace is invariant, its exponential is exact
+                        m = j + 1;
+                        breakdown = true;
+                        break;
+                    }
+                    for (size_t l = 0; l < N; ++l){
+                        V[j + 1][l] /= H(j + 1, j);
+                    }
+                }
+                tau = breakdown ? remaining : std::min(tau, remaining);
+                // exp(tau*H) e_1 and phi_1(tau*H) e_1 from the augmented matrix [[tau*H, e_1], [0, 0]]
+                Eigen::MatrixXd E;
+                double error = 0.;
+                while (true){
+                    Eigen::MatrixXd augmented = Eigen::MatrixXd::Zero(m + 1, m + 1);
+                    augmented.topLeftCorner(m, m) = tau*H.topLeftCorner(m, m);
+                    augmented(0, m) = 1.;
+                    E = exponential(augmented);
+                    error = breakdown ? 0. : beta*tau*H(m, m - 1)*std::abs(E(m - 1, m));
+                    if (error <= tolerance*tau){
+                        break;
+                    }
+                    tau *= std::max(0.2, 0.9*std::pow(tolerance*tau/error, 1./m));
+                    if (!(tau >= smallest_substep)){
+                        return false;
+                    }
+                }
+                std::fill(x.begin(), x.end(), 0.);
+                for (size_t i = 0; i < m; ++i){
+                    const double coefficient = beta*E(i, 0);
+                    for (size_t l = 0; l < N; ++l){
+                        x[l] += coefficient*V[i][l];
+                    }
+                }
+                remaining -= tau;
+                if (error > 0.){
+                    tau *= std::min(2., 0.9*std::pow(tolerance*tau/error, 1./m));
+                }
+            }
+            for (size_t i = 0; i < n; ++i){
+                out[i] = scale*x[i];
+            }
+            return true;
+        }
+
+        bool finite(const vec& y){
+            return std::all_of(y.begin(), y.end(), [](double yi){ return std::isfinite(yi); });
+        }
+    }
+
+    void matrix_exponential(const vec& A, size_t n, vec& E){
+        const RowMatrix exp_A = exponential(Eigen::Map<const RowMatrix>(A.data(), n, n));
+        E.resize(n*n);
+        Eigen::Map<RowMatrix>(E.data(), n, n) = exp_A;
+    }
+
+    Exponential::Exponential()
+        : Exponential(0., 1.)
+    {}
+
+    Exponential::Exponential(double low, double high, Method method)
+        : EulerImplicit(low, high), method(method)
+    {}
+
+    void Exponential::set_method(Method m){
+        method = m;
+    }
+
+    void Exponential::set_linearity(Linearity l){
+        linearity = l;
+    }
+
+    Exponential::Statistics Exponential::get_statistics(){
+        return statistics;
+    }
+
+    bool Exponential::is_linear(const linearization& f, const vec& y0, const vec& J0, const vec& f0){
+        const size_t n = y0.size();
+        vec J(n*n), fs(n), fy0(n), ys(n), none;
+        for (int sample = 1; sample <= 2; ++sample){
+            // the middle and the end of the domain, at states apart from y0 in every component
+            const double t = limit_low + sample*(limit_high - limit_low)/2.;
+            for (size_t j = 0; j < n; ++j){
+                ys[j] = y0[j] + (1. + std::abs(y0[j]))*0.5*std::sin(1.7*(j + 1) + sample);
+            }
+            statistics.evaluations += 2;
+            ++statistics.jacobians;
+            f(t, ys, fs, J);
+            f(t, y0, fy0, none);
+            double difference = 0., size = 0.;
+            for (size_t k = 0; k < n*n; ++k){
+                difference = std::max(difference, std::abs(J[k] - J0[k]));
+                size = std::max(size, std::max(std::abs(J[k]), std::abs(J0[k])));
+            }
+            if (!(difference <= jacobian_tolerance*size)){
+                return false;
+            }
+            // f(t, ys) - f(t, y0) = J0 (ys - y0), which a piecewise affine f misses
+            double residual = 0.;
+            size = 0.;
+            for (size_t i = 0; i < n; ++i){
+                double change = 0.;
+                for (size_t j = 0; j < n; ++j){
+                    change += J0[i*n + j]*(ys[j] - y0[j]);
+                }
+                residual = std::max(residual, std::abs(fs[i] - fy0[i] - change));
+                size = std::max({size, std::abs(fs[i]), std::abs(fy0[i]), std::abs(change)});
+            }
+            if (!(residual <= affine_tolerance*size)){
+                return false;
+            }
+        }
+        return finite(J0) && finite(f0);
+    }
+
+    void Exponential::integrate_linear(const linearization& f, const vec& y0, size_t stored, const vec& A){
+        ODE_TRACE_SCOPE("phi-functions");
+        const size_t n = y0.size();
+        const double dt = time_step;
+        statistics.linear = true;
+        // the first row of blocks of exp([[dt*A, I, 0, 0], [0, 0, I, 0], [0, 0, 0, I], [0, 0, 0, 0]])
+        // is exp(dt*A), phi_1(dt*A), phi_2(dt*A), phi_3(dt*A)
+        Eigen::MatrixXd B = Eigen::MatrixXd::Zero(4*n, 4*n);
+        B.topLeftCorner(n, n) = dt*Eigen::Map<const RowMatrix>(A.data(), n, n);
+        for (size_t k = 0; k < 3; ++k){
+            B.block(k*n, (k + 1)*n, n, n).setIdentity();
+        }
+        const Eigen::MatrixXd E = exponential(B);
+        ++statistics.exponentials;
+        const Eigen::MatrixXd M0 = E.topLeftCorner(n, n);
+        const Eigen::MatrixXd M1 = dt*E.block(0, n, n, n);
+        const Eigen::MatrixXd M2 = dt*E.block(0, 2*n, n, n);
+        const Eigen::MatrixXd M3 = 2.*dt*E.block(0, 3*n, n, n);
+
+        // forcing b(t) = f(t, 0) at the start, the middle and the end of the step
+        const vec zero(n, 0.);
+        vec b0(n), bm(n), b1(n), none;
+        Eigen::VectorXd c1(n), c2(n);
+        ++statistics.evaluations;
+        f(limit_low, zero, b0, none);
+        integrate_steps([&](double t1, const vec& y){
+            const double t = t1 - dt;
+            statistics.evaluations += 2;
+            f(t + dt/2., zero, bm, none);
+            f(t1, zero, b1, none);
+            for (size_t i = 0; i < n; ++i){
+                c1[i] = -3.*b0[i] + 4.*bm[i] - b1[i];
+                c2[i] = 2.*b0[i] - 4.*bm[i] + 2.*b1[i];
+            }
+            vec next(n);
+            Eigen::Map<Eigen::VectorXd>(next.data(), n) = M0*Eigen::Map<const Eigen::VectorXd>(y.data(), n)
+                + M1*Eigen::Map<const Eigen::VectorXd>(b0.data(), n) + M2*c1 + M3*c2;
+            if (!finite(next)){
+                throw DivergentException();
+            }
+            ++statistics.steps;
+            b0.swap(b1);
+            return next;
+        }, y0, stored);
+    }
+
+    void Exponential::integrate(const linearization& system, const vec& y0, size_t stored, const Sparsity& pattern,
+                                LinearSolver&, size_t jacobian_size){
+        const size_t n = y0.size();
+        if (jacobian_size != jacobian_values(pattern, n)){
+            throw std::invalid_argument("Exponential needs the n*n or compressed Jacobian, the banded one is only "
+                                        "supported with set_newton_krylov");
+        }
+        // the exponentials are dense, the compressed values of a sparsity pattern are expanded; the
+        // pattern is read after every evaluation, which may change it
+        vec values(jacobian_size);
+        linearization f = [&system, &pattern, &values](double t, const vec& y, vec& fy, vec& J){
+            if (J.empty()){
+                system(t, y, fy, J);
+                return;
+            }
+            system(t, y, fy, values);
+            if (pattern.empty()){
+                J.swap(values);
+                return;
+            }
+            const size_t n = y.size();
+            std::fill(J.begin(), J.end(), 0.);
+            size_t k = 0;
+            for (size_t j = 0; j < n; ++j){
+                for (size_t i : pattern[j]){
+                    J[i*n + j] += values[k++];
+                }
+            }
+        };
+        const double dt = time_step;
+        statistics = Statistics();
+        vec J(n*n), fy(n), none;
+        ++statistics.evaluations;
+        ++statistics.jacobians;
+        f(limit_low, y0, fy, J);
+        if (linearity == Linearity::linear || (linearity == Linearity::detect && is_linear(f, y0, J, fy))){
+            integrate_linear(f, y0, stored, J);
+            return;
+        }
+
+        vec fp(n), fm(n), v(n), U(n), fU(n), increment(n);
+        std::vector<vec> w(2, vec(n)), correction(3, vec(n, 0.));
+        bool first = true;
+        integrate_steps([&](double t1, const vec& y){
+            const double t = t1 - dt;
+            if (!first){
+                ++statistics.evaluations;
+                ++statistics.jacobians;
+                f(t, y, fy, J);
+            }
+            first = false;
+            // v = df/dt by central differences at representable t +- delta
+            const double delta = std::cbrt(eps)*std::max(1., std::abs(t));
+            const double above = t + delta, below = t - delta;
+            statistics.evaluations += 2;
+            f(above, y, fp, none);
+            f(below, y, fm, none);
+            for (size_t i = 0; i < n; ++i){
+                v[i] = (fp[i] - fm[i])/(above - below);
+                w[0][i] = dt*fy[i];
+                w[1][i] = dt*dt*v[i];
+            }
+            {
+                ODE_TRACE_SCOPE("phi-functions");
+                ++statistics.exponentials;
+                phi_dense(J, n, dt, w, increment);
+            }
+            for (size_t i = 0; i < n; ++i){
+                U[i] = y[i] + increment[i];
+            }
+            if (method == Method::exprb32){
+                ++statistics.evaluations;
+                f(t1, U, fU, none);
+                for (size_t i = 0; i < n; ++i){
+                    double change = 0.;
+                    for (size_t j = 0; j < n; ++j){
+                        change += J[i*n + j]*(U[j] - y[j]);
+                    }
+                    correction[2][i] = 2.*dt*(fU[i] - fy[i] - change - dt*v[i]);
+                }
+                ODE_TRACE_SCOPE("phi-functions");
+                ++statistics.exponentials;
+                phi_dense(J, n, dt, correction, increment);
+                for (size_t i = 0; i < n; ++i){
+                    U[i] += increment[i];
+                }
+            }
+            if (!finite(U)){
+                throw DivergentException();
+            }
+            ++statistics.steps;
+            return U;
+        }, y0, stored);
+    }
+
+    void Exponential::integrate(JacobianProduct& f, const vec& y0, size_t stored){
+        const size_t n = y0.size();
+        const double dt = time_step;
+        statistics = Statistics();
+        vec fy(n), fp(n), fm(n), v(n), U(n), fU(n), step(n), change(n), increment(n);
+        std::vector<vec> w(2, vec(n)), correction(3, vec(n, 0.));
+        integrate_steps([&](double t1, const vec& y){
+            const double t = t1 - dt;
+            const double delta = std::cbrt(eps)*std::max(1., std::abs(t));
+            const double above = t + delta, below = t - delta;
+            // the products are taken at the last point linearized
+            statistics.evaluations += 3;
+            ++statistics.jacobians;
+            f.linearize(above, y, fp);
+            f.linearize(below, y, fm);
+            f.linearize(t, y, fy);
+            for (size_t i = 0; i < n; ++i){
+                v[i] = (fp[i] - fm[i])/(above - below);
+                w[0][i] = dt*fy[i];
+                w[1][i] = dt*dt*v[i];
+            }
+            {
+                ODE_TRACE_SCOPE("phi-functions");
+                if (!phi_krylov(f, n, dt, w, increment, krylov_restart, krylov_tolerance, statistics.products)){
+                    throw DivergentException();
+                }
+            }
+            for (size_t i = 0; i < n; ++i){
+                U[i] = y[i] + increment[i];
+                step[i] = increment[i];
+            }
+            if (method == Method::exprb32){
+                f.apply(step, change);
+                ++statistics.products;
+                statistics.evaluations += 2;
+                ++statistics.jacobians;
+                f.linearize(t1, U, fU);
+                for (size_t i = 0; i < n; ++i){
+                    correction[2][i] = 2.*dt*(fU[i] - fy[i] - change[i] - dt*v[i]);
+                }
+                // back to the products at the start of the step
+                f.linearize(t, y, fy);
+                ODE_TRACE_SCOPE("phi-functions");
+                if (!phi_krylov(f, n, dt, correction, increment, krylov_restart, krylov_tolerance,
+                                statistics.products)){
+                    throw DivergentException();
+                }
+                for (size_t i = 0; i < n; ++i){
+                    U[i] += increment[i];
+                }
+            }
+            if (!finite(U)){
+                throw DivergentException();
+            }
+            ++statistics.steps;
+            return U;
+        }, y0, stored);
+    }
+
+}
@@ -0,0 +1,81 @@
+#ifndef ORANGE_DRUM_EXPLORER_EXPONENTIAL_H
+#define ORANGE_DRUM_EXPLORER_EXPONENTIAL_H
+
+#include <cstddef>
+
+#include "Solver.h"
+
+namespace OrangeDrumExplorer
+{
+    /**
+     * Exponential of a dense n*n matrix by scaling and squaring of a Pade approximant of degree 3 to 13,
+     * after Higham (2005)
+     *
+     * @param A - matrix row by row, A[i*n + j]
+     * @param E - output, exp(A) row by row
+     */
+    void matrix_exponential(const vec& A, size_t n, vec& E);
+
+    /**
+     * Exponential integrators for stiff and linear systems y' = f(t, y).\n
+     *
+     * Linear systems with constant coefficients, y' = A y + b(t), take exact steps
+     *   y(t + dt) = exp(dt*A) y(t) + dt*(phi_1(dt*A) b0 + phi_2(dt*A) c1 + 2*phi_3(dt*A) c2)
+     * with the phi-functions computed once per solve and c1, c2 from the forcing b at t, t + dt/2 and
+     * t + dt; the forcing integral is exact for b of degree 2 in t and of order 3 otherwise. A step takes
+     * two evaluations and no Newton iterations. The system is taken as linear if its Jacobian is the same
+     * at the initial state and at two samples across the domain and f is affine between them; see
+     * set_linearity to declare it instead. The detection needs an exact Jacobian (adept, analytic, dual
+     * or taped); the finite difference one usually misses its tolerance.
+     *
+     * Other systems take exponential Rosenbrock steps with the Jacobian J and the time derivative v of f at
+     * the start of the step (Hochbruck, Ostermann and Schweitzer 2009):
+     *   U = y + dt*phi_1(dt*J) f(t, y) + dt^2*phi_2(dt*J) v
+     *   y(t + dt) = U + 2*dt*phi_3(dt*J) (f(t + dt, U) - f(t, y) - J (U - y) - dt*v)
+     * The exponential Rosenbrock-Euler method stops at U and has order 2, exprb32 has order 3. Neither
+     * has a linear solve or a stability limit on the step. v is taken by central differences in t.
+     * The sums of phi-functions come from one exponential of the Jacobian augmented by the vectors,
+     * of size n + 2 and n + 3. With set_newton_krylov they are approximated in Krylov subspaces of at
+     * most `restart` Jacobian-vector products instead, with substeps where the subspace doesn't reach
+     * the tolerance; the linear systems then take exponential Rosenbrock steps as well. The Jacobian
+     * comes from the solve overloads of EulerImplicit, except for the banded one of the method of lines,
+     * which is supported with set_newton_krylov only. Steps of time_step are taken.
+     */
+    class Exponential : public EulerImplicit {
+        public:
+            enum class Method { rosenbrock_euler, exprb32 };
+            // detect: sample the Jacobian at the start of the solve
+            enum class Linearity { detect, linear, nonlinear };
+            // Work of the last solve
+            struct Statistics {
+                size_t steps = 0;
+                size_t evaluations = 0;
+                size_t jacobians = 0;
+                // dense matrix exponentials
+                size_t exponentials = 0;
+                // Jacobian-vector products of the Krylov subspaces
+                size_t products = 0;
+                // the steps were exact steps of a linear system
+                bool linear = false;
+            };
+
+            Exponential();
+            Exponential(double limit_low, double limit_high, Method method = Method::exprb32);
+            void set_method(Method);
+            void set_linearity(Linearity);
+            Statistics get_statistics();
+
+        protected:
+            Method method;
+            Linearity linearity = Linearity::detect;
+            Statistics statistics;
+            // Jacobian and affinity of f at two samples against those at y0, false for a non-linear system
+            bool is_linear(const linearization& f, const vec& y0, const vec& J0, const vec& f0);
+            void integrate_linear(const linearization& f, const vec& y0, size_t stored, const vec& A);
+            void integrate(const linearization& f, const vec& y0, size_t stored, const Sparsity& pattern,
+                           LinearSolver& solver, size_t jacobian_size) override;
+            void integrate(JacobianProduct& f, const vec& y0, size_t stored) override;
+    };
+}
+
+#endif /*ORANGE_DRUM_EXPLORER_EXPONENTIAL_H*/
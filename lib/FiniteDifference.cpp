@@ -0,0 +1,163 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+
+#include "FiniteDifference.h"
+#include "Trace.h"
+
+namespace OrangeDrumExplorer{
+
+// -------- Column groups ----------------
+
+    std::vector<std::vector<size_t>> column_groups(const Sparsity& pattern, size_t n){
+        std::vector<std::vector<size_t>> groups;
+        if (pattern.empty()){
+            for (size_t j = 0; j < n; ++j){
+                groups.push_back({j});
+            }
+            return groups;
+        }
+        if (pattern.size() != n){
+            throw std::invalid_argument("The sparsity pattern needs one entry per column");
+        }
+        for (const auto& rows : pattern){
+            for (size_t row : rows){
+                if (row >= n){
+                    throw std::invalid_argument("Row of the sparsity pattern out of range");
+                }
+            }
+        }
+        // rows already covered by each group
+        std::vector<std::vector<bool>> used;
+        for (size_t j = 0; j < n; ++j){
+            size_t g = 0;
+            for (; g < groups.size(); ++g){
+                bool fits = true;
+                for (size_t row : pattern[j]){
+                    if (used[g][row]){
+                        fits = false;
+                        break;
+                    }
+                }
+                if (fits){
+                    break;
+                }
+            }
+            if (g == groups.size()){
+                groups.emplace_back();
+                used.emplace_back(n, false);
+            }
+            groups[g].push_back(j);
+            for (size_t row : pattern[j]){
+                used[g][row] = true;
+            }
+        }
+        return groups;
+    }
+
+// -------- FiniteDifferenceJacobian ----------------
+
+    FiniteDifferenceJacobian::FiniteDifferenceJacobian(sysfunc function, size_t n, const Sparsity& sparsity,
+                                                       size_t n_threads)
+        : dydt(function), pattern(sparsity), offsets(column_offsets(sparsity)), groups(column_groups(sparsity, n)),
+          threads(std::max<size_t>(1, n_threads))
+    {}
+
+    size_t FiniteDifferenceJacobian::evaluations() const {
+        return groups.size();
+    }
+
+    void FiniteDifferenceJacobian::evaluate_groups(size_t first, size_t last, double t, const vec& y,
+                                                   const vec& f0, vec& J) const {
+        const size_t n = y.size();
+        const double root_eps = std::sqrt(std::numeric_limits<double>::epsilon());
+        vec yh = y;
+        vec fh(n);
+        vec h(n);
+        for (size_t g = first; g < last; ++g){
+            for (size_t j : groups[g]){
+                const double step = root_eps*std::max(std::abs(y[j]), 1.)*(y[j] < 0. ? -1. : 1.);
+                yh[j] = y[j] + step;
+                // the step actually taken in floating point
+                h[j] = yh[j] - y[j];
+            }
+            dydt(t, yh, fh);
+            for (size_t j : groups[g]){
+                if (pattern.empty()){
+                    for (size_t i = 0; i < n; ++i){
+                        J[i*n + j] = (fh[i] - f0[i])/h[j];
+                    }
+                }
+                else{
+                    for (size_t k = 0; k < pattern[j].size(); ++k){
+                        const size_t i = pattern[j][k];
+                        J[offsets[j] + k] = (fh[i] - f0[i])/h[j];
+                    }
+                }
+                yh[j] = y[j];
+            }
+        }
+    }
+
+    void FiniteDifferenceJacobian::operator()(double t, const vec& y, vec& f0, vec& J) const {
+        ODE_TRACE_SCOPE("finite_difference");
+        dydt(t, y, f0);
+        if (J.empty()){
+            return;
+        }
+        const size_t n_groups = groups.size();
+        const size_t workers = std::min(threads, n_groups/2);
+        if (workers <= 1){
+            evaluate_groups(0, n_groups, t, y, f0, J);
+            return;
+        }
+        // every thread writes distinct columns of J, also in the compressed layout
+        std::vector<std::thread> pool;
+        for (size_t w = 1; w < workers; ++w){
+            pool.emplace_back(&FiniteDifferenceJacobian::evaluate_groups, this, w*n_groups/workers,
+                              (w+1)*n_groups/workers, t, std::cref(y), std::cref(f0), std::ref(J));
+        }
+        evaluate_groups(0, n_groups/workers, t, y, f0, J);
+        for (auto& thread : pool){
+            thread.join();
+        }
+    }
+
+// -------- DirectionalDifference ----------------
+
+    DirectionalDifference::DirectionalDifference(sysfunc function, size_t n)
+        : dydt(function), t(0.), y(n), f0(n), yh(n), fh(n)
+    {}
+
+    void DirectionalDifference::linearize(double time, const vec& state, vec& f){
+        t = time;
+        y = state;
+        dydt(t, y, f0);
+        f = f0;
+    }
+
+    void DirectionalDifference::apply(const vec& v, vec& Jv){
+        const size_t n = y.size();
+        double v_norm = 0., y_norm = 0.;
+        for (size_t i = 0; i < n; ++i){
+            v_norm += v[i]*v[i];
+            y_norm += y[i]*y[i];
+        }
+        v_norm = std::sqrt(v_norm);
+        if (v_norm == 0.){
+            std::fill(Jv.begin(), Jv.end(), 0.);
+            return;
+        }
+        const double h = std::sqrt(std::numeric_limits<double>::epsilon())*std::max(std::sqrt(y_norm), 1.)/v_norm;
+        for (size_t i = 0; i < n; ++i){
+            yh[i] = y[i] + h*v[i];
+        }
+        dydt(t, yh, fh);
+        for (size_t i = 0; i < n; ++i){
+            Jv[i] = (fh[i] - f0[i])/h;
+        }
+    }
+
+}
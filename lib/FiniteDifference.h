@@ -0,0 +1,80 @@
+#ifndef ORANGE_DRUM_EXPLORER_FINITE_DIFFERENCE_H
+#define ORANGE_DRUM_EXPLORER_FINITE_DIFFERENCE_H
+
+#include <vector>
+
+#include "Solver.h"
+#include "Krylov.h"
+
+namespace OrangeDrumExplorer
+{
+    /**
+     * Group the columns of a Jacobian such that no two columns of a group share a row.\n
+     *
+     * Greedy colouring in column order (Curtis-Powell-Reed). The columns of a group can be
+     * perturbed together, so the Jacobian takes one evaluation per group. Without pattern
+     * every column is its own group.
+     *
+     * @param pattern - sparsity pattern of the n x n Jacobian
+     * @param n - number of rows and columns
+     */
+    std::vector<std::vector<size_t>> column_groups(const Sparsity& pattern, size_t n);
+
+    /**
+     * Jacobian of a system by forward differences.\n
+     *
+     * The column j is perturbed by h_j = sqrt(eps)*max(|y_j|, 1), rounded such that y_j + h_j - y_j
+     * is exact. Columns without common rows in the sparsity pattern are perturbed together.
+     * Groups are evaluated in parallel on `threads` threads if there are at least two groups per
+     * thread; the system then has to be safe to call concurrently.
+     *
+     * @param dydt - system to differentiate
+     * @param pattern - sparsity pattern, empty for a dense Jacobian
+     * @param threads - number of threads evaluating the groups
+     */
+    class FiniteDifferenceJacobian
+    {
+        protected:
+            sysfunc dydt;
+            Sparsity pattern;
+            std::vector<size_t> offsets;
+            std::vector<std::vector<size_t>> groups;
+            size_t threads;
+            // Evaluate the groups [first, last) and store their columns into J
+            void evaluate_groups(size_t first, size_t last, double t, const vec& y, const vec& f0, vec& J) const;
+        public:
+            FiniteDifferenceJacobian(sysfunc dydt, size_t n, const Sparsity& pattern = Sparsity(), size_t threads = 1);
+            /**
+             * Evaluate f(t, y) into f0 and the Jacobian into J, unless J is empty
+             *
+             * @param J - output, row by row (J[i*n + j] = df_i/dy_j) without pattern, otherwise the
+             *      compressed values of the pattern, see column_offsets
+             */
+            void operator()(double t, const vec& y, vec& f0, vec& J) const;
+            // Evaluations of the system per Jacobian, besides the one of f(t, y)
+            size_t evaluations() const;
+    };
+
+    /**
+     * Jacobian-vector products of a system by directional forward differences.\n
+     *
+     * J*v ~ (f(t, y + h*v) - f(t, y))/h with h = sqrt(eps)*max(|y|, 1)/|v|, one evaluation of the
+     * system per product, without forming the Jacobian.
+     */
+    class DirectionalDifference : public JacobianProduct
+    {
+        protected:
+            sysfunc dydt;
+            double t;
+            vec y;
+            vec f0;
+            vec yh;
+            vec fh;
+        public:
+            DirectionalDifference(sysfunc dydt, size_t n);
+            void linearize(double t, const vec& y, vec& f) override;
+            void apply(const vec& v, vec& Jv) override;
+    };
+}
+
+#endif /*ORANGE_DRUM_EXPLORER_FINITE_DIFFERENCE_H*/
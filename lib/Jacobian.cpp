@@ -0,0 +1,74 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "Jacobian.h"
+
+namespace OrangeDrumExplorer{
+
+    namespace {
+        double largest_deviation(const vec& J, const vec& reference){
+            double error = 0.;
+            for (size_t k = 0; k < J.size(); ++k){
+                error = std::max(error, std::abs(J[k] - reference[k])/std::max(std::abs(reference[k]), 1.));
+            }
+            return error;
+        }
+    }
+
+    double jacobian_error(sysfunc dydt, jacfunc jacobian, double t, const vec& y){
+        const size_t n = y.size();
+        const double eps = std::numeric_limits<double>::epsilon();
+        vec J(n*n, 0.);
+        jacobian(t, y, J);
+        vec yh = y, f_plus(n), f_minus(n), f_plus2(n), f_minus2(n);
+        double error = 0.;
+        for (size_t j = 0; j < n; ++j){
+            // central differences with the steps h and 2h, rounded such that y_j +- h is exact
+            const double step = std::cbrt(eps)*std::max(std::abs(y[j]), 1.);
+            yh[j] = y[j] + step;
+            const double h = yh[j] - y[j];
+            dydt(t, yh, f_plus);
+            yh[j] = y[j] - h;
+            dydt(t, yh, f_minus);
+            yh[j] = y[j] + 2.*h;
+            dydt(t, yh, f_plus2);
+            yh[j] = y[j] - 2.*h;
+            dydt(t, yh, f_minus2);
+            yh[j] = y[j];
+            for (size_t i = 0; i < n; ++i){
+                const double reference = (f_plus[i] - f_minus[i])/(2.*h);
+                // the truncation error of the step h is a third of the difference to the step 2h,
+                // the rounding of f is amplified by 1/h
+                const double uncertainty = std::abs(reference - (f_plus2[i] - f_minus2[i])/(4.*h))
+                    + 4.*eps*std::max({std::abs(f_plus[i]), std::abs(f_minus[i]),
+                                       std::abs(f_plus2[i]), std::abs(f_minus2[i])})/h;
+                const double deviation = std::max(std::abs(J[i*n + j] - reference) - uncertainty, 0.);
+                error = std::max(error, deviation/std::max(std::abs(reference), 1.));
+            }
+        }
+        return error;
+    }
+
+    double jacobian_error(adsysfunc dydt, jacfunc jacobian, double t, const vec& y){
+        const size_t n = y.size();
+        adept::Stack stack;
+        advec ay(y.begin(), y.end()), af(n);
+        stack.new_recording();
+        dydt(t, ay, af);
+        stack.independent(&ay[0], n);
+        stack.dependent(&af[0], n);
+        vec reference(n*n), J(n*n, 0.);
+        stack.jacobian(reference.data());
+        // adept stores d f[i]/d y[j] at [j*n + i]
+        vec transposed(n*n);
+        for (size_t i = 0; i < n; ++i){
+            for (size_t j = 0; j < n; ++j){
+                transposed[i*n + j] = reference[j*n + i];
+            }
+        }
+        jacobian(t, y, J);
+        return largest_deviation(J, transposed);
+    }
+
+}
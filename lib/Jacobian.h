@@ -0,0 +1,21 @@
+#ifndef ORANGE_DRUM_EXPLORER_JACOBIAN_H
+#define ORANGE_DRUM_EXPLORER_JACOBIAN_H
+
+#include "Solver.h"
+
+namespace OrangeDrumExplorer
+{
+    /**
+     * Check a user-supplied Jacobian.\n
+     *
+     * Largest deviation of jacobian(t, y) from a reference Jacobian, relative to max(|reference|, 1)
+     * per entry. The reference of an instrumented system is exact from the adept tape. The reference
+     * of a plain system are central differences, and only the deviation beyond their error counts:
+     * the truncation error estimated from the differences with twice the step, and the rounding of f.
+     * Central differences are exact up to rounding for quadratic terms, such as the reactions of Robertson.
+     */
+    double jacobian_error(sysfunc dydt, jacfunc jacobian, double t, const vec& y);
+    double jacobian_error(adsysfunc dydt, jacfunc jacobian, double t, const vec& y);
+}
+
+#endif /*ORANGE_DRUM_EXPLORER_JACOBIAN_H*/
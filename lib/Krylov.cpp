@@ -0,0 +1,184 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+
+#include "Krylov.h"
+#include "Trace.h"
+
+namespace OrangeDrumExplorer{
+
+    namespace {
+        double dot(const vec& a, const vec& b){
+            double sum = 0.;
+            for (size_t i = 0; i < a.size(); ++i){
+                sum += a[i]*b[i];
+            }
+            return sum;
+        }
+
+        double norm(const vec& a){
+            return std::sqrt(dot(a, a));
+        }
+    }
+
+    GmresResult gmres(const linear_operator& A, const vec& b, vec& x, size_t restart, double tolerance,
+                      size_t max_iterations, Preconditioner* preconditioner){
+        ODE_TRACE_SCOPE("gmres");
+        if (restart == 0){
+            throw std::invalid_argument("GMRES needs a Krylov basis of at least one vector");
+        }
+        const size_t n = b.size();
+        x.resize(n, 0.);
+        const double b_norm = norm(b);
+        if (b_norm == 0.){
+            std::fill(x.begin(), x.end(), 0.);
+            return {0, 0., true};
+        }
+        const size_t m = std::min(restart, n);
+        // basis V, Hessenberg matrix H column by column, Givens rotations (c, s)
+        std::vector<vec> V(m + 1, vec(n));
+        std::vector<vec> H(m, vec(m + 1));
+        vec c(m), s(m), g(m + 1), z(n), w(n), update(n);
+
+        GmresResult result{0, 1., false};
+        while (result.iterations < max_iterations){
+            // r = b - A x
+            A(x, w);
+            for (size_t i = 0; i < n; ++i){
+                V[0][i] = b[i] - w[i];
+            }
+            double beta = norm(V[0]);
+            result.residual = beta/b_norm;
+            if (result.residual <= tolerance){
+                result.converged = true;
+                return result;
+            }
+            for (double& v : V[0]){
+                v /= beta;
+            }
+            std::fill(g.begin(), g.end(), 0.);
+            g[0] = beta;
+
+            size_t k = 0;
+            for (; k < m && result.iterations < max_iterations; ++k){
+                ++result.iterations;
+                // w = A M^-1 v_k
+                if (preconditioner){
+                    preconditioner->apply(V[k], z);
+                    A(z, w);
+                }
+                else{
+                    A(V[k], w);
+                }
+                for (size_t j = 0; j <= k; ++j){
+                    H[k][j] = dot(w, V[j]);
+                    for (size_t i = 0; i < n; ++i){
+                        w[i] -= H[k][j]*V[j][i];
+                    }
+                }
+                H[k][k+1] = norm(w);
+                if (H[k][k+1] != 0.){
+                    for (size_t i = 0; i < n; ++i){
+                        V[k+1][i] = w[i]/H[k][k+1];
+                    }
+                }
+                // apply the previous rotations to the new column, then eliminate its subdiagonal entry
+                for (size_t j = 0; j < k; ++j){
+                    const double h = c[j]*H[k][j] + s[j]*H[k][j+1];
+                    H[k][j+1] = -s[j]*H[k][j] + c[j]*H[k][j+1];
+                    H[k][j] = h;
+                }
+                const double r = std::hypot(H[k][k], H[k][k+1]);
+                c[k] = r == 0. ? 1. : H[k][k]/r;
+                s[k] = r == 0. ? 0. : H[k][k+1]/r;
+                H[k][k] = r;
+                H[k][k+1] = 0.;
+                g[k+1] = -s[k]*g[k];
+                g[k] = c[k]*g[k];
+                result.residual = std::abs(g[k+1])/b_norm;
+                if (result.residual <= tolerance || H[k][k] == 0.){
+                    ++k;
+                    break;
+                }
+            }
+            // y = R^-1 g by back substitution, x += M^-1 V y
+            vec y(k);
+            for (size_t j = k; j-- > 0;){
+                double sum = g[j];
+                for (size_t l = j + 1; l < k; ++l){
+                    sum -= H[l][j]*y[l];
+                }
+                y[j] = H[j][j] == 0. ? 0. : sum/H[j][j];
+            }
+            std::fill(update.begin(), update.end(), 0.);
+            for (size_t j = 0; j < k; ++j){
+                for (size_t i = 0; i < n; ++i){
+                    update[i] += y[j]*V[j][i];
+                }
+            }
+            if (preconditioner){
+                preconditioner->apply(update, z);
+                update.swap(z);
+            }
+            for (size_t i = 0; i < n; ++i){
+                x[i] += update[i];
+            }
+            if (result.residual <= tolerance){
+                result.converged = true;
+                return result;
+            }
+            if (k > 0 && H[k-1][k-1] == 0.){
+                // breakdown without progress, the system is singular
+                return result;
+            }
+        }
+        return result;
+    }
+
+    double spectral_radius(const linear_operator& A, vec& v, double tolerance, size_t max_iterations){
+        ODE_TRACE_SCOPE("spectral_radius");
+        const size_t n = v.size();
+        double norm = 0.;
+        for (double vi : v){
+            norm += vi*vi;
+        }
+        if (norm == 0.){
+            // all eigenvectors present, unlike e.g. f(t, y) on a smooth solution
+            std::mt19937 engine(42);
+            std::uniform_real_distribution<double> uniform(-1., 1.);
+            for (double& vi : v){
+                vi = uniform(engine);
+                norm += vi*vi;
+            }
+        }
+        norm = std::sqrt(norm);
+        for (double& vi : v){
+            vi /= norm;
+        }
+        vec Av(n);
+        double estimate = 0.;
+        for (size_t k = 0; k < max_iterations; ++k){
+            A(v, Av);
+            double next = 0.;
+            for (double x : Av){
+                next += x*x;
+            }
+            next = std::sqrt(next);
+            if (next == 0.){
+                // v is in the null space
+                return estimate;
+            }
+            for (size_t i = 0; i < n; ++i){
+                v[i] = Av[i]/next;
+            }
+            const bool converged = std::abs(next - estimate) <= tolerance*next;
+            estimate = next;
+            if (converged){
+                break;
+            }
+        }
+        return estimate;
+    }
+
+}
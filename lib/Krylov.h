@@ -0,0 +1,84 @@
+#ifndef ORANGE_DRUM_EXPLORER_KRYLOV_H
+#define ORANGE_DRUM_EXPLORER_KRYLOV_H
+
+#include <functional>
+#include <vector>
+
+#include "Solver.h"
+
+namespace OrangeDrumExplorer
+{
+    // y = A x
+    typedef std::function<void(const vec& x, vec& y)> linear_operator;
+
+    /**
+     * Products of the Jacobian of a system with vectors, without forming the Jacobian.\n
+     *
+     * linearize() evaluates the system at a point, apply() then gives J*v at that point.
+     */
+    class JacobianProduct
+    {
+        public:
+            virtual ~JacobianProduct() = default;
+            // Evaluate f(t, y) into f and prepare the products at (t, y)
+            virtual void linearize(double t, const vec& y, vec& f) = 0;
+            // Jv = df/dy(t, y) v at the point of the last linearize
+            virtual void apply(const vec& v, vec& Jv) = 0;
+    };
+
+    /**
+     * Preconditioner of the Newton matrix I - dt*J of the implicit solvers.\n
+     *
+     * GMRES is preconditioned from the right, so the preconditioner only changes the
+     * convergence, not the solution. Derive from it to plug in an approximate inverse,
+     * e.g. of the stiff part of the system.
+     */
+    class Preconditioner
+    {
+        public:
+            virtual ~Preconditioner() = default;
+            /**
+             * Prepare for the Newton matrix at (t, y), called once per Newton iteration
+             *
+             * @param jv - Jacobian-vector product at (t, y), e.g. to probe the diagonal
+             */
+            virtual void setup(double /*t*/, const vec& /*y*/, double /*dt*/, const linear_operator& /*jv*/) {}
+            // z ~ (I - dt*J)^-1 r
+            virtual void apply(const vec& r, vec& z) = 0;
+    };
+
+    struct GmresResult {
+        size_t iterations;
+        // norm of the final residual relative to the norm of b
+        double residual;
+        bool converged;
+    };
+
+    /**
+     * Solve A x = b by restarted GMRES with right preconditioning.\n
+     *
+     * Modified Gram-Schmidt and Givens rotations; the Krylov basis takes (restart+1)*n doubles.
+     *
+     * @param x - initial guess, output solution
+     * @param restart - size of the Krylov basis before a restart
+     * @param tolerance - stop at |b - A x| <= tolerance*|b|
+     * @param max_iterations - total number of products with A
+     * @param preconditioner - nullptr for none
+     */
+    GmresResult gmres(const linear_operator& A, const vec& b, vec& x, size_t restart, double tolerance,
+                      size_t max_iterations, Preconditioner* preconditioner = nullptr);
+
+    /**
+     * Estimate of the spectral radius of A by power iteration.\n
+     *
+     * The estimate |A v|/|v| of the iterates approaches the largest magnitude of the eigenvalues from
+     * below; it stops once two successive estimates agree within the relative tolerance.
+     *
+     * @param v - start vector, e.g. the result of an earlier estimate; output the last iterate, normalized.
+     *      A zero vector is replaced by pseudo-random values.
+     * @param max_iterations - number of products with A
+     */
+    double spectral_radius(const linear_operator& A, vec& v, double tolerance = 0.01, size_t max_iterations = 20);
+}
+
+#endif /*ORANGE_DRUM_EXPLORER_KRYLOV_H*/
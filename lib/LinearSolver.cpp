@@ -0,0 +1,316 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "LinearSolver.h"
+#include "Trace.h"
+
+namespace OrangeDrumExplorer{
+
+    namespace {
+        typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> RowMatrix;
+
+        void check_pattern(const Sparsity& pattern, size_t n){
+            if (pattern.size() != n){
+                throw std::invalid_argument("The sparsity pattern needs one entry per column");
+            }
+        }
+
+        // A = dt*J - I, from the compressed values of J with a sparsity pattern
+        void newton_matrix(Eigen::MatrixXd& A, const vec& J, size_t n, double dt, const Sparsity& pattern){
+            if (pattern.empty()){
+                A = dt*Eigen::Map<const RowMatrix>(J.data(), n, n);
+            }
+            else{
+                check_pattern(pattern, n);
+                A.setZero(n, n);
+                size_t k = 0;
+                for (size_t j = 0; j < n; ++j){
+                    for (size_t i : pattern[j]){
+                        A(i, j) += dt*J[k++];
+                    }
+                }
+            }
+            A.diagonal().array() -= 1.;
+        }
+
+        // The sparse LU pays off from a few dozen unknowns if most of the Jacobian is zero
+        bool factorize_sparse(const Sparsity& pattern, size_t n){
+            if (pattern.empty() || n < 32){
+                return false;
+            }
+            size_t non_zeros = 0;
+            for (const auto& rows : pattern){
+                non_zeros += rows.size();
+            }
+            return non_zeros*8 <= n*n;
+        }
+    }
+
+    bool FullPivLUSolver::factorize(const vec& J, size_t n, double dt, const Sparsity& pattern){
+        ODE_TRACE_SCOPE("fullPivLu");
+        newton_matrix(A, J, n, dt, pattern);
+        lu.compute(A);
+        return true;
+    }
+
+    bool FullPivLUSolver::solve(const vec& b, vec& x){
+        const Eigen::Map<const Eigen::VectorXd> rhs(b.data(), b.size());
+        x.resize(b.size());
+        Eigen::Map<Eigen::VectorXd> solution(x.data(), x.size());
+        solution = lu.solve(rhs);
+        // a singular matrix gives the least squares solution
+        return (A*solution).isApprox(rhs);
+    }
+
+    bool PartialPivLUSolver::factorize(const vec& J, size_t n, double dt, const Sparsity& pattern){
+        ODE_TRACE_SCOPE("partialPivLu");
+        newton_matrix(A, J, n, dt, pattern);
+        lu.compute(A);
+        return true;
+    }
+
+    bool PartialPivLUSolver::solve(const vec& b, vec& x){
+        const Eigen::Map<const Eigen::VectorXd> rhs(b.data(), b.size());
+        x.resize(b.size());
+        Eigen::Map<Eigen::VectorXd> solution(x.data(), x.size());
+        solution = lu.solve(rhs);
+        // the LU doesn't detect singular matrices, the residual does
+        return (A*solution).isApprox(rhs);
+    }
+
+    bool CholeskySolver::factorize(const vec& J, size_t n, double dt, const Sparsity& pattern){
+        ODE_TRACE_SCOPE("cholesky");
+        // L L^T = I - dt*J, only the lower triangle is read
+        newton_matrix(L, J, n, dt, pattern);
+        L = -L;
+        // left-looking, column j from the columns before it
+        for (Eigen::Index j = 0; j < Eigen::Index(n); ++j){
+            const Eigen::Index below = n - j - 1;
+            const double d = L(j, j) - L.row(j).head(j).squaredNorm();
+            if (!(d > 0.)){
+                return false;
+            }
+            L(j, j) = std::sqrt(d);
+            L.col(j).tail(below).noalias() -= L.bottomLeftCorner(below, j)*L.row(j).head(j).transpose();
+            L.col(j).tail(below) /= L(j, j);
+        }
+        return true;
+    }
+
+    bool CholeskySolver::solve(const vec& b, vec& x){
+        x = b;
+        Eigen::Map<Eigen::VectorXd> solution(x.data(), x.size());
+        L.triangularView<Eigen::Lower>().solveInPlace(solution);
+        L.transpose().triangularView<Eigen::Upper>().solveInPlace(solution);
+        // (I - dt*J) y = b gives (dt*J - I) x = b for x = -y
+        solution = -solution;
+        return true;
+    }
+
+    BandedLUSolver::BandedLUSolver() : kl(0), ku(0), from_pattern(true), storage(Storage::dense) {}
+
+    BandedLUSolver::BandedLUSolver(size_t lower, size_t upper, Storage layout)
+        : kl(lower), ku(upper), from_pattern(false), storage(layout) {}
+
+    double& BandedLUSolver::at(size_t i, size_t j){
+        return band[(kl + ku + i - j) + j*(2*kl + ku + 1)];
+    }
+
+    bool BandedLUSolver::factorize(const vec& J, size_t size, double dt, const Sparsity& pattern){
+        ODE_TRACE_SCOPE("bandedLu");
+        n = size;
+        if (from_pattern){
+            if (pattern.empty()){
+                throw std::invalid_argument("The banded LU needs the bandwidths or a sparsity pattern");
+            }
+            check_pattern(pattern, n);
+            kl = 0;
+            ku = 0;
+            for (size_t j = 0; j < n; ++j){
+                for (size_t i : pattern[j]){
+                    kl = std::max(kl, i > j ? i - j : 0);
+                    ku = std::max(ku, j > i ? j - i : 0);
+                }
+            }
+        }
+        // kl extra rows above the band for the fill-in of the row interchanges
+        band.assign((2*kl + ku + 1)*n, 0.);
+        pivots.resize(n);
+        if (storage == Storage::dense && !pattern.empty()){
+            // the compressed values of the pattern, those outside the band are skipped
+            check_pattern(pattern, n);
+            size_t k = 0;
+            for (size_t j = 0; j < n; ++j){
+                for (size_t i : pattern[j]){
+                    const double entry = J[k++];
+                    if (i <= j + kl && j <= i + ku){
+                        at(i, j) += dt*entry;
+                    }
+                }
+                at(j, j) -= 1.;
+            }
+        }
+        else{
+            for (size_t j = 0; j < n; ++j){
+                const size_t first = j > ku ? j - ku : 0;
+                const size_t last = std::min(n - 1, j + kl);
+                for (size_t i = first; i <= last; ++i){
+                    const double entry = storage == Storage::band ? J[(ku + i - j) + j*(kl + ku + 1)] : J[i*n + j];
+                    at(i, j) = dt*entry - (i == j ? 1. : 0.);
+                }
+            }
+        }
+        // LAPACK dgbtf2: partial pivoting within the kl rows below the diagonal
+        size_t ju = 0;
+        for (size_t j = 0; j < n; ++j){
+            const size_t km = std::min(kl, n - 1 - j);
+            size_t jp = 0;
+            for (size_t r = 1; r <= km; ++r){
+                if (std::abs(at(j + r, j)) > std::abs(at(j + jp, j))){
+                    jp = r;
+                }
+            }
+            pivots[j] = j + jp;
+            const double pivot = at(j + jp, j);
+            if (pivot == 0. || !std::isfinite(pivot)){
+                return false;
+            }
+            ju = std::max(ju, std::min(j + ku + jp, n - 1));
+            if (jp != 0){
+                for (size_t c = j; c <= ju; ++c){
+                    std::swap(at(j, c), at(j + jp, c));
+                }
+            }
+            for (size_t r = 1; r <= km; ++r){
+                at(j + r, j) /= pivot;
+            }
+            for (size_t c = j + 1; c <= ju; ++c){
+                const double u = at(j, c);
+                if (u != 0.){
+                    for (size_t r = 1; r <= km; ++r){
+                        at(j + r, c) -= at(j + r, j)*u;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    bool BandedLUSolver::solve(const vec& b, vec& x){
+        x = b;
+        // L y = P b
+        for (size_t j = 0; j + 1 < n; ++j){
+            const size_t km = std::min(kl, n - 1 - j);
+            std::swap(x[j], x[pivots[j]]);
+            for (size_t r = 1; r <= km; ++r){
+                x[j + r] -= at(j + r, j)*x[j];
+            }
+        }
+        // U x = y, U has kl + ku superdiagonals after the interchanges
+        const size_t kv = kl + ku;
+        for (size_t j = n; j-- > 0;){
+            x[j] /= at(j, j);
+            for (size_t i = j > kv ? j - kv : 0; i < j; ++i){
+                x[i] -= at(i, j)*x[j];
+            }
+        }
+        return true;
+    }
+
+    bool SparseLUSolver::factorize(const vec& J, size_t n, double dt, const Sparsity& pattern){
+        ODE_TRACE_SCOPE("sparseLu");
+        check_pattern(pattern, n);
+        // J holds the compressed values of the pattern, duplicates of the diagonal are summed
+        entries.clear();
+        size_t k = 0;
+        for (size_t j = 0; j < n; ++j){
+            entries.emplace_back(j, j, -1.);
+            for (size_t i : pattern[j]){
+                entries.emplace_back(i, j, dt*J[k++]);
+            }
+        }
+        A.resize(n, n);
+        A.setFromTriplets(entries.begin(), entries.end());
+        if (pattern != analysed){
+            lu.analyzePattern(A);
+            analysed = pattern;
+        }
+        lu.factorize(A);
+        return lu.info() == Eigen::Success;
+    }
+
+    bool SparseLUSolver::solve(const vec& b, vec& x){
+        const Eigen::Map<const Eigen::VectorXd> rhs(b.data(), b.size());
+        x.resize(b.size());
+        Eigen::Map<Eigen::VectorXd> solution(x.data(), x.size());
+        solution = lu.solve(rhs);
+        return (A*solution).isApprox(rhs);
+    }
+
+    bool AutomaticSolver::factorize(const vec& J, size_t n, double dt, const Sparsity& pattern){
+        chosen = factorize_sparse(pattern, n) ? static_cast<LinearSolver*>(&sparse) : &dense;
+        return chosen->factorize(J, n, dt, pattern);
+    }
+
+    bool AutomaticSolver::solve(const vec& b, vec& x){
+        return chosen->solve(b, x);
+    }
+
+    bool ComplexShiftSolver::factorize(const vec& J, size_t n, complex shift, const Sparsity& pattern){
+        ODE_TRACE_SCOPE("complexLu");
+        use_sparse = factorize_sparse(pattern, n);
+        if (!use_sparse){
+            if (pattern.empty()){
+                A = -Eigen::Map<const RowMatrix>(J.data(), n, n).cast<complex>();
+            }
+            else{
+                check_pattern(pattern, n);
+                A.setZero(n, n);
+                size_t k = 0;
+                for (size_t j = 0; j < n; ++j){
+                    for (size_t i : pattern[j]){
+                        A(i, j) -= J[k++];
+                    }
+                }
+            }
+            A.diagonal().array() += shift;
+            dense.compute(A);
+            return true;
+        }
+        check_pattern(pattern, n);
+        entries.clear();
+        size_t k = 0;
+        for (size_t j = 0; j < n; ++j){
+            entries.emplace_back(j, j, shift);
+            for (size_t i : pattern[j]){
+                entries.emplace_back(i, j, -J[k++]);
+            }
+        }
+        S.resize(n, n);
+        S.setFromTriplets(entries.begin(), entries.end());
+        if (pattern != analysed){
+            sparse.analyzePattern(S);
+            analysed = pattern;
+        }
+        sparse.factorize(S);
+        return sparse.info() == Eigen::Success;
+    }
+
+    bool ComplexShiftSolver::solve(const vec& b_re, const vec& b_im, vec& x_re, vec& x_im){
+        const size_t n = b_re.size();
+        rhs.resize(n);
+        for (size_t i = 0; i < n; ++i){
+            rhs[i] = complex(b_re[i], b_im[i]);
+        }
+        solution = use_sparse ? Eigen::VectorXcd(sparse.solve(rhs)) : Eigen::VectorXcd(dense.solve(rhs));
+        x_re.resize(n);
+        x_im.resize(n);
+        for (size_t i = 0; i < n; ++i){
+            x_re[i] = solution[i].real();
+            x_im[i] = solution[i].imag();
+        }
+        return use_sparse ? (S*solution).isApprox(rhs) : (A*solution).isApprox(rhs);
+    }
+
+}
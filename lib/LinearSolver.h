@@ -0,0 +1,173 @@
+#ifndef ORANGE_DRUM_EXPLORER_LINEAR_SOLVER_H
+#define ORANGE_DRUM_EXPLORER_LINEAR_SOLVER_H
+
+#include <complex>
+#include <vector>
+
+#include <Eigen/Core>
+#include <Eigen/LU>
+#include <Eigen/SparseCore>
+#include <Eigen/SparseLU>
+
+#include "Solver.h"
+
+namespace OrangeDrumExplorer
+{
+    /**
+     * Strategy factorizing the Newton matrix dt*J - I of the implicit solvers.\n
+     *
+     * Set at runtime with EulerImplicit::set_linear_solver or at compile time with
+     * EulerImplicitWith<Strategy>.
+     */
+    class LinearSolver
+    {
+        public:
+            virtual ~LinearSolver() = default;
+            /**
+             * Factorize dt*J - I
+             *
+             * @param J - Jacobian row by row, J[i*n + j] = df_i/dy_j, or with a pattern only its
+             *      compressed values, see column_offsets; the dense strategies expand them
+             * @param pattern - sparsity pattern of J, for every column its rows; empty if unknown
+             * @return false if the matrix can't be factorized by this strategy
+             */
+            virtual bool factorize(const vec& J, size_t n, double dt, const Sparsity& pattern) = 0;
+            // x = (dt*J - I)^-1 b with the last factorization, false if x doesn't solve the system
+            virtual bool solve(const vec& b, vec& x) = 0;
+    };
+
+    // Dense LU with full pivoting, the most robust and the slowest
+    class FullPivLUSolver : public LinearSolver
+    {
+        protected:
+            Eigen::MatrixXd A;
+            Eigen::FullPivLU<Eigen::MatrixXd> lu;
+        public:
+            bool factorize(const vec& J, size_t n, double dt, const Sparsity& pattern) override;
+            bool solve(const vec& b, vec& x) override;
+    };
+
+    // Dense LU with partial (row) pivoting
+    class PartialPivLUSolver : public LinearSolver
+    {
+        protected:
+            Eigen::MatrixXd A;
+            Eigen::PartialPivLU<Eigen::MatrixXd> lu;
+        public:
+            bool factorize(const vec& J, size_t n, double dt, const Sparsity& pattern) override;
+            bool solve(const vec& b, vec& x) override;
+    };
+
+    /**
+     * Dense Cholesky factorization L L^T of I - dt*J.\n
+     *
+     * Only for symmetric J whose eigenvalues are below 1/dt, e.g. diffusion; factorize
+     * returns false if I - dt*J isn't positive definite.
+     */
+    class CholeskySolver : public LinearSolver
+    {
+        protected:
+            Eigen::MatrixXd L;
+        public:
+            bool factorize(const vec& J, size_t n, double dt, const Sparsity& pattern) override;
+            bool solve(const vec& b, vec& x) override;
+    };
+
+    /**
+     * Banded LU with partial pivoting in LAPACK band storage, O(n*kl*(kl+ku)).\n
+     *
+     * Entries of J outside the band are ignored. Without explicit bandwidths they are
+     * taken from the sparsity pattern, which then has to be given.
+     *
+     * @param lower - number of subdiagonals kl
+     * @param upper - number of superdiagonals ku
+     * @param storage - layout of J passed to factorize: the dense row-major n*n matrix (the compressed
+     *      values if there is a pattern), or only its band, df_i/dy_j at J[(ku + i - j) + j*(kl + ku + 1)] as in LAPACK general band
+     *      storage, (kl + ku + 1)*n doubles
+     */
+    class BandedLUSolver : public LinearSolver
+    {
+        public:
+            enum class Storage { dense, band };
+        protected:
+            size_t kl;
+            size_t ku;
+            bool from_pattern;
+            Storage storage;
+            size_t n = 0;
+            // entry (i, j) at band[(kl + ku + i - j) + j*(2*kl + ku + 1)]
+            vec band;
+            std::vector<size_t> pivots;
+            double& at(size_t i, size_t j);
+        public:
+            BandedLUSolver();
+            BandedLUSolver(size_t lower, size_t upper, Storage storage = Storage::dense);
+            bool factorize(const vec& J, size_t n, double dt, const Sparsity& pattern) override;
+            bool solve(const vec& b, vec& x) override;
+    };
+
+    // Sparse LU of the compressed entries of the sparsity pattern, with COLAMD ordering
+    class SparseLUSolver : public LinearSolver
+    {
+        protected:
+            std::vector<Eigen::Triplet<double>> entries;
+            // pattern of the last symbolic analysis, reused while it doesn't change
+            Sparsity analysed;
+            Eigen::SparseMatrix<double> A;
+            Eigen::SparseLU<Eigen::SparseMatrix<double>, Eigen::COLAMDOrdering<int>> lu;
+        public:
+            bool factorize(const vec& J, size_t n, double dt, const Sparsity& pattern) override;
+            bool solve(const vec& b, vec& x) override;
+    };
+
+    /**
+     * Default strategy: sparse LU for patterns from 32 columns with at most n^2/8 entries,
+     * partial pivoting LU otherwise.
+     */
+    class AutomaticSolver : public LinearSolver
+    {
+        protected:
+            SparseLUSolver sparse;
+            PartialPivLUSolver dense;
+            LinearSolver* chosen = nullptr;
+        public:
+            bool factorize(const vec& J, size_t n, double dt, const Sparsity& pattern) override;
+            bool solve(const vec& b, vec& x) override;
+    };
+
+    /**
+     * Factorization of shift*I - J for a complex shift, the complex eigenvalue pair of the stage
+     * system of implicit Runge-Kutta methods (see RadauIIA.h); the complex system of size n replaces
+     * a real one of size 2n. Sparse LU for the patterns of AutomaticSolver, partial pivoting LU otherwise.
+     */
+    class ComplexShiftSolver
+    {
+        protected:
+            typedef std::complex<double> complex;
+            Eigen::MatrixXcd A;
+            Eigen::PartialPivLU<Eigen::MatrixXcd> dense;
+            std::vector<Eigen::Triplet<complex>> entries;
+            Sparsity analysed;
+            Eigen::SparseMatrix<complex> S;
+            Eigen::SparseLU<Eigen::SparseMatrix<complex>, Eigen::COLAMDOrdering<int>> sparse;
+            bool use_sparse = false;
+            Eigen::VectorXcd rhs, solution;
+        public:
+            // @param J - Jacobian row by row, J[i*n + j] = df_i/dy_j, compressed with a pattern as for LinearSolver
+            bool factorize(const vec& J, size_t n, complex shift, const Sparsity& pattern);
+            // x_re + i*x_im = (shift*I - J)^-1 (b_re + i*b_im), false if x doesn't solve the system
+            bool solve(const vec& b_re, const vec& b_im, vec& x_re, vec& x_im);
+    };
+
+    // Implicit Euler with the linear solver fixed at compile time
+    template <typename Strategy>
+    class EulerImplicitWith : public EulerImplicit {
+        public:
+            template <typename... Args>
+            EulerImplicitWith(Args... args) : EulerImplicit(args...) {
+                set_linear_solver(std::make_shared<Strategy>());
+            }
+    };
+}
+
+#endif /*ORANGE_DRUM_EXPLORER_LINEAR_SOLVER_H*/
@@ -0,0 +1,86 @@
+#include <stdexcept>
+
+#include "LowStorageRK.h"
+#include "Trace.h"
+
+namespace OrangeDrumExplorer{
+
+    LowStorageRK::Scheme LowStorageRK::williamson3(){
+        return {{0., -5./9., -153./128.},
+                {1./3., 15./16., 8./15.},
+                {0., 1./3., 3./4.},
+                3};
+    }
+
+    LowStorageRK::Scheme LowStorageRK::carpenter_kennedy4(){
+        return {{0.,
+                 -567301805773./1357537059087.,
+                 -2404267990393./2016746695238.,
+                 -3550918686646./2091501179385.,
+                 -1275806237668./842570457699.},
+                {1432997174477./9575080441755.,
+                 5161836677717./13612068292357.,
+                 1720146321549./2090206949498.,
+                 3134564353537./4481467310338.,
+                 2277821191437./14882151754819.},
+                {0.,
+                 1432997174477./9575080441755.,
+                 2526269341429./6820363962896.,
+                 2006345519317./3224310063776.,
+                 2802321613138./2924317926251.},
+                4};
+    }
+
+    LowStorageRK::LowStorageRK()
+        : LowStorageRK(0., 1.)
+    {}
+
+    LowStorageRK::LowStorageRK(double low, double high, Scheme new_scheme)
+        : StreamingSolver(low, high)
+    {
+        set_scheme(new_scheme);
+    }
+
+    void LowStorageRK::set_scheme(const Scheme& new_scheme){
+        const size_t stages = new_scheme.A.size();
+        if (stages == 0 || new_scheme.B.size() != stages || new_scheme.c.size() != stages){
+            throw std::invalid_argument("The scheme needs A, B and c for every stage");
+        }
+        if (new_scheme.A[0] != 0.){
+            // the first stage doesn't carry the increment of the previous step
+            throw std::invalid_argument("The first stage needs A = 0");
+        }
+        scheme = new_scheme;
+    }
+
+    vec LowStorageRK::solve(sysfunc dydt, const vec& y0, const sink& output){
+        const double a = limit_low;
+        const double b = limit_high;
+        const double dt = time_step;
+        const size_t N = (b-a)/dt;
+        const size_t n = y0.size();
+        const size_t stages = scheme.A.size();
+
+        // the registers: state, increment and the derivative written by the system
+        vec y = y0;
+        vec dq(n, 0.);
+        vec f(n);
+        output(a, y);
+        for (size_t i = 0; i < N; ++i){
+            ODE_TRACE_SCOPE("step");
+            const double t = a + i*dt;
+            for (size_t s = 0; s < stages; ++s){
+                const double A = scheme.A[s];
+                const double B = scheme.B[s];
+                dydt(t + scheme.c[s]*dt, y, f);
+                for (size_t j = 0; j < n; ++j){
+                    dq[j] = A*dq[j] + dt*f[j];
+                    y[j] += B*dq[j];
+                }
+            }
+            output(a + (i+1)*dt, y);
+        }
+        return y;
+    }
+
+}
@@ -0,0 +1,51 @@
+#ifndef ORANGE_DRUM_EXPLORER_LOW_STORAGE_RK_H
+#define ORANGE_DRUM_EXPLORER_LOW_STORAGE_RK_H
+
+#include <vector>
+
+#include "Solver.h"
+
+namespace OrangeDrumExplorer
+{
+    /**
+     * Explicit Runge-Kutta methods in Williamson's 2N-storage form.\n
+     *
+     * Every stage i updates two registers of the state size,
+     *      dq = A_i*dq + dt*f(t + c_i*dt, y)
+     *      y  = y + B_i*dq
+     * so the memory doesn't grow with the number of stages. The system writes its derivative into
+     * a third register; a classic four-stage method needs six. With a sink nothing but these
+     * registers is allocated, independent of the number of steps.
+     */
+    class LowStorageRK : public StreamingSolver {
+        public:
+            struct Scheme {
+                std::vector<double> A;
+                std::vector<double> B;
+                std::vector<double> c;
+                int order;
+            };
+            // Williamson (1980), 3 stages, order 3
+            static Scheme williamson3();
+            // Carpenter and Kennedy (1994), 5 stages, order 4
+            static Scheme carpenter_kennedy4();
+
+            LowStorageRK();
+            LowStorageRK(double limit_low, double limit_high, Scheme scheme = carpenter_kennedy4());
+            void set_scheme(const Scheme&);
+            using StreamingSolver::solve;
+            /**
+             * Solve a system without storing the solution
+             *
+             * @param output - called with the initial state and after every step; the state is
+             *      only valid during the call
+             * @return the state at the last step
+             */
+            vec solve(sysfunc dydt, const vec& y0, const sink& output) override;
+
+        protected:
+            Scheme scheme;
+    };
+}
+
+#endif /*ORANGE_DRUM_EXPLORER_LOW_STORAGE_RK_H*/
@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include "MethodOfLines.h"
+#include "Trace.h"
+
+namespace OrangeDrumExplorer{
+
+    MethodOfLines::Boundary MethodOfLines::Boundary::dirichlet(double value){
+        return {Type::dirichlet, [value](double){ return value; }};
+    }
+
+    MethodOfLines::Boundary MethodOfLines::Boundary::dirichlet(std::function<double(double)> value){
+        return {Type::dirichlet, value};
+    }
+
+    MethodOfLines::Boundary MethodOfLines::Boundary::neumann(double slope){
+        return {Type::neumann, [slope](double){ return slope; }};
+    }
+
+    MethodOfLines::Boundary MethodOfLines::Boundary::neumann(std::function<double(double)> slope){
+        return {Type::neumann, slope};
+    }
+
+    MethodOfLines::stencil MethodOfLines::diffusion(double diffusivity){
+        return [diffusivity](double, double, const double* u, double dx){
+            return diffusivity*(u[-1] - 2.*u[0] + u[1])/(dx*dx);
+        };
+    }
+
+    MethodOfLines::MethodOfLines(stencil function, size_t radius, size_t n_points, double low_limit, double high_limit,
+                                 Boundary low_boundary, Boundary high_boundary)
+        : rhs(function), r(radius), m(n_points), x_low(low_limit), h((high_limit - low_limit)/n_points),
+          low(low_boundary), high(high_boundary)
+    {
+        if (n_points == 0 || !(high_limit > low_limit)){
+            throw std::invalid_argument("The method of lines needs at least one point on a non-empty interval");
+        }
+        if (n_points < radius){
+            // the ghost values mirror the first `radius` points
+            throw std::invalid_argument("The stencil is wider than the grid");
+        }
+    }
+
+    size_t MethodOfLines::points() const {
+        return m;
+    }
+
+    size_t MethodOfLines::radius() const {
+        return r;
+    }
+
+    double MethodOfLines::x(size_t i) const {
+        return x_low + (i + 0.5)*h;
+    }
+
+    double MethodOfLines::dx() const {
+        return h;
+    }
+
+    vec MethodOfLines::discretize(const std::function<double(double)>& u) const {
+        vec values(m);
+        for (size_t i = 0; i < m; ++i){
+            values[i] = u(x(i));
+        }
+        return values;
+    }
+
+    Sparsity MethodOfLines::sparsity() const {
+        Sparsity pattern(m);
+        for (size_t j = 0; j < m; ++j){
+            for (size_t i = j > r ? j - r : 0; i <= std::min(m - 1, j + r); ++i){
+                pattern[j].push_back(i);
+            }
+        }
+        return pattern;
+    }
+
+    void MethodOfLines::evaluate(double t, const vec& u, vec& dudt, vec& padded) const {
+        padded.resize(m + 2*r);
+        std::copy(u.begin(), u.end(), padded.begin() + r);
+        const double g_low = low.value(t);
+        const double g_high = high.value(t);
+        // the ghost value k cells beyond a boundary mirrors the k-th point inside, at distance (2k+1)*dx
+        for (size_t k = 0; k < r; ++k){
+            const double inside_low = u[k];
+            const double inside_high = u[m - 1 - k];
+            padded[r - 1 - k] = low.type == Boundary::Type::dirichlet ? 2.*g_low - inside_low
+                                                                      : inside_low - (2.*k + 1.)*h*g_low;
+            padded[r + m + k] = high.type == Boundary::Type::dirichlet ? 2.*g_high - inside_high
+                                                                       : inside_high + (2.*k + 1.)*h*g_high;
+        }
+        for (size_t i = 0; i < m; ++i){
+            dudt[i] = rhs(t, x(i), &padded[r + i], h);
+        }
+    }
+
+    void MethodOfLines::operator()(double t, const vec& u, vec& dudt) const {
+        if (u.size() != m){
+            throw std::invalid_argument("The state needs one value per point of the grid");
+        }
+        vec padded;
+        evaluate(t, u, dudt, padded);
+    }
+
+    sysfunc MethodOfLines::system() const {
+        return *this;
+    }
+
+    void MethodOfLines::linearize(double t, const vec& u, vec& dudt, vec& J) const {
+        ODE_TRACE_SCOPE("method_of_lines_jacobian");
+        if (u.size() != m){
+            throw std::invalid_argument("The state needs one value per point of the grid");
+        }
+        const size_t width = 2*r + 1;
+        const double root_eps = std::sqrt(std::numeric_limits<double>::epsilon());
+        J.resize(width*m);
+        vec padded, uh = u, fh(m), step(m);
+        evaluate(t, u, dudt, padded);
+        for (size_t first = 0; first < std::min(width, m); ++first){
+            for (size_t j = first; j < m; j += width){
+                uh[j] = u[j] + root_eps*std::max(std::abs(u[j]), 1.)*(u[j] < 0. ? -1. : 1.);
+                // the step actually taken in floating point
+                step[j] = uh[j] - u[j];
+            }
+            evaluate(t, uh, fh, padded);
+            for (size_t j = first; j < m; j += width){
+                for (size_t i = j > r ? j - r : 0; i <= std::min(m - 1, j + r); ++i){
+                    J[(r + i - j) + j*width] = (fh[i] - dudt[i])/step[j];
+                }
+                uh[j] = u[j];
+            }
+        }
+    }
+
+}
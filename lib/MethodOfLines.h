@@ -0,0 +1,88 @@
+#ifndef ORANGE_DRUM_EXPLORER_METHOD_OF_LINES_H
+#define ORANGE_DRUM_EXPLORER_METHOD_OF_LINES_H
+
+#include <functional>
+#include <vector>
+
+#include "Solver.h"
+
+namespace OrangeDrumExplorer
+{
+    /**
+     * Semi-discrete system of a 1D partial differential equation u_t = F(t, x, u, u_x, u_xx, ...).\n
+     *
+     * The interval [x_low, x_high] is split into `points` cells of width dx, with the unknowns at
+     * the cell centres x_i = x_low + (i + 1/2)*dx. The right-hand side at every centre is given by
+     * a stencil over the 2*radius + 1 neighbouring values. Beyond the ends the values are mirrored
+     * at the boundary: u(x_low - s) = 2g - u(x_low + s) for a Dirichlet condition u = g, and
+     * u(x_low - s) = u(x_low + s) - 2s*q for a Neumann condition u_x = q (likewise at x_high).
+     * Every equation then depends on the unknowns within the radius only, so the Jacobian is
+     * banded with `radius` sub- and superdiagonals, see EulerImplicit::solve(const MethodOfLines&, ...).
+     */
+    class MethodOfLines
+    {
+        public:
+            /**
+             * Right-hand side of the PDE at one cell centre
+             *
+             * @param t - time
+             * @param x - position of the cell centre
+             * @param u - values around the cell, u[-radius] ... u[radius], u[0] at x
+             * @param dx - cell width
+             */
+            typedef std::function<double(double t, double x, const double* u, double dx)> stencil;
+
+            struct Boundary {
+                enum class Type { dirichlet, neumann };
+                Type type;
+                // the value of u for Dirichlet, of u_x for Neumann conditions, over time
+                std::function<double(double)> value;
+
+                static Boundary dirichlet(double value);
+                static Boundary dirichlet(std::function<double(double)> value);
+                static Boundary neumann(double slope);
+                static Boundary neumann(std::function<double(double)> slope);
+            };
+
+            // Second difference (u[-1] - 2u[0] + u[1])/dx^2 times the diffusivity, for the heat equation
+            static stencil diffusion(double diffusivity);
+
+            MethodOfLines(stencil rhs, size_t radius, size_t points, double x_low, double x_high,
+                          Boundary low, Boundary high);
+
+            // The semi-discrete system du/dt for the values at the cell centres
+            void operator()(double t, const vec& u, vec& dudt) const;
+            sysfunc system() const;
+            /**
+             * System and Jacobian by forward differences, only the band is stored
+             *
+             * Columns 2*radius + 1 apart share no row and are perturbed together, so the Jacobian
+             * takes 2*radius + 1 evaluations of the system at any number of points.
+             * @param J - output, df_i/du_j at J[(radius + i - j) + j*(2*radius + 1)] for |i - j| <= radius,
+             *      see BandedLUSolver::Storage::band
+             */
+            void linearize(double t, const vec& u, vec& dudt, vec& J) const;
+            // Sparsity pattern of the band, for set_sparsity
+            Sparsity sparsity() const;
+            // Values of a function at the cell centres
+            vec discretize(const std::function<double(double)>& u) const;
+
+            size_t points() const;
+            size_t radius() const;
+            double x(size_t i) const;
+            double dx() const;
+
+        protected:
+            stencil rhs;
+            size_t r;
+            size_t m;
+            double x_low;
+            double h;
+            Boundary low;
+            Boundary high;
+            // Evaluate the system with `padded` as storage of the values and the ghost values
+            void evaluate(double t, const vec& u, vec& dudt, vec& padded) const;
+    };
+}
+
+#endif /*ORANGE_DRUM_EXPLORER_METHOD_OF_LINES_H*/
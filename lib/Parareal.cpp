@@ -0,0 +1,220 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+
+#include "Parareal.h"
+#include "Trace.h"
+
+namespace OrangeDrumExplorer{
+
+    namespace {
+        // Step over [low, high] that the solvers divide into exactly `steps` steps
+        double slice_step(double low, double high, size_t steps){
+            double dt = (high - low)/steps;
+            while (static_cast<size_t>((high - low)/dt) < steps){
+                dt = std::nextafter(dt, 0.);
+            }
+            return dt;
+        }
+    }
+
+    Parareal::Parareal(double low, double high, Propagator coarse_solver, Propagator fine_solver)
+        : Solver(low, high), coarse(coarse_solver), fine(fine_solver),
+          threads(std::max(1u, std::thread::hardware_concurrency()))
+    {
+        if (!coarse || !fine){
+            throw std::invalid_argument("Parareal needs a coarse and a fine solver");
+        }
+    }
+
+    void Parareal::set_slices(size_t n){
+        if (n == 0){
+            throw std::invalid_argument("At least one time slice is needed");
+        }
+        slices = n;
+    }
+
+    void Parareal::set_coarse_steps(size_t steps){
+        if (steps < 2){
+            throw std::invalid_argument("The coarse solver needs at least two steps per slice");
+        }
+        coarse_steps = steps;
+    }
+
+    void Parareal::set_tolerance(double new_tolerance){
+        if (new_tolerance < 0.){
+            throw std::invalid_argument("The tolerance must not be negative");
+        }
+        tolerance = new_tolerance;
+    }
+
+    void Parareal::set_max_iterations(size_t iterations){
+        max_iterations = iterations;
+    }
+
+    void Parareal::set_threads(size_t n){
+        if (n == 0){
+            throw std::invalid_argument("At least one thread is needed");
+        }
+        threads = n;
+    }
+
+    Parareal::Statistics Parareal::get_statistics(){
+        return statistics;
+    }
+
+    vec& Parareal::solve(func dnf_dtn, const vec& y0){
+        const sysfunc dydt = companion(dnf_dtn);
+        integrate([&](Solver& solver, const vec& y) -> vec& { return solver.solve(dydt, y); }, y0);
+        store_scalar();
+        return result;
+    }
+
+    vec& Parareal::solve(adfunc dnf_dtn, const vec& y0){
+        const adsysfunc dydt = companion(dnf_dtn);
+        integrate([&](Solver& solver, const vec& y) -> vec& { return solver.solve(dydt, y); }, y0);
+        store_scalar();
+        return result;
+    }
+
+    vec& Parareal::solve(sysfunc dydt, const vec& y0){
+        integrate([&](Solver& solver, const vec& y) -> vec& { return solver.solve(dydt, y); }, y0);
+        return result;
+    }
+
+    vec& Parareal::solve(adsysfunc dydt, const vec& y0){
+        integrate([&](Solver& solver, const vec& y) -> vec& { return solver.solve(dydt, y); }, y0);
+        return result;
+    }
+
+    void Parareal::store_scalar(){
+        const size_t n = state_size;
+        for (size_t i = 0; i < result.size()/n; ++i){
+            result[i] = result[i*n];
+        }
+        result.resize(result.size()/n);
+        state_size = 1;
+    }
+
+    void Parareal::integrate(const solve_from& propagate, const vec& y0){
+        const double a = limit_low;
+        const double dt = time_step;
+        const size_t N = (limit_high - a)/dt;
+        const size_t n = y0.size();
+        const size_t K = slices;
+        // slice k holds the steps first[k] ... first[k+1]-1
+        std::vector<size_t> first(K + 1);
+        for (size_t k = 0; k <= K; ++k){
+            first[k] = N*k/K;
+            if (k > 0 && first[k] - first[k-1] < 2){
+                throw std::invalid_argument("Every time slice needs at least two steps");
+            }
+        }
+        auto slice_low = [&](size_t k){ return a + first[k]*dt; };
+
+        statistics = Statistics();
+        state_size = n;
+        result.resize((N+1)*n);
+        std::copy(y0.begin(), y0.end(), result.begin());
+
+        // Solve slice k with `solver` from y in `steps` steps, returning the solution
+        auto run = [&](Solver& solver, size_t k, size_t steps, const vec& y) -> const vec& {
+            const double low = slice_low(k);
+            const double high = slice_low(k+1);
+            solver.set_limits(low, high);
+            solver.set_time_step(slice_step(low, high, steps));
+            const vec& solution = propagate(solver, y);
+            if (solver.get_state_size() != n || solution.size() != (steps+1)*n){
+                throw std::invalid_argument("The propagators must solve systems on the grid of their time step");
+            }
+            return solution;
+        };
+
+        std::unique_ptr<Solver> G = coarse();
+        const size_t workers = std::min(threads, K);
+        std::vector<std::unique_ptr<Solver>> F(workers);
+        for (auto& solver : F){
+            solver = fine();
+        }
+
+        // start states U, and the coarse and fine end states of every slice from the last U
+        std::vector<vec> U(K, vec(n)), coarse_end(K, vec(n)), fine_end(K, vec(n));
+        U[0] = y0;
+        auto coarse_solve = [&](size_t k){
+            ODE_TRACE_SCOPE("coarse");
+            const vec& solution = run(*G, k, coarse_steps, U[k]);
+            std::copy(solution.end() - n, solution.end(), coarse_end[k].begin());
+            ++statistics.coarse_solves;
+        };
+        auto fine_solve = [&](Solver& solver, size_t k){
+            ODE_TRACE_SCOPE("fine");
+            const size_t steps = first[k+1] - first[k];
+            const vec& solution = run(solver, k, steps, U[k]);
+            std::copy(solution.begin() + n, solution.end(), result.begin() + (first[k]+1)*n);
+            std::copy(solution.end() - n, solution.end(), fine_end[k].begin());
+        };
+
+        for (size_t k = 0; k + 1 < K; ++k){
+            coarse_solve(k);
+            U[k+1] = coarse_end[k];
+        }
+
+        const size_t iterations = max_iterations == 0 ? K : std::min(max_iterations, K);
+        vec previous(n);
+        for (size_t j = 1; j <= iterations; ++j){
+            // the slices before j-1 started from exact states in the previous iterations already
+            const size_t begin = j - 1;
+            std::atomic<size_t> next(begin);
+            std::vector<std::exception_ptr> errors(workers);
+            auto work = [&](size_t w){
+                try{
+                    for (size_t k = next++; k < K; k = next++){
+                        fine_solve(*F[w], k);
+                    }
+                }
+                catch (...){
+                    errors[w] = std::current_exception();
+                }
+            };
+            std::vector<std::thread> pool;
+            for (size_t w = 1; w < std::min(workers, K - begin); ++w){
+                pool.emplace_back(work, w);
+            }
+            work(0);
+            for (auto& thread : pool){
+                thread.join();
+            }
+            for (const auto& error : errors){
+                if (error){
+                    std::rethrow_exception(error);
+                }
+            }
+            statistics.fine_solves += K - begin;
+            statistics.iterations = j;
+
+            // sequential coarse sweep; U[begin] is unchanged, so is its coarse end state
+            double correction = 0.;
+            for (size_t k = begin; k + 1 < K; ++k){
+                vec old_coarse = coarse_end[k];
+                if (k > begin){
+                    coarse_solve(k);
+                }
+                previous = U[k+1];
+                for (size_t i = 0; i < n; ++i){
+                    U[k+1][i] = coarse_end[k][i] + fine_end[k][i] - old_coarse[i];
+                    correction = std::max(correction, std::abs(U[k+1][i] - previous[i])/(1. + std::abs(U[k+1][i])));
+                }
+            }
+            statistics.corrections.push_back(correction);
+            // the last iteration solved every slice from its exact start
+            if (correction <= tolerance || j == K){
+                statistics.converged = true;
+                break;
+            }
+        }
+        has_been_solved = true;
+    }
+}
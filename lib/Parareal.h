@@ -0,0 +1,81 @@
+#ifndef ORANGE_DRUM_EXPLORER_PARAREAL_H
+#define ORANGE_DRUM_EXPLORER_PARAREAL_H
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "Solver.h"
+
+namespace OrangeDrumExplorer
+{
+    /**
+     * Parareal, parallel in time over two solvers (Lions, Maday and Turinici 2001).\n
+     *
+     * The domain is split into time slices. A cheap coarse solver G carries the state across all
+     * slices in order, and the accurate fine solver F integrates every slice from its start state,
+     * the slices in parallel on a pool of threads. Every iteration corrects the start states by
+     *   U_{k+1} = G(U_k) + F(U_k^old) - G(U_k^old)
+     * in one sequential coarse sweep. After iteration j the first j+1 start states are those of the
+     * sequential fine solve, so the solve is exact after as many iterations as slices; it stops once no
+     * start state changes by more than the tolerance relative to 1 + |y|. The speedup over the fine
+     * solver on as many cores as slices is about 1/((j + 1)*G/F + j/slices) after j iterations, with
+     * G/F the cost of the coarse against the fine sweep over the domain.
+     *
+     * The solution is the fine solution on the grid of time_step, stored from the fine solves of the
+     * last iteration. Slice k takes the steps from N*k/slices to N*(k+1)/slices, so every slice needs
+     * at least two steps. The propagators are created by factories, one fine solver per thread, and
+     * their domain and time step are set for every slice; they have to solve systems on the grid of
+     * their time step. With more than one thread the function is called from several threads at once.
+     * Scalar equations are solved as their companion system.
+     */
+    class Parareal : public Solver {
+        public:
+            // Creates a solver, which is configured apart from its domain and time step
+            typedef std::function<std::unique_ptr<Solver>()> Propagator;
+            // Work of the last solve
+            struct Statistics {
+                size_t iterations = 0;
+                size_t coarse_solves = 0;
+                size_t fine_solves = 0;
+                // largest relative change of a start state in every iteration
+                vec corrections;
+                bool converged = false;
+            };
+
+            // 8 slices with 2 coarse steps each, a tolerance of 1e-8 and all hardware threads
+            Parareal(double limit_low, double limit_high, Propagator coarse, Propagator fine);
+            void set_slices(size_t);
+            // Steps of the coarse solver per slice, at least 2
+            void set_coarse_steps(size_t);
+            void set_tolerance(double);
+            // Limit of the iterations, capped at the number of slices; 0 for no other limit
+            void set_max_iterations(size_t);
+            // Number of threads of the fine solves
+            void set_threads(size_t);
+            Statistics get_statistics();
+
+            vec& solve(func dnf_dtn, const vec& y0) override;
+            vec& solve(adfunc dnf_dtn, const vec& y0) override;
+            vec& solve(sysfunc dydt, const vec& y0) override;
+            vec& solve(adsysfunc dydt, const vec& y0) override;
+
+        protected:
+            Propagator coarse;
+            Propagator fine;
+            size_t slices = 8;
+            size_t coarse_steps = 2;
+            double tolerance = 1e-8;
+            size_t max_iterations = 0;
+            size_t threads;
+            Statistics statistics;
+            // Solves the function with the given solver from the given state
+            typedef std::function<vec&(Solver&, const vec&)> solve_from;
+            void integrate(const solve_from& propagate, const vec& y0);
+            // Keep the first component of every stored state only
+            void store_scalar();
+    };
+}
+
+#endif /*ORANGE_DRUM_EXPLORER_PARAREAL_H*/
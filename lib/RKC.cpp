@@ -0,0 +1,125 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "RKC.h"
+#include "FiniteDifference.h"
+#include "Krylov.h"
+#include "Trace.h"
+
+namespace OrangeDrumExplorer{
+
+    void RKC::set_spectral_radius(spectral_radius_bound bound){
+        radius_bound = bound;
+    }
+
+    void RKC::set_estimate_interval(size_t steps){
+        if (steps == 0){
+            throw std::invalid_argument("The spectral radius needs to be estimated at least once");
+        }
+        estimate_interval = steps;
+    }
+
+    RKC::Statistics RKC::get_statistics(){
+        return statistics;
+    }
+
+    size_t RKC::stages(double dt, double rho){
+        // the stability interval of s stages with the damping 2/13 is about 0.653*s^2
+        return std::max<size_t>(2, 1 + static_cast<size_t>(std::sqrt(1. + 1.54*dt*rho)));
+    }
+
+    vec RKC::solve(sysfunc dydt, const vec& y0, const sink& output){
+        const double a = limit_low;
+        const double dt = time_step;
+        const size_t N = (limit_high - limit_low)/dt;
+        const size_t n = y0.size();
+        statistics = Statistics();
+        sysfunc f = [&dydt, this](double t, const vec& y, vec& dydt_out){
+            ++statistics.evaluations;
+            dydt(t, y, dydt_out);
+        };
+        DirectionalDifference product(f, n);
+        linear_operator jacobian = [&product](const vec& v, vec& Jv){ product.apply(v, Jv); };
+
+        // state, derivative at the start of the step and at the last stage, the last three stages
+        vec y = y0;
+        vec f0(n), fj(n), y_jm2(n), y_jm1(n), y_j(n);
+        // warm start of the power iteration, random at first
+        vec eigenvector(n, 0.);
+        double rho = 0.;
+        output(a, y);
+        for (size_t i = 0; i < N; ++i){
+            ODE_TRACE_SCOPE("step");
+            const double t = a + i*dt;
+            if (radius_bound){
+                // a known bound is cheap and follows the solution in every step
+                f(t, y, f0);
+                rho = radius_bound(t, y);
+            }
+            else if (i % estimate_interval == 0){
+                product.linearize(t, y, f0);
+                rho = 1.2*spectral_radius(jacobian, eigenvector);
+                ++statistics.estimates;
+            }
+            else{
+                f(t, y, f0);
+            }
+            const size_t s = stages(dt, rho);
+            statistics.max_stages = std::max(statistics.max_stages, s);
+
+            // damped Chebyshev polynomial T_s(w0 + w1*z) with its derivatives by the recursion
+            const double w0 = 1. + 2./(13.*s*s);
+            const double temp1 = w0*w0 - 1.;
+            const double temp2 = std::sqrt(temp1);
+            const double arg = s*std::log(w0 + temp2);
+            const double w1 = std::sinh(arg)*temp1/(std::cosh(arg)*s*temp2 - w0*std::sinh(arg));
+            double b_jm1 = 1./(4.*w0*w0);
+            double b_jm2 = b_jm1;
+            double z_jm1 = w0, z_jm2 = 1.;
+            double dz_jm1 = 1., dz_jm2 = 0.;
+            double d2z_jm1 = 0., d2z_jm2 = 0.;
+
+            // first stage
+            double mus = w1*b_jm1;
+            for (size_t k = 0; k < n; ++k){
+                y_jm2[k] = y[k];
+                y_jm1[k] = y[k] + dt*mus*f0[k];
+            }
+            double th_jm2 = 0.;
+            double th_jm1 = mus;
+            for (size_t j = 2; j <= s; ++j){
+                const double z_j = 2.*w0*z_jm1 - z_jm2;
+                const double dz_j = 2.*w0*dz_jm1 - dz_jm2 + 2.*z_jm1;
+                const double d2z_j = 2.*w0*d2z_jm1 - d2z_jm2 + 4.*dz_jm1;
+                const double b_j = d2z_j/(dz_j*dz_j);
+                const double a_jm1 = 1. - z_jm1*b_jm1;
+                const double mu = 2.*w0*b_j/b_jm1;
+                const double nu = -b_j/b_jm2;
+                mus = mu*w1/w0;
+                f(t + dt*th_jm1, y_jm1, fj);
+                for (size_t k = 0; k < n; ++k){
+                    y_j[k] = mu*y_jm1[k] + nu*y_jm2[k] + (1. - mu - nu)*y[k] + dt*mus*(fj[k] - a_jm1*f0[k]);
+                }
+                const double th_j = mu*th_jm1 + nu*th_jm2 + mus*(1. - a_jm1);
+
+                y_jm2.swap(y_jm1);
+                y_jm1.swap(y_j);
+                th_jm2 = th_jm1;
+                th_jm1 = th_j;
+                b_jm2 = b_jm1;
+                b_jm1 = b_j;
+                z_jm2 = z_jm1;
+                z_jm1 = z_j;
+                dz_jm2 = dz_jm1;
+                dz_jm1 = dz_j;
+                d2z_jm2 = d2z_jm1;
+                d2z_jm1 = d2z_j;
+            }
+            y.swap(y_jm1);
+            output(a + (i+1)*dt, y);
+        }
+        return y;
+    }
+
+}
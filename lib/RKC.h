@@ -0,0 +1,66 @@
+#ifndef ORANGE_DRUM_EXPLORER_RKC_H
+#define ORANGE_DRUM_EXPLORER_RKC_H
+
+#include <cstddef>
+#include <functional>
+
+#include "Solver.h"
+
+namespace OrangeDrumExplorer
+{
+    /**
+     * Second order Runge-Kutta-Chebyshev method of Sommeijer, Shampine and Verwer (1997).\n
+     *
+     * An explicit method whose s stages follow the three-term recursion of the Chebyshev polynomials,
+     * so the real stability interval grows as 0.65*s^2. Every step takes the fewest stages with
+     * dt*rho <= 0.65*s^2 for the spectral radius rho of the Jacobian, which is estimated by power
+     * iteration on directional differences of the system. There is no Jacobian and no linear solve,
+     * the solver holds six vectors of the state size besides the estimate.
+     *
+     * For moderately stiff problems with eigenvalues close to the negative real axis, e.g. diffusion.
+     * Eigenvalues with large imaginary parts, oscillations or advection, aren't stabilized.
+     */
+    class RKC : public StreamingSolver {
+        public:
+            // Work of the last solve
+            struct Statistics {
+                size_t evaluations = 0;
+                // estimates of the spectral radius
+                size_t estimates = 0;
+                // most stages in a step
+                size_t max_stages = 0;
+            };
+            // Upper bound of the spectral radius of the Jacobian at (t, y)
+            typedef std::function<double(double t, const vec& y)> spectral_radius_bound;
+
+            using StreamingSolver::StreamingSolver;
+            using StreamingSolver::solve;
+            /**
+             * Spectral radius of the Jacobian, if known, e.g. 4*D/dx^2 for the diffusion D on the grid dx
+             *
+             * @param bound - called at the start of every step; nullptr (default) for the power iteration
+             *      on directional differences, whose estimate is increased by 20%
+             */
+            void set_spectral_radius(spectral_radius_bound bound);
+            // Number of steps between the power iterations, 1 for every step; a bound is called in every step
+            void set_estimate_interval(size_t);
+            Statistics get_statistics();
+            /**
+             * Solve a system without storing the solution
+             *
+             * @param output - called with the initial state and after every step; the state is
+             *      only valid during the call
+             * @return the state at the last step
+             */
+            vec solve(sysfunc dydt, const vec& y0, const sink& output) override;
+            // Stages for the step dt at the spectral radius rho, at least 2
+            static size_t stages(double dt, double rho);
+
+        protected:
+            spectral_radius_bound radius_bound;
+            size_t estimate_interval = 25;
+            Statistics statistics;
+    };
+}
+
+#endif /*ORANGE_DRUM_EXPLORER_RKC_H*/
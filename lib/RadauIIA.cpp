@@ -0,0 +1,388 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <complex>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+
+#include "RadauIIA.h"
+#include "LinearSolver.h"
+#include "Trace.h"
+
+namespace OrangeDrumExplorer{
+
+    namespace {
+        const double sqrt6 = std::sqrt(6.);
+        // nodes, c3 = 1
+        const double c1 = (4. - sqrt6)/10.;
+        const double c2 = (4. + sqrt6)/10.;
+        const double c[3] = {c1, c2, 1.};
+        // T^-1 A^-1 T = [[gamma, 0, 0], [0, alpha, -beta], [0, beta, alpha]] for the Runge-Kutta matrix A
+        const double T[3][3] = {{9.1232394870892942792e-02, -0.14125529502095420843, -3.0029194105147424492e-02},
+                                {0.24171793270710701896, 0.20412935229379993199, 0.38294211275726193779},
+                                {0.96604818261509293619, 1., 0.}};
+        const double TI[3][3] = {{4.3255798900631553510, 0.33919925181580986954, 0.54177053993587487119},
+                                 {-4.1787185915519047273, -0.32768282076106238708, 0.47662355450055045196},
+                                 {-0.50287263494578687595, 2.5719269498556054292, -0.59603920482822492497}};
+        const double gamma = 30./(6. + std::cbrt(81.) - std::cbrt(9.));
+        const double alpha_beta_norm = std::pow((12. - std::cbrt(81.) + std::cbrt(9.))/60., 2)
+                                       + std::pow((std::cbrt(81.) + std::cbrt(9.))*std::sqrt(3.)/60., 2);
+        const double alpha = (12. - std::cbrt(81.) + std::cbrt(9.))/60./alpha_beta_norm;
+        const double beta = (std::cbrt(81.) + std::cbrt(9.))*std::sqrt(3.)/60./alpha_beta_norm;
+        // embedded error estimate from the stage increments
+        const double dd[3] = {-(13. + 7.*sqrt6)/3., (-13. + 7.*sqrt6)/3., -1./3.};
+        // simplified Newton iterations per step
+        const size_t newton_limit = 7;
+        // rate of the Newton iterations below which the Jacobian and the factorizations are kept
+        const double fast_contraction = 0.001;
+        // the iterations have converged at this fraction of the tolerances of the step control
+        const double newton_tolerance = 0.03;
+        const double eps = std::numeric_limits<double>::epsilon();
+    }
+
+    RadauIIA::RadauIIA()
+        : RadauIIA(0., 1.)
+    {}
+
+    RadauIIA::RadauIIA(double low, double high)
+        : EulerImplicit(low, high)
+    {
+        // the stages are solved to the accuracy of order 5
+        threshold = 1e-10;
+    }
+
+    void RadauIIA::set_tolerances(double relative, double absolute){
+        if (relative < 0. || absolute < 0. || (absolute == 0. && relative != 0.)){
+            throw std::invalid_argument("The absolute tolerance has to be positive, or both 0 for fixed steps");
+        }
+        relative_tolerance = relative;
+        absolute_tolerance = absolute;
+    }
+
+    void RadauIIA::set_parallel_size(size_t n){
+        parallel_size = n;
+    }
+
+    RadauIIA::Statistics RadauIIA::get_statistics(){
+        return statistics;
+    }
+
+    void RadauIIA::integrate(const linearization& f, const vec& y0, size_t stored, const Sparsity& pattern,
+                             LinearSolver& real, size_t jacobian_size){
+        const size_t n = y0.size();
+        if (jacobian_size != jacobian_values(pattern, n)){
+            throw std::invalid_argument("RadauIIA needs the n*n or compressed Jacobian, the banded one isn't supported");
+        }
+        const double a = limit_low;
+        const double dt = time_step;
+        const size_t N = (limit_high - limit_low)/dt;
+        const double end = a + N*dt;
+        const bool adaptive = absolute_tolerance > 0.;
+        const bool parallel = n >= parallel_size;
+        statistics = Statistics();
+        state_size = stored;
+        result.resize((N+1)*stored);
+        std::copy(y0.begin(), y0.begin() + stored, result.begin());
+        // grid points stored so far
+        size_t written = 1;
+
+        ComplexShiftSolver complex;
+        vec J(jacobian_size), none;
+        vec y = y0, f0(n), fx(n), stage(n), scale(n, 1.), error_scale(n), e(n), err(n);
+        // stage increments Y_i - y, transformed T^-1 z, their corrections, the right-hand sides,
+        // the stage derivatives and the divided differences of the collocation polynomial
+        std::array<vec, 3> z, w, dw, rhs, F, cont;
+        for (size_t i = 0; i < 3; ++i){
+            z[i].assign(n, 0.);
+            w[i].assign(n, 0.);
+            dw[i].assign(n, 0.);
+            rhs[i].assign(n, 0.);
+            F[i].assign(n, 0.);
+            cont[i].assign(n, 0.);
+        }
+        double t = a;
+        double h = dt;
+        // step of the factorizations and of the last accepted step
+        double h_factorized = 0.;
+        double h_old = dt;
+        double theta = fast_contraction;
+        double faccon = 1.;
+        size_t iterations = 0;
+
+        auto evaluate = [&](double ti, const vec& x, vec& fxi){
+            ++statistics.evaluations;
+            f(ti, x, fxi, none);
+        };
+        // both systems at the current step h, each on its own thread for large systems
+        auto factorize = [&]() -> bool {
+            ODE_TRACE_SCOPE("factorize");
+            statistics.factorizations += 2;
+            h_factorized = h;
+            bool real_factorized = false, complex_factorized = false;
+            auto complex_part = [&](){
+                complex_factorized = complex.factorize(J, n, std::complex<double>(alpha/h, beta/h), pattern);
+            };
+            if (parallel){
+                std::thread worker(complex_part);
+                real_factorized = real.factorize(J, n, h/gamma, pattern);
+                worker.join();
+            }
+            else{
+                complex_part();
+                real_factorized = real.factorize(J, n, h/gamma, pattern);
+            }
+            return real_factorized && complex_factorized;
+        };
+        // dw[0] from the real system, dw[1] + i*dw[2] from the complex one
+        auto solve = [&]() -> bool {
+            bool real_solved = false, complex_solved = false;
+            auto complex_part = [&](){ complex_solved = complex.solve(rhs[1], rhs[2], dw[1], dw[2]); };
+            if (parallel){
+                std::thread worker(complex_part);
+                real_solved = real.solve(rhs[0], dw[0]);
+                worker.join();
+            }
+            else{
+                complex_part();
+                real_solved = real.solve(rhs[0], dw[0]);
+            }
+            // (gamma/h)*I - J = -(gamma/h)*((h/gamma)*J - I)
+            for (size_t j = 0; j < n; ++j){
+                dw[0][j] *= -h/gamma;
+            }
+            return real_solved && complex_solved;
+        };
+        // stage increments by simplified Newton iterations, false if they don't converge;
+        // `full` takes the Jacobian in every iteration up to max_iterations as NewtonSolve, keeping the last iterate
+        auto newton = [&](bool full) -> bool {
+            ODE_TRACE_SCOPE("newton");
+            // starting values from the collocation polynomial of the last step; without an error estimate
+            // fixed steps don't extrapolate the first step, whose initial layer can lead to a spurious root
+            const double ratio = h/h_old;
+            for (size_t j = 0; j < n; ++j){
+                for (size_t i = 0; i < 3; ++i){
+                    const double s = c[i]*ratio;
+                    z[i][j] = statistics.steps < (adaptive ? 1 : 2) ? 0. :
+                              s*(cont[0][j] + (s - (c2 - 1.))*(cont[1][j] + (s - (c1 - 1.))*cont[2][j]));
+                }
+                for (size_t i = 0; i < 3; ++i){
+                    w[i][j] = TI[i][0]*z[0][j] + TI[i][1]*z[1][j] + TI[i][2]*z[2][j];
+                }
+            }
+            faccon = std::pow(std::max(faccon, eps), 0.8);
+            const double tolerance = adaptive ? newton_tolerance : threshold;
+            double dyno_old = 0., thq_old = 0.;
+            for (iterations = 1; iterations <= (full ? max_iterations : newton_limit); ++iterations){
+                ++statistics.newton_iterations;
+                if (full && iterations > 1){
+                    for (size_t j = 0; j < n; ++j){
+                        stage[j] = y[j] + z[2][j];
+                    }
+                    ++statistics.evaluations;
+                    ++statistics.jacobians;
+                    f(t + h, stage, fx, J);
+                    if (!factorize()){
+                        return false;
+                    }
+                }
+                for (size_t i = 0; i < 3; ++i){
+                    for (size_t j = 0; j < n; ++j){
+                        stage[j] = y[j] + z[i][j];
+                    }
+                    evaluate(t + c[i]*h, stage, F[i]);
+                }
+                for (size_t j = 0; j < n; ++j){
+                    const double tf0 = TI[0][0]*F[0][j] + TI[0][1]*F[1][j] + TI[0][2]*F[2][j];
+                    const double tf1 = TI[1][0]*F[0][j] + TI[1][1]*F[1][j] + TI[1][2]*F[2][j];
+                    const double tf2 = TI[2][0]*F[0][j] + TI[2][1]*F[1][j] + TI[2][2]*F[2][j];
+                    rhs[0][j] = tf0 - gamma/h*w[0][j];
+                    rhs[1][j] = tf1 - alpha/h*w[1][j] + beta/h*w[2][j];
+                    rhs[2][j] = tf2 - alpha/h*w[2][j] - beta/h*w[1][j];
+                }
+                if (!solve()){
+                    return false;
+                }
+                double dyno = 0.;
+                for (size_t i = 0; i < 3; ++i){
+                    for (size_t j = 0; j < n; ++j){
+                        const double scaled = dw[i][j]/scale[j];
+                        dyno += scaled*scaled;
+                    }
+                }
+                dyno = std::sqrt(dyno/(3*n));
+                if (std::isnan(dyno)){
+                    return false;
+                }
+                bool contracting = true;
+                if (iterations > 1){
+                    const double thq = dyno/dyno_old;
+                    theta = iterations == 2 ? thq : std::sqrt(thq*thq_old);
+                    thq_old = thq;
+                    contracting = theta < 0.99;
+                    if (!contracting && !full){
+                        return false;
+                    }
+                    faccon = contracting ? theta/(1. - theta) : faccon;
+                }
+                dyno_old = std::max(dyno, eps);
+                for (size_t j = 0; j < n; ++j){
+                    for (size_t i = 0; i < 3; ++i){
+                        w[i][j] += dw[i][j];
+                    }
+                    for (size_t i = 0; i < 3; ++i){
+                        z[i][j] = T[i][0]*w[0][j] + T[i][1]*w[1][j] + T[i][2]*w[2][j];
+                    }
+                }
+                // fixed steps have no error estimate to catch an optimistic rate, they take the correction as NewtonSolve
+                if (contracting && (adaptive ? faccon*dyno : dyno) <= tolerance){
+                    return true;
+                }
+            }
+            return full;
+        };
+        // root mean square of the embedded error, evaluated again from the error if `careful`
+        auto estimate = [&](bool careful) -> double {
+            for (size_t j = 0; j < n; ++j){
+                error_scale[j] = absolute_tolerance + relative_tolerance*std::max(std::abs(y[j]), std::abs(y[j] + z[2][j]));
+            }
+            auto norm = [&](){
+                for (size_t j = 0; j < n; ++j){
+                    e[j] += (dd[0]*z[0][j] + dd[1]*z[1][j] + dd[2]*z[2][j])/h;
+                }
+                if (!real.solve(e, err)){
+                    return std::numeric_limits<double>::infinity();
+                }
+                double sum = 0.;
+                for (size_t j = 0; j < n; ++j){
+                    err[j] *= -h/gamma;
+                    sum += err[j]*err[j]/(error_scale[j]*error_scale[j]);
+                }
+                return std::max(std::sqrt(sum/n), 1e-10);
+            };
+            e = f0;
+            double error = norm();
+            if (error >= 1. && careful){
+                // the stiff components of the first estimate can be far too large
+                for (size_t j = 0; j < n; ++j){
+                    stage[j] = y[j] + err[j];
+                }
+                evaluate(t, stage, e);
+                error = norm();
+            }
+            return error;
+        };
+
+        bool need_jacobian = true;
+        bool rejected = false;
+        // proposed step size, cut to end on the next grid point
+        double proposal = dt;
+        while (written <= N){
+            ODE_TRACE_SCOPE("step");
+            const double grid = written == N ? end : a + written*dt;
+            const bool cut = adaptive && proposal >= (grid - t)*(1. - 1e-12);
+            h = !adaptive ? dt : (cut ? grid - t : proposal);
+            if (cut && std::abs(h - h_factorized) <= 1e-12*h){
+                // steps of whole grid intervals keep the factorizations despite rounding
+                h = h_factorized;
+            }
+            bool fresh = false;
+            if (need_jacobian){
+                ++statistics.evaluations;
+                ++statistics.jacobians;
+                f(t, y, f0, J);
+                need_jacobian = false;
+                fresh = true;
+            }
+            else if (adaptive){
+                evaluate(t, y, f0);
+            }
+            if ((fresh || h != h_factorized) && !factorize()){
+                std::fill(result.begin() + written*stored, result.end(), std::nan(""));
+                break;
+            }
+            for (size_t j = 0; j < n; ++j){
+                scale[j] = adaptive ? absolute_tolerance + relative_tolerance*std::abs(y[j]) : 1.;
+            }
+            bool converged = newton(false);
+            if (!converged && !fresh && !adaptive){
+                // the Jacobian of an earlier step is too far off
+                need_jacobian = true;
+                continue;
+            }
+            if (!converged && adaptive){
+                ++statistics.rejected;
+                proposal = 0.5*h;
+                rejected = true;
+                need_jacobian = !fresh;
+                if (proposal < 1e-14*std::max(1., std::abs(t))){
+                    std::fill(result.begin() + written*stored, result.end(), std::nan(""));
+                    break;
+                }
+                continue;
+            }
+            if (!converged && !newton(true)){
+                // fixed steps can't shrink, the full Newton iterations failed
+                std::fill(result.begin() + written*stored, result.end(), std::nan(""));
+                break;
+            }
+
+            double h_new = h;
+            if (adaptive){
+                const double error = estimate(statistics.steps == 0 || rejected);
+                const double safety = std::min(0.9, 0.9*(1. + 2.*newton_limit)/(iterations + 2.*newton_limit));
+                const double quotient = std::max(1./8., std::min(5., std::pow(error, 0.25)/safety));
+                h_new = h/quotient;
+                if (error >= 1.){
+                    ++statistics.rejected;
+                    proposal = statistics.steps == 0 ? 0.1*h : h_new;
+                    rejected = true;
+                    need_jacobian = !fresh;
+                    if (proposal < 1e-14*std::max(1., std::abs(t))){
+                        std::fill(result.begin() + written*stored, result.end(), std::nan(""));
+                        break;
+                    }
+                    continue;
+                }
+            }
+
+            ++statistics.steps;
+            // divided differences of the collocation polynomial through y and the stages, for the starting values
+            for (size_t j = 0; j < n; ++j){
+                const double ak = (z[0][j] - z[1][j])/(c1 - c2);
+                cont[0][j] = (z[1][j] - z[2][j])/(c2 - 1.);
+                cont[1][j] = (ak - cont[0][j])/(c1 - 1.);
+                cont[2][j] = cont[1][j] - (ak - z[0][j]/c1)/c2;
+                y[j] += z[2][j];
+            }
+            h_old = h;
+            if (!adaptive || cut){
+                t = grid;
+                std::copy(y.begin(), y.begin() + stored, result.begin() + (written++)*stored);
+            }
+            else{
+                t += h;
+            }
+            need_jacobian = theta > fast_contraction;
+            if (adaptive){
+                if (rejected){
+                    h_new = std::min(h_new, h);
+                }
+                rejected = false;
+                // a small increase isn't worth the factorizations
+                const double increase = h_new/h;
+                if (!need_jacobian && increase >= 1. && increase <= 1.2){
+                    h_new = h;
+                }
+                // a step cut short by the grid doesn't shrink the next one
+                proposal = cut ? std::max(proposal, h_new) : h_new;
+            }
+        }
+        has_been_solved = true;
+    }
+
+    void RadauIIA::integrate(JacobianProduct&, const vec&, size_t){
+        throw std::invalid_argument("RadauIIA factorizes the Newton matrices, Newton-Krylov isn't supported");
+    }
+
+}
@@ -0,0 +1,67 @@
+#ifndef ORANGE_DRUM_EXPLORER_RADAU_IIA_H
+#define ORANGE_DRUM_EXPLORER_RADAU_IIA_H
+
+#include <cstddef>
+
+#include "Solver.h"
+
+namespace OrangeDrumExplorer
+{
+    /**
+     * Three-stage Radau IIA method of order 5, after RADAU5 of Hairer and Wanner (1996).\n
+     *
+     * Fully implicit and stiffly accurate: the 3n stage equations are solved together by simplified
+     * Newton iterations. The inverse of the Runge-Kutta matrix has one real eigenvalue and a complex
+     * pair, so the transformed Newton matrix splits into the real system (gamma/dt)*I - J and the
+     * complex system ((alpha + i*beta)/dt)*I - J of size n each, instead of one of size 3n. Both are
+     * factorized and solved concurrently on two threads from set_parallel_size on. The real system is
+     * factorized by the LinearSolver of set_linear_solver, the complex one by ComplexShiftSolver.
+     *
+     * The Jacobian and both factorizations are kept while the Newton iterations contract quickly
+     * (rate below 0.001); the factorizations also survive a step size change of 1 to 1.2, which is
+     * then not taken. The Jacobian comes from the solve overloads of EulerImplicit, except for the
+     * banded one of the method of lines: solve pde.system() with set_sparsity(pde.sparsity()) instead.
+     *
+     * With set_tolerances the step size follows the error estimate of RADAU5; the steps are cut to
+     * end on every point of the grid of time_step, as the collocation polynomial of a step is only
+     * accurate to the stage order 3. Otherwise steps of time_step are taken.
+     */
+    class RadauIIA : public EulerImplicit {
+        public:
+            // Work of the last solve
+            struct Statistics {
+                size_t steps = 0;
+                size_t rejected = 0;
+                size_t evaluations = 0;
+                size_t jacobians = 0;
+                // of the real and the complex system together
+                size_t factorizations = 0;
+                size_t newton_iterations = 0;
+            };
+
+            RadauIIA();
+            // The Newton iterations converge at a threshold of 1e-10
+            RadauIIA(double limit_low, double limit_high);
+            /**
+             * Control the step size by the error estimate
+             *
+             * The root mean square over the components of err_i/(absolute + relative*|y_i|) is kept below 1.
+             * @param relative, absolute - 0, 0 (default) for fixed steps of time_step
+             */
+            void set_tolerances(double relative, double absolute);
+            // Smallest system whose real and complex systems are factorized and solved on two threads
+            void set_parallel_size(size_t n);
+            Statistics get_statistics();
+
+        protected:
+            double relative_tolerance = 0.;
+            double absolute_tolerance = 0.;
+            size_t parallel_size = 128;
+            Statistics statistics;
+            void integrate(const linearization& f, const vec& y0, size_t stored, const Sparsity& pattern,
+                           LinearSolver& solver, size_t jacobian_size) override;
+            void integrate(JacobianProduct& f, const vec& y0, size_t stored) override;
+    };
+}
+
+#endif /*ORANGE_DRUM_EXPLORER_RADAU_IIA_H*/
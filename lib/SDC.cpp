@@ -0,0 +1,280 @@
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "SDC.h"
+#include "LinearSolver.h"
+#include "Trace.h"
+
+namespace OrangeDrumExplorer{
+
+    namespace {
+        // Q[m][j] = integral of the Lagrange polynomial of node j from 0 to tau_m
+        std::vector<vec> integration_matrix(const vec& tau){
+            const size_t M = tau.size();
+            std::vector<vec> Q(M, vec(M, 0.));
+            for (size_t j = 0; j < M; ++j){
+                // monomial coefficients of the Lagrange polynomial, lowest degree first
+                vec c = {1.};
+                for (size_t i = 0; i < M; ++i){
+                    if (i == j){
+                        continue;
+                    }
+                    const double scale = 1./(tau[j] - tau[i]);
+                    vec product(c.size() + 1, 0.);
+                    for (size_t k = 0; k < c.size(); ++k){
+                        product[k+1] += c[k]*scale;
+                        product[k] -= c[k]*tau[i]*scale;
+                    }
+                    c.swap(product);
+                }
+                for (size_t m = 0; m < M; ++m){
+                    double power = tau[m];
+                    for (size_t k = 0; k < c.size(); ++k){
+                        Q[m][j] += c[k]*power/(k + 1);
+                        power *= tau[m];
+                    }
+                }
+            }
+            return Q;
+        }
+    }
+
+    vec SDC::lobatto_nodes(size_t M){
+        if (M < 2){
+            throw std::invalid_argument("At least two Gauss-Lobatto nodes are needed");
+        }
+        const size_t N = M - 1;
+        vec tau(M);
+        tau[0] = 0.;
+        tau[N] = 1.;
+        for (size_t i = 1; i < N; ++i){
+            // Newton iterations on the roots of (1 - x^2)*P_N'(x) from the Chebyshev-Gauss-Lobatto points
+            double x = std::cos(M_PI*i/N);
+            for (size_t iter = 0; iter < 100; ++iter){
+                double previous = 1., legendre = x;
+                for (size_t k = 2; k <= N; ++k){
+                    const double next = ((2.*k - 1.)*x*legendre - (k - 1.)*previous)/k;
+                    previous = legendre;
+                    legendre = next;
+                }
+                const double delta = (x*legendre - previous)/((N + 1)*legendre);
+                x -= delta;
+                if (std::abs(delta) < 1e-15){
+                    break;
+                }
+            }
+            tau[i] = (1. - x)/2.;
+        }
+        return tau;
+    }
+
+    SDC::SDC()
+        : SDC(0., 1.)
+    {}
+
+    SDC::SDC(double low, double high, size_t new_nodes, size_t new_sweeps, Sweeper new_sweeper)
+        : EulerImplicit(low, high), sweeper(new_sweeper)
+    {
+        // the nodes are solved to the accuracy of the higher orders
+        threshold = 1e-10;
+        set_nodes(new_nodes);
+        set_sweeps(new_sweeps);
+    }
+
+    void SDC::set_nodes(size_t n){
+        if (n < 2){
+            throw std::invalid_argument("At least two Gauss-Lobatto nodes are needed");
+        }
+        nodes = n;
+    }
+
+    void SDC::set_sweeps(size_t n){
+        if (n == 0){
+            throw std::invalid_argument("At least one sweep is needed");
+        }
+        sweeps = n;
+    }
+
+    void SDC::set_sweeper(Sweeper new_sweeper){
+        sweeper = new_sweeper;
+    }
+
+    void SDC::set_parallel_sweeps(size_t threads){
+        parallel_threads = threads;
+    }
+
+    SDC::Statistics SDC::get_statistics(){
+        return statistics;
+    }
+
+    vec& SDC::solve_concurrent(const std::function<void()>& solve){
+        concurrent = true;
+        try{
+            solve();
+        }
+        catch (...){
+            concurrent = false;
+            throw;
+        }
+        concurrent = false;
+        return result;
+    }
+
+    vec& SDC::solve(func dnf_dtn, const vec& y0){
+        return solve_concurrent([&]{ EulerImplicit::solve(dnf_dtn, y0); });
+    }
+
+    vec& SDC::solve(sysfunc dydt, const vec& y0){
+        return solve_concurrent([&]{ EulerImplicit::solve(dydt, y0); });
+    }
+
+    vec& SDC::solve(sysfunc dydt, jacfunc jacobian, const vec& y0){
+        return solve_concurrent([&]{ EulerImplicit::solve(dydt, jacobian, y0); });
+    }
+
+    void SDC::integrate(const linearization& f, const vec& y0, size_t stored, const Sparsity& pattern,
+                        LinearSolver& solver, size_t jacobian_size){
+        const size_t n = y0.size();
+        const size_t M = nodes;
+        const bool parallel = parallel_threads > 0;
+        const bool implicit = sweeper == Sweeper::implicit_euler;
+        const size_t workers = parallel ? std::min(parallel_threads, M - 1) : 1;
+        if (workers > 1 && !concurrent){
+            throw std::invalid_argument("Concurrent sweeps need solve(func), solve(sysfunc) or solve(sysfunc, jacfunc)");
+        }
+        if (workers > 1 && implicit && jacobian_size != jacobian_values(pattern, n)){
+            throw std::invalid_argument("Concurrent sweeps don't support the banded Jacobian of the method of lines");
+        }
+        const vec tau = lobatto_nodes(M);
+        const std::vector<vec> Q = integration_matrix(tau);
+        statistics = Statistics();
+
+        // values and derivatives at the nodes of the current sweep, the derivatives of the previous one
+        std::vector<vec> U(M, vec(n)), F(M, vec(n)), F_old(M, vec(n)), x0(M, vec(n));
+        vec none;
+        // Jacobian storage and factorization of every worker; the concurrent ones factorize on their own
+        std::vector<vec> J(workers, vec(implicit ? jacobian_size : 0));
+        std::vector<std::unique_ptr<LinearSolver>> factorizations(workers);
+        if (workers > 1){
+            for (auto& factorization : factorizations){
+                factorization = std::make_unique<AutomaticSolver>();
+            }
+        }
+        double t = 0.;
+        double h = time_step;
+
+        // Euler step into node m from x0[m], of length dtau at the node
+        auto update = [&](size_t m, double dtau, size_t w){
+            const double tm = t + tau[m]*h;
+            if (implicit){
+                ODE_TRACE_SCOPE("node");
+                U[m] = NewtonSolve(f, tm, x0[m], dtau, pattern, J[w], workers > 1 ? *factorizations[w] : solver);
+                for (size_t j = 0; j < n; ++j){
+                    F[m][j] = (U[m][j] - x0[m][j])/dtau;
+                }
+            }
+            else{
+                U[m] = x0[m];
+                f(tm, U[m], F[m], none);
+            }
+        };
+        // Gauss-Seidel sweep from node to node, the first one without the previous sweep
+        auto sequential_sweep = [&](bool first){
+            for (size_t m = 1; m < M; ++m){
+                const double dtau = h*(tau[m] - tau[m-1]);
+                for (size_t j = 0; j < n; ++j){
+                    double integral = 0.;
+                    for (size_t l = 0; !first && l < M; ++l){
+                        integral += h*(Q[m][l] - Q[m-1][l])*F_old[l][j];
+                    }
+                    if (implicit){
+                        x0[m][j] = U[m-1][j] + integral - (first ? 0. : dtau*F_old[m][j]);
+                    }
+                    else{
+                        x0[m][j] = U[m-1][j] + dtau*(F[m-1][j] - (first ? 0. : F_old[m-1][j])) + integral;
+                    }
+                }
+                update(m, dtau, 0);
+            }
+        };
+        // Jacobi sweep, every node from the previous sweep only; worker w updates the nodes m = w + 1 (mod workers)
+        auto parallel_sweep = [&](){
+            auto nodes_of = [&](size_t w){
+                for (size_t m = w + 1; m < M; m += workers){
+                    const double dtau = implicit ? h*tau[m] : 0.;
+                    for (size_t j = 0; j < n; ++j){
+                        double integral = U[0][j];
+                        for (size_t l = 0; l < M; ++l){
+                            integral += h*Q[m][l]*F_old[l][j];
+                        }
+                        x0[m][j] = integral - dtau*F_old[m][j];
+                    }
+                    update(m, dtau, w);
+                }
+            };
+            if (workers == 1){
+                nodes_of(0);
+                return;
+            }
+            std::vector<std::exception_ptr> errors(workers);
+            auto guarded = [&](size_t w){
+                try{
+                    nodes_of(w);
+                }
+                catch (...){
+                    errors[w] = std::current_exception();
+                }
+            };
+            std::vector<std::thread> pool;
+            for (size_t w = 1; w < workers; ++w){
+                pool.emplace_back(guarded, w);
+            }
+            guarded(0);
+            for (auto& thread : pool){
+                thread.join();
+            }
+            for (const auto& error : errors){
+                if (error){
+                    std::rethrow_exception(error);
+                }
+            }
+        };
+
+        step_solver step = [&](double t_end, const vec& y) -> vec {
+            t = t_end - h;
+            ++statistics.steps;
+            U[0] = y;
+            f(t, y, F[0], none);
+            if (parallel){
+                // the Picard iterations start from y at every node
+                std::fill(U.begin() + 1, U.end(), y);
+                std::fill(F.begin() + 1, F.end(), F[0]);
+            }
+            for (size_t k = 0; k < sweeps; ++k){
+                ODE_TRACE_SCOPE("sweep");
+                if (k > 0 || parallel){
+                    F_old = F;
+                }
+                if (parallel){
+                    parallel_sweep();
+                }
+                else{
+                    sequential_sweep(k == 0);
+                }
+                ++statistics.sweeps;
+                statistics.node_updates += M - 1;
+            }
+            return U[M-1];
+        };
+        integrate_steps(step, y0, stored);
+    }
+
+    void SDC::integrate(JacobianProduct&, const vec&, size_t){
+        throw std::invalid_argument("SDC factorizes the Newton matrices, Newton-Krylov isn't supported");
+    }
+}
@@ -0,0 +1,84 @@
+#ifndef ORANGE_DRUM_EXPLORER_SDC_H
+#define ORANGE_DRUM_EXPLORER_SDC_H
+
+#include <cstddef>
+#include <functional>
+
+#include "Solver.h"
+
+namespace OrangeDrumExplorer
+{
+    /**
+     * Spectral deferred corrections (SDC) with Euler sweeps over Gauss-Lobatto nodes, after Dutt,
+     * Greengard and Rokhlin (2000).\n
+     *
+     * A step of dt is divided by the M Gauss-Lobatto nodes 0 = tau_0 < ... < tau_{M-1} = 1. The first
+     * sweep takes Euler steps from node to node. Every further sweep corrects the node values U_m with
+     * the spectral integral of f over the values of the previous sweep,
+     *   U_m = U_{m-1} + dt*dtau_m*(f(U_m) - f_old(U_m)) + dt*sum_j S_mj*f_old(U_j)   (implicit Euler)
+     * or with f(U_{m-1}) - f_old(U_{m-1}) for the explicit Euler sweeper, where S_mj integrates the
+     * Lagrange polynomial of node j from tau_{m-1} to tau_m. Every sweep raises the order by one up
+     * to the order 2M - 2 of the collocation method, so K sweeps have order min(K, 2M - 2). The
+     * implicit sweeps are the implicit Euler steps of NewtonSolve, of length dt*dtau_m.
+     *
+     * With set_parallel_sweeps the nodes are updated from the previous sweep only (Jacobi instead of
+     * Gauss-Seidel), so the updates of a sweep are independent and run concurrently (Speck 2018):
+     *   U_m = y + dt*sum_j Q_mj*f_old(U_j) + dt*d_m*(f(U_m) - f_old(U_m))
+     * with Q_mj the integral from 0 to tau_m, d_m = tau_m for the implicit sweeper and 0 for the
+     * explicit one (Picard iterations). The sweeps start from y at every node; their order also rises
+     * by one per sweep. Concurrent updates evaluate the function from several threads at once, which
+     * only the plain double overloads solve(func), solve(sysfunc) and solve(sysfunc, jacfunc) allow.
+     * Every node then factorizes its own Newton matrix with an AutomaticSolver, and starts a thread per
+     * sweep, which pays off when a node update costs much more than starting a thread.
+     *
+     * The Jacobian comes from the solve overloads of EulerImplicit, except for the banded one of the
+     * method of lines in the parallel sweeps. Newton-Krylov isn't supported. Steps of time_step are taken.
+     */
+    class SDC : public EulerImplicit {
+        public:
+            enum class Sweeper { explicit_euler, implicit_euler };
+            // Work of the last solve
+            struct Statistics {
+                size_t steps = 0;
+                size_t sweeps = 0;
+                // implicit or explicit Euler steps of the nodes
+                size_t node_updates = 0;
+            };
+            // The M Gauss-Lobatto nodes on [0, 1], in ascending order
+            static vec lobatto_nodes(size_t M);
+
+            SDC();
+            // The Newton iterations of the nodes converge at a threshold of 1e-10
+            SDC(double limit_low, double limit_high, size_t nodes = 3, size_t sweeps = 4,
+                Sweeper sweeper = Sweeper::implicit_euler);
+            // Number of Gauss-Lobatto nodes, at least 2
+            void set_nodes(size_t);
+            // Number of sweeps per step, including the first, at least 1
+            void set_sweeps(size_t);
+            void set_sweeper(Sweeper);
+            // Update the nodes of a sweep concurrently on `threads` threads; 0 for the sequential sweeps
+            void set_parallel_sweeps(size_t threads);
+            Statistics get_statistics();
+
+            using EulerImplicit::solve;
+            vec& solve(func dnf_dtn, const vec& y0) override;
+            vec& solve(sysfunc dydt, const vec& y0) override;
+            vec& solve(sysfunc dydt, jacfunc jacobian, const vec& y0);
+
+        protected:
+            size_t nodes;
+            size_t sweeps;
+            Sweeper sweeper;
+            size_t parallel_threads = 0;
+            // the function of the running solve may be evaluated from several threads
+            bool concurrent = false;
+            Statistics statistics;
+            // Run a solve overload of EulerImplicit with a plain double function
+            vec& solve_concurrent(const std::function<void()>& solve);
+            void integrate(const linearization& f, const vec& y0, size_t stored, const Sparsity& pattern,
+                           LinearSolver& solver, size_t jacobian_size) override;
+            void integrate(JacobianProduct& f, const vec& y0, size_t stored) override;
+    };
+}
+
+#endif /*ORANGE_DRUM_EXPLORER_SDC_H*/
@@ -0,0 +1,103 @@
+#include <cmath>
+#include <stdexcept>
+
+#include "SDIRK.h"
+
+namespace OrangeDrumExplorer{
+
+    SDIRK::Tableau SDIRK::trapezoidal(){
+        return {{{0.},
+                 {1./2., 1./2.}},
+                {1./2., 1./2.},
+                {1., 0.},
+                {0., 1.},
+                2, 1};
+    }
+
+    SDIRK::Tableau SDIRK::tr_bdf2(){
+        // trapezoidal rule to gamma*dt, BDF2 through y, Y_2 and Y_3
+        const double g = 2. - std::sqrt(2.);
+        const double d = g/2.;
+        const double w = std::sqrt(2.)/4.;
+        return {{{0.},
+                 {d, d},
+                 {w, w, d}},
+                {w, w, d},
+                {(1. - w)/3., (3.*w + 1.)/3., d/3.},
+                {0., g, 1.},
+                2, 3};
+    }
+
+    SDIRK::Tableau SDIRK::sdirk2(){
+        const double g = 1. - std::sqrt(2.)/2.;
+        return {{{g},
+                 {1. - g, g}},
+                {1. - g, g},
+                {1., 0.},
+                {g, 1.},
+                2, 1};
+    }
+
+    SDIRK::Tableau SDIRK::sdirk3(){
+        // gamma is the root of x^3 - 3x^2 + 3x/2 - 1/6 in (1/6, 1/2)
+        const double g = 0.43586652150845899941;
+        const double c2 = (1. + g)/2.;
+        const double b1 = -(6.*g*g - 16.*g + 1.)/4.;
+        const double b2 = (6.*g*g - 20.*g + 5.)/4.;
+        // order 2 from the first two stages
+        const double e2 = (0.5 - g)/(c2 - g);
+        return {{{g},
+                 {c2 - g, g},
+                 {b1, b2, g}},
+                {b1, b2, g},
+                {1. - e2, e2, 0.},
+                {g, c2, 1.},
+                3, 2};
+    }
+
+    SDIRK::Tableau SDIRK::sdirk4(){
+        return {{{1./4.},
+                 {1./2., 1./4.},
+                 {17./50., -1./25., 1./4.},
+                 {371./1360., -137./2720., 15./544., 1./4.},
+                 {25./24., -49./48., 125./16., -85./12., 1./4.}},
+                {25./24., -49./48., 125./16., -85./12., 1./4.},
+                {59./48., -17./96., 225./32., -85./12., 0.},
+                {1./4., 3./4., 11./20., 1./2., 1.},
+                4, 3};
+    }
+
+    DiagonallyImplicitRK::Tableau SDIRK::pair(const Tableau& tableau){
+        const size_t s = tableau.b.size();
+        std::vector<vec> a_explicit(s);
+        for (size_t i = 0; i < s; ++i){
+            a_explicit[i] = vec(i, 0.);
+        }
+        return {a_explicit, tableau.a, vec(s, 0.), tableau.b, vec(s, 0.), tableau.b_hat, tableau.c,
+                tableau.order, tableau.embedded_order};
+    }
+
+    SDIRK::SDIRK()
+        : SDIRK(0., 1.)
+    {}
+
+    SDIRK::SDIRK(double low, double high, Tableau new_tableau)
+        : DiagonallyImplicitRK(low, high)
+    {
+        set_tableau(new_tableau);
+    }
+
+    void SDIRK::set_tableau(const Tableau& new_tableau){
+        const size_t s = new_tableau.b.size();
+        if (s == 0 || new_tableau.a.size() != s || new_tableau.b_hat.size() != s || new_tableau.c.size() != s){
+            throw std::invalid_argument("The tableau needs a, b, b_hat and c for every stage");
+        }
+        for (size_t i = 0; i < s; ++i){
+            if (new_tableau.a[i].size() != i + 1){
+                throw std::invalid_argument("Row i of the tableau needs a_i0 to a_ii");
+            }
+        }
+        set_pair(pair(new_tableau));
+    }
+
+}
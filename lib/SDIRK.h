@@ -0,0 +1,73 @@
+#ifndef ORANGE_DRUM_EXPLORER_SDIRK_H
+#define ORANGE_DRUM_EXPLORER_SDIRK_H
+
+#include <cstddef>
+#include <vector>
+
+#include "AdditiveRK.h"
+
+namespace OrangeDrumExplorer
+{
+    /**
+     * Singly diagonally implicit Runge-Kutta methods (SDIRK, and ESDIRK with an explicit first stage).\n
+     *
+     * Stage i solves Y_i = y + dt*sum_{j<i} a_ij*k_j + gamma*dt*f(t + c_i*dt, Y_i), one implicit
+     * Euler step of length gamma*dt each. All stages share the diagonal gamma, so the Newton matrix
+     * gamma*dt*J - I is the same for every stage: the Jacobian is evaluated and factorized once per
+     * step at its start, and every stage runs simplified Newton iterations on that factorization.
+     * If a stage doesn't converge, the Jacobian is evaluated again at the stage once; if it still
+     * doesn't, the adaptive steps shrink and fixed steps fall back to the full Newton iterations of
+     * EulerImplicit, with a Jacobian in every iteration. The filtered error estimate and the retry of a
+     * rejected step use the Jacobian of the start again.
+     *
+     * An SDIRK method is the additive pair of its tableau with a zero explicit tableau; the stages
+     * and the step size control are those of DiagonallyImplicitRK, shared with AdditiveRK.
+     *
+     * All solve overloads of EulerImplicit are available and take their Jacobians the same way
+     * (adept tape, finite differences, analytic, Dual, Tape, banded for the method of lines),
+     * with the factorization of set_linear_solver. Newton-Krylov isn't supported.
+     *
+     * All the tableaus below carry embedded weights b_hat. With set_tolerances, the difference of the
+     * weights b - b_hat estimates the error of the step: explicit Euler against the trapezoidal rule,
+     * the embedded order 3 of TR-BDF2 against its order 2, and one order below the method for the
+     * Alexander and Hairer-Wanner tableaus. The steps are cut to end on every point of the grid of
+     * time_step, as the derivatives of a stiff problem amplify its errors by the stiffness and don't
+     * interpolate. Otherwise steps of time_step are taken.
+     */
+    class SDIRK : public DiagonallyImplicitRK {
+        public:
+            /**
+             * Butcher tableau with the embedded weights b_hat
+             *
+             * a is lower triangular, row i holds a_i0 ... a_ii; the diagonal is the same gamma for
+             * all rows, or 0 in the first row only (explicit first stage).
+             */
+            struct Tableau {
+                std::vector<vec> a;
+                vec b;
+                vec b_hat;
+                vec c;
+                int order;
+                int embedded_order;
+            };
+            // Trapezoidal rule (Crank-Nicolson) as ESDIRK, order 2, A-stable, with explicit Euler embedded
+            static Tableau trapezoidal();
+            // TR-BDF2 of Hosea and Shampine (1996), order 2, L-stable, with an embedded order 3
+            static Tableau tr_bdf2();
+            // Alexander (1977), 2 stages, order 2, L-stable, with an embedded order 1
+            static Tableau sdirk2();
+            // Alexander (1977), 3 stages, order 3, L-stable, with an embedded order 2
+            static Tableau sdirk3();
+            // Hairer and Wanner (1996), 5 stages, order 4, L-stable, with an embedded order 3
+            static Tableau sdirk4();
+            // The additive pair of a tableau, with a zero explicit tableau
+            static DiagonallyImplicitRK::Tableau pair(const Tableau&);
+
+            SDIRK();
+            // The Newton iterations of the stages converge at a threshold of 1e-10
+            SDIRK(double limit_low, double limit_high, Tableau tableau = tr_bdf2());
+            void set_tableau(const Tableau&);
+    };
+}
+
+#endif /*ORANGE_DRUM_EXPLORER_SDIRK_H*/
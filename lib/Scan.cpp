@@ -0,0 +1,129 @@
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "Scan.h"
+#include "Trace.h"
+
+namespace OrangeDrumExplorer{
+
+    namespace {
+        // shortest block worth the composition and a thread
+        const size_t min_block = 64;
+
+        // y_out = M y + c, with contiguous rows for the vectorizer
+        void apply_map(const vec& M, const vec& c, const vec& y, vec& y_out){
+            const size_t n = y.size();
+            for (size_t i = 0; i < n; ++i){
+                double sum = c[i];
+                for (size_t j = 0; j < n; ++j){
+                    sum += M[i*n + j]*y[j];
+                }
+                y_out[i] = sum;
+            }
+        }
+
+        // P <- M P, q <- M q + c; the inner loop runs along the rows of P
+        void compose_map(const vec& M, const vec& c, vec& P, vec& q, vec& P_out, vec& q_out){
+            const size_t n = q.size();
+            std::fill(P_out.begin(), P_out.end(), 0.);
+            for (size_t i = 0; i < n; ++i){
+                for (size_t k = 0; k < n; ++k){
+                    const double m = M[i*n + k];
+                    for (size_t j = 0; j < n; ++j){
+                        P_out[i*n + j] += m*P[k*n + j];
+                    }
+                }
+            }
+            apply_map(M, c, q, q_out);
+            P.swap(P_out);
+            q.swap(q_out);
+        }
+    }
+
+    void affine_scan(const affine_step& step, const vec& y0, size_t N, size_t threads, const indexed_sink& store){
+        if (threads == 0){
+            throw std::invalid_argument("At least one thread is needed");
+        }
+        const size_t n = y0.size();
+        const size_t blocks = std::max<size_t>(1, std::min(threads, N/min_block));
+        // block k holds the steps first[k] ... first[k+1]-1
+        std::vector<size_t> first(blocks + 1);
+        for (size_t k = 0; k <= blocks; ++k){
+            first[k] = N*k/blocks;
+        }
+        // state at the start of every block, and then at its end
+        std::vector<vec> state(blocks, vec(n));
+        state[0] = y0;
+        std::vector<vec> P(blocks), q(blocks);
+        std::vector<std::exception_ptr> errors(blocks);
+
+        auto advance = [&](size_t k){
+            ODE_TRACE_SCOPE("scan_advance");
+            vec M(n*n), c(n), next(n);
+            vec& y = state[k];
+            for (size_t i = first[k]; i < first[k+1]; ++i){
+                std::fill(M.begin(), M.end(), 0.);
+                std::fill(c.begin(), c.end(), 0.);
+                step(i, M, c);
+                apply_map(M, c, y, next);
+                y.swap(next);
+                store(i+1, y);
+            }
+        };
+        auto compose = [&](size_t k){
+            ODE_TRACE_SCOPE("scan_compose");
+            vec M(n*n), c(n), P_out(n*n), q_out(n);
+            P[k].assign(n*n, 0.);
+            q[k].assign(n, 0.);
+            for (size_t j = 0; j < n; ++j){
+                P[k][j*n + j] = 1.;
+            }
+            for (size_t i = first[k]; i < first[k+1]; ++i){
+                std::fill(M.begin(), M.end(), 0.);
+                std::fill(c.begin(), c.end(), 0.);
+                step(i, M, c);
+                compose_map(M, c, P[k], q[k], P_out, q_out);
+            }
+        };
+        // run `task` on the blocks from `begin` on, the first one on the calling thread
+        auto parallel = [&](const std::function<void(size_t)>& task, size_t begin){
+            std::vector<std::thread> pool;
+            auto guarded = [&](size_t k){
+                try{
+                    task(k);
+                }
+                catch (...){
+                    errors[k] = std::current_exception();
+                }
+            };
+            for (size_t k = begin + 1; k < blocks; ++k){
+                pool.emplace_back(guarded, k);
+            }
+            guarded(begin);
+            for (auto& thread : pool){
+                thread.join();
+            }
+            for (const auto& error : errors){
+                if (error){
+                    std::rethrow_exception(error);
+                }
+            }
+        };
+
+        if (blocks == 1){
+            advance(0);
+            return;
+        }
+        // block 0 steps from y0 while the others compose their maps
+        parallel([&](size_t k){ k == 0 ? advance(0) : compose(k); }, 0);
+        // carry the end of block 0 across the block maps to the start of every later block
+        state[1] = state[0];
+        for (size_t k = 2; k < blocks; ++k){
+            apply_map(P[k-1], q[k-1], state[k-1], state[k]);
+        }
+        parallel(advance, 1);
+    }
+}
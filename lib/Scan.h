@@ -0,0 +1,38 @@
+#ifndef ORANGE_DRUM_EXPLORER_SCAN_H
+#define ORANGE_DRUM_EXPLORER_SCAN_H
+
+#include <cstddef>
+#include <functional>
+
+#include "Solver.h"
+
+namespace OrangeDrumExplorer
+{
+    // Map of step i of an affine recurrence, y_{i+1} = M y_i + c with M row by row; both are zeroed before every call
+    typedef std::function<void(size_t i, vec& M, vec& c)> affine_step;
+    // Receives the state y_i of an affine recurrence, i = 1 ... N
+    typedef std::function<void(size_t i, const vec& y)> indexed_sink;
+
+    /**
+     * Evaluate the affine recurrence y_{i+1} = M_i y_i + c_i for i < N by a blocked parallel scan.\n
+     *
+     * The steps are split into one contiguous block per thread. The first block steps from y0 while
+     * every other block composes its maps into a single affine map (P, q), P = M_last ... M_first; the
+     * composition is associative, so the blocks are independent. The block maps then carry y0 to the
+     * start of every block in a short sequential pass, and the blocks step from their starts in parallel.
+     * Every map of the blocks after the first is evaluated twice, and composing costs a matrix product,
+     * O(n^3) per step against O(n^2) for stepping, so the scan pays off for small states and many cores.
+     * Blocks are at least 64 steps long; with fewer steps or one thread the recurrence is stepped in order.
+     * With more than one block, `step` is called from several threads at once and `store` from one
+     * thread per block, with distinct i.
+     *
+     * @param step(i,M,c) - map of step i
+     * @param y0 - initial state
+     * @param N - number of steps
+     * @param threads - number of threads, at least 1
+     * @param store(i,y) - receives every state after the initial one
+     */
+    void affine_scan(const affine_step& step, const vec& y0, size_t N, size_t threads, const indexed_sink& store);
+}
+
+#endif /*ORANGE_DRUM_EXPLORER_SCAN_H*/
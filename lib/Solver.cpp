@@ -4,15 +4,19 @@
 #include <cmath>
 
 #include "Solver.h"
+#include "FiniteDifference.h"
+#include "Jacobian.h"
+#include "Krylov.h"
+#include "LinearSolver.h"
+#include "MethodOfLines.h"
+#include "Scan.h"
+#include "Trace.h"
 
 #ifndef ODEINCL_ADEPT_SORUCE_H
 #include <adept_source.h>
 #define ODEINCL_ADEPT_SORUCE_H
 #endif /*ODEINCL_ADEPT_SORUCE_H*/
 
-#include <Eigen/Core>
-#include <Eigen/LU>
-
 namespace OrangeDrumExplorer{
     class bad_function_call : public std::bad_function_call
     {
@@ -27,13 +31,67 @@ namespace OrangeDrumExplorer{
             }
     };
 
+// -------- Compressed Jacobian ----------------
+
+    std::vector<size_t> column_offsets(const Sparsity& pattern){
+        std::vector<size_t> offsets(pattern.size() + 1, 0);
+        for (size_t j = 0; j < pattern.size(); ++j){
+            offsets[j+1] = offsets[j] + pattern[j].size();
+        }
+        return offsets;
+    }
+
+    size_t jacobian_values(const Sparsity& pattern, size_t n){
+        return pattern.empty() ? n*n : column_offsets(pattern).back();
+    }
+
+// -------- Companion system ----------------
+
+    sysfunc companion(func dnf_dtn){
+        return [dnf_dtn](double t, const vec& y, vec& dydt){
+            const size_t n = y.size();
+            for (size_t j = 0; j + 1 < n; ++j){
+                dydt[j] = y[j+1];
+            }
+            dydt[n-1] = dnf_dtn(t, y);
+        };
+    }
+
+    adsysfunc companion(adfunc dnf_dtn){
+        return [dnf_dtn](adouble t, const advec& y, advec& dydt){
+            const size_t n = y.size();
+            for (size_t j = 0; j + 1 < n; ++j){
+                dydt[j] = y[j+1];
+            }
+            dydt[n-1] = dnf_dtn(t, y);
+        };
+    }
+
+    sysfunc evaluate_values(adsysfunc dydt){
+        advec y, dy;
+        return [dydt, y, dy](double t, const vec& x, vec& f) mutable {
+            const size_t n = x.size();
+            y.resize(n);
+            dy.resize(n);
+            for (size_t j = 0; j < n; ++j){
+                y[j] = x[j];
+            }
+            dydt(t, y, dy);
+            for (size_t j = 0; j < n; ++j){
+                f[j] = adept::value(dy[j]);
+            }
+        };
+    }
+
 // -------- Solver ----------------
 
     Solver::Solver()
         : Solver(0., 1.) //default limits and step
     {}
 
-    Solver::Solver(double low, double high){
+    Solver::Solver(double low, double high)
+        : time_step((high - low)/100) //time step is needed to reserve the result of set_limits
+    {
         //default step
         set_limits(low, high);
         set_time_step( (high - low)/100);
@@ -83,8 +141,13 @@ namespace OrangeDrumExplorer{
     bool Solver::check_solution_cache(){
         return has_been_solved;
     }
+
+    size_t Solver::get_state_size(){
+        return state_size;
+    }
     
     void Solver::save_solution(std::ofstream& outfile){
+        ODE_TRACE_SCOPE("save_solution");
         if (!has_been_solved){
             throw bad_function_call("No cached solution to save");
         }
@@ -92,8 +155,12 @@ namespace OrangeDrumExplorer{
         if (doitmyself){
             outfile.open("OrangeDrumExplorer_solution.txt");
         }
-        for(auto el : result){
-            outfile << el << std::endl;
+        for (size_t i = 0; i < result.size(); i += state_size){
+            outfile << result[i];
+            for (size_t j = 1; j < state_size; ++j){
+                outfile << " " << result[i+j];
+            }
+            outfile << std::endl;
         }
         if (doitmyself){
             outfile.close();
@@ -104,6 +171,46 @@ namespace OrangeDrumExplorer{
         throw bad_function_call("This Solver requires Adept instrumented function.");
     }
 
+    vec& Solver::solve(sysfunc dydt, const vec& y0){
+        throw bad_function_call("This Solver requires Adept instrumented function.");
+    }
+
+
+// -------- Streaming Solver ----------------
+
+    vec& StreamingSolver::store(const sysfunc& dydt, const vec& y0, bool function_value){
+        const size_t N = (limit_high - limit_low)/time_step;
+        const size_t n = function_value ? 1 : y0.size();
+        state_size = n;
+        result.resize((N+1)*n);
+        size_t step = 0;
+        solve(dydt, y0, [this, n, &step](double, const vec& y){
+            std::copy(y.begin(), y.begin() + n, result.begin() + (step++)*n);
+        });
+        has_been_solved = true;
+        return result;
+    }
+
+    vec& StreamingSolver::solve(sysfunc dydt, const vec& y0){
+        return store(dydt, y0, false);
+    }
+
+    vec& StreamingSolver::solve(func dnf_dtn, const vec& y0){
+        return store(companion(dnf_dtn), y0, true);
+    }
+
+    vec& StreamingSolver::solve(adsysfunc dydt, const vec& y0){
+        adept::Stack ADstack; //segfault if not initialized
+        ADstack.pause_recording();
+        return store(evaluate_values(dydt), y0, false);
+    }
+
+    vec& StreamingSolver::solve(adfunc dnf_dtn, const vec& y0){
+        adept::Stack ADstack; //segfault if not initialized
+        ADstack.pause_recording();
+        return store(evaluate_values(companion(dnf_dtn)), y0, true);
+    }
+
 
 // -------- Euler Explicit ----------------
 
@@ -121,12 +228,15 @@ namespace OrangeDrumExplorer{
         for (auto d : y0){
             ynext.push_back(d);
         }
-        result.push_back(y0[0]);
+        state_size = 1;
         result.resize(N+1);
+        result[0] = y0[0];
         double t = a;
         //step through the domain
         for (auto i = 0; i < N; ++i){
-            t = a+(i+1)*dt;
+            ODE_TRACE_SCOPE("step");
+            // the derivatives at the start of the step, as for the companion system
+            t = a+i*dt;
             // compute highest derivative for this loop
             adouble funcval = dnf_dtn(t, ynext);
             //update lower derivatives based on previous loop
@@ -151,12 +261,15 @@ namespace OrangeDrumExplorer{
         const size_t n = y0.size();
         
         vec ynext = y0;
-        result.push_back(y0[0]);
+        state_size = 1;
         result.resize(N+1);
+        result[0] = y0[0];
         double t = a;
         //step through the domain
         for (auto i = 0; i < N; ++i){
-            t = a+(i+1)*dt;
+            ODE_TRACE_SCOPE("step");
+            // the derivatives at the start of the step, as for the companion system
+            t = a+i*dt;
             // compute highest derivative for this loop
             double funcval = dnf_dtn(t, ynext);
             //update lower derivatives based on previous loop
@@ -172,6 +285,96 @@ namespace OrangeDrumExplorer{
         return result;
     }
 
+    vec& EulerExplicit::solve(sysfunc dydt, const vec& y0){
+        const double a = limit_low;
+        const double b = limit_high;
+        const double dt = time_step;
+        const size_t N = (b-a)/dt;
+        const size_t n = y0.size();
+
+        vec y = y0;
+        vec dy(n);
+        state_size = n;
+        result.resize((N+1)*n);
+        std::copy(y0.begin(), y0.end(), result.begin());
+        //step through the domain
+        for (size_t i = 0; i < N; ++i){
+            ODE_TRACE_SCOPE("step");
+            // y(t+dt) = y(t) + y'(t)*dt
+            dydt(a+i*dt, y, dy);
+            for (size_t j = 0; j < n; ++j){
+                y[j] += dy[j]*dt;
+            }
+            std::copy(y.begin(), y.end(), result.begin() + (i+1)*n);
+        }
+        has_been_solved = true;
+        return result;
+    }
+
+    vec& EulerExplicit::solve(adsysfunc dydt, const vec& y0){
+        adept::Stack ADstack; //segfault if not initialized
+        ADstack.pause_recording();
+
+        const double a = limit_low;
+        const double b = limit_high;
+        const double dt = time_step;
+        const size_t N = (b-a)/dt;
+        const size_t n = y0.size();
+
+        advec y(y0.begin(), y0.end());
+        advec dy(n);
+        state_size = n;
+        result.resize((N+1)*n);
+        std::copy(y0.begin(), y0.end(), result.begin());
+        //step through the domain
+        for (size_t i = 0; i < N; ++i){
+            ODE_TRACE_SCOPE("step");
+            // y(t+dt) = y(t) + y'(t)*dt
+            dydt(a+i*dt, y, dy);
+            for (size_t j = 0; j < n; ++j){
+                y[j] += dy[j]*dt;
+                result[(i+1)*n + j] = adept::value(y[j]);
+            }
+        }
+        has_been_solved = true;
+        return result;
+    }
+
+    void EulerExplicit::set_scan_threads(size_t threads){
+        if (threads == 0){
+            throw std::invalid_argument("At least one thread is needed");
+        }
+        scan_threads = threads;
+    }
+
+    vec& EulerExplicit::solve_affine(affinefunc coefficients, const vec& y0){
+        const double a = limit_low;
+        const double b = limit_high;
+        const double dt = time_step;
+        const size_t N = (b-a)/dt;
+        const size_t n = y0.size();
+
+        state_size = n;
+        result.resize((N+1)*n);
+        std::copy(y0.begin(), y0.end(), result.begin());
+        // M = I + dt*A(t), c = dt*b(t); A is filled in M directly
+        affine_step step = [&](size_t i, vec& M, vec& c){
+            coefficients(a+i*dt, M, c);
+            for (size_t j = 0; j < n; ++j){
+                for (size_t k = 0; k < n; ++k){
+                    M[j*n + k] *= dt;
+                }
+                M[j*n + j] += 1.;
+                c[j] *= dt;
+            }
+        };
+        affine_scan(step, y0, N, scan_threads, [&](size_t i, const vec& y){
+            std::copy(y.begin(), y.end(), result.begin() + i*n);
+        });
+        has_been_solved = true;
+        return result;
+    }
+
 
 // -------- Euler Implicit ----------------
 
@@ -183,113 +386,370 @@ namespace OrangeDrumExplorer{
         threshold = new_threshold;
     }
 
-    struct EulerImplicit::DivergentException : public std::exception{
-        const char * what () const throw (){
-    	    return "The solution doesn't converge.";
-        }
-    };
+    void EulerImplicit::set_sparsity(const Sparsity& pattern){
+        sparsity = pattern;
+    }
 
-    vec EulerImplicit::NewtonSolve(adfunc dnf_dtn, const double t, const vec& x0){
-        adept::Stack ADstack;
-        const size_t n = x0.size();
-        const double dt = time_step;
-        advec x;
-        for (auto el : x0){
-            x.push_back(el);
+    void EulerImplicit::set_jacobian_threads(size_t threads){
+        if (threads == 0){
+            throw std::invalid_argument("At least one thread is needed");
         }
-        ADstack.new_recording();
-
-        int iter=0;
-
-        //define Jacobian Jf for ND Newton Method
-        //   -1   1     0    0
-        //   0    -1    1    0
-        //   0    0     -1   1
-        // df/dy df/dy df/dy df/y-1 (update every loop)
-        Eigen::MatrixXd JF = Eigen::MatrixXd::Constant(n,n,0.);
-        for(size_t i=0; i<n-1; i++){
-            JF(i,i)=-1;
-            JF(i,i+1)=dt;
+        jacobian_threads = threads;
+    }
+
+    void EulerImplicit::set_newton_krylov(size_t restart, std::shared_ptr<Preconditioner> new_preconditioner,
+                                          double tolerance){
+        if (tolerance <= 0.){
+            throw std::invalid_argument("The GMRES tolerance has to be positive");
         }
+        krylov_restart = restart;
+        preconditioner = new_preconditioner;
+        krylov_tolerance = tolerance;
+    }
+
+    void EulerImplicit::set_linear_solver(std::shared_ptr<LinearSolver> solver){
+        linear_solver = solver;
+    }
 
-        Eigen::VectorXd F = Eigen::VectorXd::Constant(n, 0);
-        Eigen::VectorXd delta = Eigen::VectorXd::Constant(n, 0);
-        adouble eval_dnf_dtn;
+    namespace {
+        // Record the system on the adept tape of the active stack and take the Jacobian from it
+        class TapeLinearization {
+            private:
+                adsysfunc dydt;
+                advec y;
+                advec f;
+                vec jacobian;
+                Sparsity pattern;
+                std::vector<size_t> offsets;
+                std::vector<std::vector<size_t>> groups;
+            public:
+                // With a sparsity pattern the columns of a group are seeded together in one forward pass,
+                // into the compressed values of the Jacobian
+                TapeLinearization(adsysfunc function, size_t n, const Sparsity& sparsity = Sparsity())
+                    : dydt(function), y(n), f(n), jacobian(sparsity.empty() ? n*n : 0), pattern(sparsity),
+                      offsets(column_offsets(sparsity)),
+                      groups(sparsity.empty() ? std::vector<std::vector<size_t>>() : column_groups(sparsity, n))
+                {}
+                void operator()(double t, const vec& x, vec& fx, vec& J){
+                    adept::Stack& stack = *adept::active_stack();
+                    const size_t n = x.size();
+                    // the independents are set before the recording, a statement assigning them
+                    // inside the recording would overwrite the seeds of the forward pass
+                    for (size_t j=0; j<n; ++j){
+                        y[j] = x[j];
+                    }
+                    stack.new_recording();
+                    dydt(t, y, f);
+                    for (size_t i=0; i<n; ++i){
+                        fx[i] = adept::value(f[i]);
+                    }
+                    if (J.empty()){
+                        return;
+                    }
+                    ODE_TRACE_SCOPE("jacobian");
+                    if (!pattern.empty()){
+                        for (const auto& group : groups){
+                            stack.clear_gradients();
+                            for (size_t j : group){
+                                y[j].set_gradient(1.);
+                            }
+                            stack.compute_tangent_linear();
+                            for (size_t j : group){
+                                for (size_t k = 0; k < pattern[j].size(); ++k){
+                                    J[offsets[j] + k] = f[pattern[j][k]].get_gradient();
+                                }
+                            }
+                        }
+                        return;
+                    }
+                    stack.independent(&y[0], n);
+                    stack.dependent(&f[0], n);
+                    stack.jacobian(jacobian.data());
+                    // adept stores d f[i]/d y[j] at [j*n + i]
+                    for (size_t i=0; i<n; ++i){
+                        for (size_t j=0; j<n; ++j){
+                            J[i*n + j] = jacobian[j*n + i];
+                        }
+                    }
+                }
+        };
+
+        // Record the system on the adept tape of the active stack, Jacobian-vector products by its tangent-linear pass
+        class TapeProduct : public JacobianProduct {
+            private:
+                adsysfunc dydt;
+                advec y;
+                advec f;
+            public:
+                TapeProduct(adsysfunc function, size_t n)
+                    : dydt(function), y(n), f(n)
+                {}
+                void linearize(double t, const vec& x, vec& fx) override {
+                    adept::Stack& stack = *adept::active_stack();
+                    const size_t n = x.size();
+                    for (size_t j=0; j<n; ++j){
+                        y[j] = x[j];
+                    }
+                    stack.new_recording();
+                    dydt(t, y, f);
+                    for (size_t i=0; i<n; ++i){
+                        fx[i] = adept::value(f[i]);
+                    }
+                }
+                void apply(const vec& v, vec& Jv) override {
+                    adept::Stack& stack = *adept::active_stack();
+                    stack.clear_gradients();
+                    for (size_t j=0; j<y.size(); ++j){
+                        y[j].set_gradient(v[j]);
+                    }
+                    stack.compute_tangent_linear();
+                    for (size_t i=0; i<f.size(); ++i){
+                        Jv[i] = f[i].get_gradient();
+                    }
+                }
+        };
+    }
+
+    vec EulerImplicit::NewtonSolve(const linearization& f, const double t, const vec& x0, double dt,
+                                   const Sparsity& pattern, vec& J, LinearSolver& solver) const {
+        const size_t n = x0.size();
+        vec x = x0;
+        vec fx(n), F(n), delta(n);
+
+        size_t iter=0;
+
+        // Newton Method for F(x) = x0 + dt*f(t, x) - x with the Jacobian JF = dt*df/dx - I
         while (iter<max_iterations){
+            ODE_TRACE_SCOPE("NewtonSolve iteration");
 
-            eval_dnf_dtn = dnf_dtn(t, x);
-            eval_dnf_dtn.set_gradient(1.0);
-            ADstack.compute_adjoint();
+            f(t, x, fx, J);
 
             //Define F (RHS)
-            // F = y(previous t) + dt*y'(this t, previous iter) + y(this t, previous iter)
-            for (size_t j=0; j<n-1;j++){
-                F(j) = adept::value(x0[j] + dt*x[j+1]-x[j]);
-                JF(n-1,j) = dt*x[j].get_gradient(); //last row of JF thru automatic derivatives
+            // F = y(previous t) + dt*y'(this t, previous iter) - y(this t, previous iter)
+            for (size_t j=0; j<n; ++j){
+                F[j] = x0[j] + dt*fx[j] - x[j];
             }
-            // y'[n] = dnf_dtn(this t, previous iter)
-            F(n-1) = adept::value(x0[n-1] + dt*eval_dnf_dtn - x[n-1]);
-            
-            JF(n-1, n-1) = dt*x[n-1].get_gradient() - 1.; //last element
-    
-            // use Eigen to solve x = solve(Jf, F) - x
-            delta = JF.fullPivLu().solve(F);
 
             // Check if real solution
-            if((JF*delta).isApprox(F)!=true){
+            if (!solver.factorize(J, n, dt, pattern) || !solver.solve(F, delta)){
                 throw DivergentException();
             }
-            // Check if valid solution
-            if (delta.array().isNaN().any()){
-                throw DivergentException();
+            bool converged = true;
+            for (size_t j=0; j<n; ++j){
+                // Check if valid solution
+                if (std::isnan(delta[j])){
+                    throw DivergentException();
+                }
+                converged = converged && std::abs(delta[j]) < threshold;
             }
             // Check if converged
-            if ((delta.array().abs() < threshold).all()){
+            if (converged){
                 //last loop
                 iter = max_iterations; 
             }
             // Update x
             for (size_t j=0; j<n; ++j){
-                x[j] -= delta(j);
+                x[j] -= delta[j];
             }
             ++iter;
         }
-        vec out;
-        for (auto el: x){
-            out.push_back(adept::value(el));
+        return x;
+    }
+
+    vec EulerImplicit::NewtonKrylovSolve(JacobianProduct& f, const double t, const vec& x0){
+        const size_t n = x0.size();
+        const double dt = time_step;
+        vec x = x0;
+        vec fx(n), F(n), delta(n);
+        const linear_operator jv = [&f](const vec& v, vec& Jv){ f.apply(v, Jv); };
+        // Newton matrix I - dt*df/dx, applied without forming it
+        const linear_operator newton_matrix = [&f, dt](const vec& v, vec& Av){
+            f.apply(v, Av);
+            for (size_t i=0; i<v.size(); ++i){
+                Av[i] = v[i] - dt*Av[i];
+            }
+        };
+
+        size_t iter=0;
+        // Newton Method for F(x) = x0 + dt*f(t, x) - x, each step solves (I - dt*df/dx) delta = F
+        while (iter<max_iterations){
+            ODE_TRACE_SCOPE("NewtonKrylov iteration");
+            f.linearize(t, x, fx);
+            for (size_t j=0; j<n; ++j){
+                F[j] = x0[j] + dt*fx[j] - x[j];
+            }
+            if (preconditioner){
+                preconditioner->setup(t, x, dt, jv);
+            }
+            std::fill(delta.begin(), delta.end(), 0.);
+            const GmresResult solved = gmres(newton_matrix, F, delta, krylov_restart, krylov_tolerance,
+                                             20*krylov_restart, preconditioner.get());
+            if (!solved.converged){
+                throw DivergentException();
+            }
+            bool converged = true;
+            for (size_t j=0; j<n; ++j){
+                if (std::isnan(delta[j])){
+                    throw DivergentException();
+                }
+                converged = converged && std::abs(delta[j]) < threshold;
+            }
+            if (converged){
+                //last loop
+                iter = max_iterations;
+            }
+            for (size_t j=0; j<n; ++j){
+                x[j] += delta[j];
+            }
+            ++iter;
         }
-        return out;
+        return x;
     }
 
-    vec& EulerImplicit::solve(adfunc dnf_dtn, const vec& y0){
+    void EulerImplicit::integrate_steps(const step_solver& step, const vec& y0, size_t stored){
         const double a = limit_low;
         const double b = limit_high;
         const double dt = time_step;
         const size_t N = (b-a)/dt;
-        const size_t n = y0.size();
-        
+
         vec yt = y0;
 
-        vec ynext(n);
-        result.push_back(y0[0]);
-        result.resize(N+1);
+        state_size = stored;
+        result.resize((N+1)*stored);
+        std::copy(y0.begin(), y0.begin() + stored, result.begin());
         double t = a;
         //step through the domain
-        for (auto i = 0; i < N; ++i){
+        for (size_t i = 0; i < N; ++i){
+            ODE_TRACE_SCOPE("step");
             t = a+(i+1)*dt;
             try{
-                 ynext = NewtonSolve(dnf_dtn, t, yt);
+                 yt = step(t, yt);
             }
-            catch (DivergentException){
-                for (auto j=i; j<N; ++j){
-                    result[j+1] = std::nan("");
-                }
+            catch (const DivergentException&){
+                std::fill(result.begin() + (i+1)*stored, result.end(), std::nan(""));
                 break;
             }
-            result[i+1] = ynext[0];
-            yt = ynext;
+            std::copy(yt.begin(), yt.begin() + stored, result.begin() + (i+1)*stored);
         }
         has_been_solved = true;
+    }
+
+    void EulerImplicit::integrate(const linearization& f, const vec& y0, size_t stored, const Sparsity& pattern){
+        AutomaticSolver automatic;
+        integrate(f, y0, stored, pattern, linear_solver ? *linear_solver : automatic,
+                  jacobian_values(pattern, y0.size()));
+    }
+
+    void EulerImplicit::integrate(const linearization& f, const vec& y0, size_t stored, const Sparsity& pattern,
+                                  LinearSolver& solver, size_t jacobian_size){
+        vec J(jacobian_size);
+        integrate_steps([&](double t, const vec& y){ return NewtonSolve(f, t, y, time_step, pattern, J, solver); },
+                        y0, stored);
+    }
+
+    void EulerImplicit::integrate(JacobianProduct& f, const vec& y0, size_t stored){
+        integrate_steps([&](double t, const vec& y){ return NewtonKrylovSolve(f, t, y); }, y0, stored);
+    }
+
+    vec& EulerImplicit::solve(func dnf_dtn, const vec& y0){
+        if (krylov_restart > 0){
+            DirectionalDifference product(companion(dnf_dtn), y0.size());
+            integrate(product, y0, 1);
+            return result;
+        }
+        // the sparsity pattern describes systems, the companion system is differentiated densely
+        integrate(FiniteDifferenceJacobian(companion(dnf_dtn), y0.size(), Sparsity(), jacobian_threads), y0, 1);
+        return result;
+    }
+
+    vec& EulerImplicit::solve(sysfunc dydt, const vec& y0){
+        if (krylov_restart > 0){
+            DirectionalDifference product(dydt, y0.size());
+            integrate(product, y0, y0.size());
+            return result;
+        }
+        integrate(FiniteDifferenceJacobian(dydt, y0.size(), sparsity, jacobian_threads), y0, y0.size(), sparsity);
+        return result;
+    }
+
+    vec& EulerImplicit::solve(sysfunc dydt, jacfunc jacobian, const vec& y0){
+#ifndef NDEBUG
+        // a wrong Jacobian only shows as slow or failed convergence, check it once
+        if (jacobian_error(dydt, jacobian, limit_low, y0) > 1e-4){
+            throw std::invalid_argument("The Jacobian doesn't match the finite differences of the system");
+        }
+#endif
+        // the user fills the n*n Jacobian, with a sparsity pattern its entries are compressed from it
+        const Sparsity pattern = sparsity;
+        linearization analytic = [dydt, jacobian, pattern](double t, const vec& y, vec& f, vec& J){
+            dydt(t, y, f);
+            if (J.empty()){
+                return;
+            }
+            if (pattern.empty()){
+                std::fill(J.begin(), J.end(), 0.);
+                jacobian(t, y, J);
+                return;
+            }
+            // local, the concurrent sweeps of SDC call this from several threads
+            const size_t n = y.size();
+            vec dense(n*n, 0.);
+            jacobian(t, y, dense);
+            size_t k = 0;
+            for (size_t j = 0; j < n; ++j){
+                for (size_t i : pattern[j]){
+                    J[k++] = dense[i*n + j];
+                }
+            }
+        };
+        integrate(analytic, y0, y0.size(), sparsity);
+        return result;
+    }
+
+    vec& EulerImplicit::solve(const MethodOfLines& pde, const vec& u0){
+        const size_t m = pde.points();
+        if (u0.size() != m){
+            throw std::invalid_argument("The initial state needs one value per point of the grid");
+        }
+        if (krylov_restart > 0){
+            DirectionalDifference product(pde.system(), m);
+            integrate(product, u0, m);
+            return result;
+        }
+        const size_t r = pde.radius();
+        BandedLUSolver banded(r, r, BandedLUSolver::Storage::band);
+        linearization band = [&pde](double t, const vec& u, vec& dudt, vec& J){
+            if (J.empty()){
+                pde(t, u, dudt);
+            }
+            else{
+                pde.linearize(t, u, dudt, J);
+            }
+        };
+        integrate(band, u0, m, Sparsity(), banded, (2*r + 1)*m);
+        return result;
+    }
+
+    vec& EulerImplicit::solve(adfunc dnf_dtn, const vec& y0){
+        // the scalar form is the companion system, storing only the function value
+        adept::Stack ADstack;
+        if (krylov_restart > 0){
+            TapeProduct product(companion(dnf_dtn), y0.size());
+            integrate(product, y0, 1);
+            return result;
+        }
+        integrate(TapeLinearization(companion(dnf_dtn), y0.size()), y0, 1);
+        return result;
+    }
+
+    vec& EulerImplicit::solve(adsysfunc dydt, const vec& y0){
+        adept::Stack ADstack;
+        if (krylov_restart > 0){
+            TapeProduct product(dydt, y0.size());
+            integrate(product, y0, y0.size());
+            return result;
+        }
+        integrate(TapeLinearization(dydt, y0.size(), sparsity), y0, y0.size(), sparsity);
         return result;
     }
 
@@ -1,13 +1,19 @@
 #ifndef ORANGE_DRUM_EXPLORER_SOLVER_H
 #define ORANGE_DRUM_EXPLORER_SOLVER_H
 
+#include <algorithm>
+#include <exception>
 #include <functional>
+#include <memory>
 #include <vector>
 #include <iostream>
 #include <fstream>
 
 #include <adept.h>
 
+#include "Dual.h"
+#include "Tape.h"
+
 namespace OrangeDrumExplorer
 {
     typedef adept::adouble adouble;
@@ -15,6 +21,36 @@ namespace OrangeDrumExplorer
     typedef std::function<double(double, const vec&)> func ;
     typedef std::vector<adouble> advec;
     typedef std::function<adouble(adouble, const advec&)> adfunc ;
+    typedef std::function<void(double, const vec&, vec&)> sysfunc ;
+    typedef std::function<void(adouble, const advec&, advec&)> adsysfunc ;
+    // Jacobian of a system at (t, y), J[i*n + j] = df_i/dy_j
+    typedef std::function<void(double, const vec&, vec&)> jacfunc ;
+    // Sparsity pattern of a Jacobian: for every column j the rows i with a possibly non-zero df_i/dy_j,
+    // empty for a dense Jacobian
+    typedef std::vector<std::vector<size_t>> Sparsity;
+    /**
+     * Start of every column in the compressed values of a Jacobian with this pattern.\n
+     *
+     * With a sparsity pattern the implicit solvers keep only the entries of the pattern, column by
+     * column: df_i/dy_j for the k-th row i of pattern[j] at values[offsets[j] + k]. The last offset
+     * is the number of values.
+     */
+    std::vector<size_t> column_offsets(const Sparsity& pattern);
+    // Number of values of the Jacobian of n unknowns: n*n row by row without pattern, compressed otherwise
+    size_t jacobian_values(const Sparsity& pattern, size_t n);
+    // Receives the state y at time t after every step, and first the initial state
+    typedef std::function<void(double t, const vec& y)> sink;
+    // Coefficients of a linear system y' = A(t) y + b(t) at t, A row by row; both are zeroed before every call
+    typedef std::function<void(double t, vec& A, vec& b)> affinefunc;
+
+    /**
+     * Convert a scalar n-th order equation into the equivalent first-order system
+     * y'[j] = y[j+1] for j < n-1 and y'[n-1] = dnf_dtn(t, y)
+     */
+    sysfunc companion(func dnf_dtn);
+    adsysfunc companion(adfunc dnf_dtn);
+    // Evaluate an instrumented system with plain double values, needs an adept stack with paused recording
+    sysfunc evaluate_values(adsysfunc dydt);
 
     /**
      * Base class for implementing solvers.\n
@@ -25,6 +61,8 @@ namespace OrangeDrumExplorer
      * @param limit_low - lower limit of the Domain
      * @param limit_high - upper limit of the Domain
      * @param time_step - time step to use to solve the equation
+     * @param result - solution at every step; the function value for the scalar form,
+     *      the full state (state_size values per step, row by row) for systems
      */
     class Solver
     {   
@@ -33,6 +71,7 @@ namespace OrangeDrumExplorer
             double limit_high;
             double time_step;
             bool has_been_solved = false;
+            size_t state_size = 1;
             vec result;
             void init_result();
         public:
@@ -46,7 +85,9 @@ namespace OrangeDrumExplorer
             void set_time_step(double);
             // Check if a solution has been cached
             bool check_solution_cache();
-            // Store the last solution to filestream. The user needs to handle open/close.
+            // Number of values stored per step in the last solution
+            size_t get_state_size();
+            // Store the last solution to filestream, one step per line. The user needs to handle open/close.
             void save_solution(std::ofstream&);
             /**
              * Solve the function over the domain, given the initial value
@@ -56,32 +97,287 @@ namespace OrangeDrumExplorer
              *      @param y - vector of lower derivatives y[0] = f; y[1] =f'; y[2] = f'' etc. up-to n-1
              * @param y0 - initial value of the function and n-1 lowest derivatives at the lower limit
              */
-            vec& solve(func dnf_dtn, const vec& y0);
+            virtual vec& solve(func dnf_dtn, const vec& y0);
             virtual vec& solve(adfunc dnf_dtn, const vec& y0) = 0;
+            /**
+             * Solve a system of first-order equations over the domain, given the initial state
+             *
+             * @param dydt(t,y,dydt) - explicit definition of the system
+             *      @param t - independent variable
+             *      @param y - state vector
+             *      @param dydt - output, derivative of the state vector (sized as y)
+             * @param y0 - initial state at the lower limit
+             * @return the state at every step, row by row
+             */
+            virtual vec& solve(sysfunc dydt, const vec& y0);
+            virtual vec& solve(adsysfunc dydt, const vec& y0) = 0;
+    };
+
+    /**
+     * Base class of the solvers that pass every step to a sink.\n
+     *
+     * Implementations only solve systems into a sink. The stored solve overloads are built on it:
+     * the scalar forms as the companion system storing only the function value, the instrumented
+     * forms evaluated with plain double values.
+     */
+    class StreamingSolver : public Solver {
+        public:
+            using Solver::Solver;
+            using Solver::solve;
+            vec& solve(func dnf_dtn, const vec& y0) override;
+            vec& solve(adfunc dnf_dtn, const vec& y0) override;
+            vec& solve(sysfunc dydt, const vec& y0) override;
+            vec& solve(adsysfunc dydt, const vec& y0) override;
+            /**
+             * Solve a system without storing the solution
+             *
+             * @param output - called with the initial state and the state at every point of the grid of
+             *      time_step; the state is only valid during the call
+             * @return the state at the last point
+             */
+            virtual vec solve(sysfunc dydt, const vec& y0, const sink& output) = 0;
+
+        protected:
+            // Store the states at every point of the grid, or only their first components for the scalar form
+            vec& store(const sysfunc& dydt, const vec& y0, bool function_value);
     };
 
     class EulerExplicit : public Solver {
+        protected:
+            size_t scan_threads = 1;
         public:
             using Solver::Solver;
-            vec& solve(func dnf_dtn, const vec& y0);
+            vec& solve(func dnf_dtn, const vec& y0) override;
             vec& solve(adfunc dnf_dtn, const vec& y0) override;
+            vec& solve(sysfunc dydt, const vec& y0) override;
+            vec& solve(adsysfunc dydt, const vec& y0) override;
+            // Number of threads of solve_affine
+            void set_scan_threads(size_t);
+            /**
+             * Solve a linear system y' = A(t) y + b(t) over the domain, given the initial state
+             *
+             * The steps are the affine recurrence y(t+dt) = (I + dt*A(t)) y(t) + dt*b(t), the same steps
+             * as solve(sysfunc) takes up to round-off. With set_scan_threads above 1 it is evaluated by
+             * the parallel scan of affine_scan (Scan.h): the coefficients are then taken twice for most
+             * steps, from several threads at once.
+             * @param coefficients(t,A,b) - coefficients at t, safe to call concurrently with threads
+             * @param y0 - initial state at the lower limit
+             */
+            vec& solve_affine(affinefunc coefficients, const vec& y0);
     };
 
+    class JacobianProduct;
+    class Preconditioner;
+    class LinearSolver;
+    class MethodOfLines;
+
     class EulerImplicit : public Solver {
         protected:
             double threshold = 1e-4;
             const size_t max_iterations = 50;
-            struct DivergentException;
-            // Solve a non-linear equation using the Newton Method
-            vec NewtonSolve(adfunc dnf_dtn, const double t, const vec& x0);
+            Sparsity sparsity;
+            size_t jacobian_threads = 1;
+            // Newton-Krylov: size of the GMRES basis, 0 for the direct factorization of the Jacobian
+            size_t krylov_restart = 0;
+            double krylov_tolerance = 1e-8;
+            std::shared_ptr<Preconditioner> preconditioner;
+            // factorization of the Newton matrix, nullptr for AutomaticSolver
+            std::shared_ptr<LinearSolver> linear_solver;
+            struct DivergentException : public std::exception{
+                const char * what () const throw () override {
+                    return "The solution doesn't converge.";
+                }
+            };
+            /**
+             * Evaluate the system and its Jacobian at (t, y)
+             *
+             * @param dydt - output, f(t, y)
+             * @param J - output, Jacobian row by row, J[i*n + j] = df_i/dy_j, or its compressed values if
+             *      the integration has a sparsity pattern, see column_offsets; left alone if empty,
+             *      then only f is evaluated
+             */
+            typedef std::function<void(double t, const vec& y, vec& dydt, vec& J)> linearization;
+            /**
+             * Solve the non-linear equation x = x0 + dt*f(t, x) using the Newton Method
+             *
+             * @param dt - length of the implicit Euler step, time_step for the steps of the solver
+             * @param pattern - sparsity pattern of the Jacobian, passed on to the linear solver. Read
+             *      after every evaluation of f, which may change it.
+             * @param J - storage of the Jacobian in the layout of the pattern, reused between the steps
+             * @param solver - factorizes the Newton matrix in every iteration
+             */
+            vec NewtonSolve(const linearization& f, const double t, const vec& x0, double dt, const Sparsity& pattern,
+                            vec& J, LinearSolver& solver) const;
+            // Solve the same equation by GMRES with Jacobian-vector products only
+            vec NewtonKrylovSolve(JacobianProduct& f, const double t, const vec& x0);
+            // Solution at t of the step from y at the previous time
+            typedef std::function<vec(double t, const vec& y)> step_solver;
+            // Integrate, storing the first `stored` components of the state at every step
+            void integrate_steps(const step_solver& step, const vec& y0, size_t stored);
+            void integrate(const linearization& f, const vec& y0, size_t stored, const Sparsity& pattern = Sparsity());
+            // Integrate with the Jacobian in `jacobian_size` doubles, in the layout `solver` reads
+            virtual void integrate(const linearization& f, const vec& y0, size_t stored, const Sparsity& pattern,
+                                   LinearSolver& solver, size_t jacobian_size);
+            virtual void integrate(JacobianProduct& f, const vec& y0, size_t stored);
         public:
             using Solver::Solver;
+            using Solver::solve;
             // Check the current threshold for the Newton iterative solver
             double get_threshold();
             // Check the current threshold for the Newton iterative solver
             void set_threshold(double);
+            // Sparsity pattern of the Jacobian of systems, compresses the finite difference and adept
+            // Jacobians and factorizes large systems with a sparse LU
+            void set_sparsity(const Sparsity&);
+            // Number of threads evaluating the finite difference Jacobian of large systems
+            void set_jacobian_threads(size_t);
+            /**
+             * Solve the Newton iterations of the func, sysfunc, adfunc and adsysfunc overloads by
+             * restarted GMRES, without forming the Jacobian (Jacobian-free Newton-Krylov)
+             *
+             * The Jacobian-vector products come from directional differences for plain double
+             * functions and from the tangent-linear pass of the adept tape otherwise, see Krylov.h.
+             * @param restart - size of the Krylov basis, memory O(n*restart); 0 switches back to the
+             *      direct factorization of the Jacobian
+             * @param preconditioner - approximate inverse of I - dt*J, may be nullptr
+             * @param tolerance - relative residual of the linear solve in every Newton iteration
+             */
+            void set_newton_krylov(size_t restart, std::shared_ptr<Preconditioner> preconditioner = nullptr,
+                                   double tolerance = 1e-8);
+            /**
+             * Factorization of the Newton matrix in the direct Newton iterations, see LinearSolver.h
+             *
+             * @param solver - e.g. std::make_shared<CholeskySolver>(); nullptr for the default
+             *      AutomaticSolver, a sparse LU for large sparse patterns and a partial pivoting LU otherwise.
+             *      Held by the solver, so it must not be shared with another solve running concurrently.
+             */
+            void set_linear_solver(std::shared_ptr<LinearSolver> solver);
+            // The Jacobian is approximated by forward differences, see FiniteDifferenceJacobian
+            vec& solve(func dnf_dtn, const vec& y0) override;
+            vec& solve(sysfunc dydt, const vec& y0) override;
+            // The Jacobian is recorded on the adept tape
             vec& solve(adfunc dnf_dtn, const vec& y0) override;
+            vec& solve(adsysfunc dydt, const vec& y0) override;
+            /**
+             * Solve a system with a user-supplied Jacobian, without any automatic differentiation
+             *
+             * @param dydt(t,y,dydt) - system
+             * @param jacobian(t,y,J) - fills the non-zero entries of the Jacobian J[i*n + j] = df_i/dy_j,
+             *      J is zeroed before every call
+             * @param y0 - initial state at the lower limit
+             * Without NDEBUG the Jacobian is checked once against central differences at y0
+             * and std::invalid_argument is thrown if they don't match, see jacobian_error
+             */
+            vec& solve(sysfunc dydt, jacfunc jacobian, const vec& y0);
+            /**
+             * Solve the semi-discrete system of a 1D PDE, see MethodOfLines.h
+             *
+             * The Jacobian is taken by 2*radius + 1 finite differences, stored as band and factorized by
+             * a banded LU: O(m*radius) memory and O(m*radius^2) per Newton iteration for m points,
+             * independent of set_linear_solver and set_sparsity. With set_newton_krylov, GMRES with
+             * directional differences is used instead.
+             * @param u0 - values at the cell centres at the lower limit, e.g. from MethodOfLines::discretize
+             */
+            vec& solve(const MethodOfLines& pde, const vec& u0);
+            /**
+             * Solve a system given as function object templated on the scalar type, with forward-mode
+             * differentiation by Dual<double, N> instead of the adept tape
+             *
+             * @param dydt(t,y,dydt) - callable for T = Dual<double, N>, with t of type T and y, dydt of
+             *      type std::vector<T>, e.g. a generic lambda [](auto t, const auto& y, auto& dydt){...}
+             * @param y0 - initial state at the lower limit
+             * @tparam N - number of directions per evaluation; the Jacobian takes ceil(n/N) evaluations.
+             *      For large systems instantiate the function with adouble and use the adept overload.
+             */
+            template <size_t N = 8, typename Rhs>
+            vec& solve_dual(Rhs dydt, const vec& y0);
+            /**
+             * Solve a system given as function object templated on the scalar type, recorded once
+             * on a Tape and replayed for every Newton iteration
+             *
+             * @param dydt(t,y,dydt) - callable for T = TapeScalar, as for solve_dual
+             * @param y0 - initial state at the lower limit
+             * The function is only called again if a comparison or value() in it changes its outcome,
+             * so it must not depend on anything but its arguments. The sparsity pattern is found from
+             * the tape, set_sparsity isn't needed.
+             */
+            template <typename Rhs>
+            vec& solve_taped(Rhs dydt, const vec& y0);
     };
+
+    template <size_t N, typename Rhs>
+    vec& EulerImplicit::solve_dual(Rhs dydt, const vec& y0){
+        typedef Dual<double, N> dual;
+        std::vector<dual> y(y0.size()), f(y0.size());
+        const Sparsity pattern = sparsity;
+        const std::vector<size_t> offsets = column_offsets(pattern);
+        linearization forward = [dydt, y, f, pattern, offsets](double t, const vec& x, vec& fx, vec& J) mutable {
+            const size_t n = x.size();
+            if (J.empty()){
+                // values only
+                for (size_t j = 0; j < n; ++j){
+                    y[j] = dual(x[j]);
+                }
+                dydt(dual(t), y, f);
+            }
+            else{
+                // seed N columns of the Jacobian per evaluation
+                for (size_t first = 0; first < n; first += N){
+                    for (size_t j = 0; j < n; ++j){
+                        y[j] = (j >= first && j < first + N) ? dual(x[j], j - first) : dual(x[j]);
+                    }
+                    dydt(dual(t), y, f);
+                    const size_t columns = std::min(N, n - first);
+                    if (pattern.empty()){
+                        for (size_t i = 0; i < n; ++i){
+                            for (size_t k = 0; k < columns; ++k){
+                                J[i*n + first + k] = f[i].derivative(k);
+                            }
+                        }
+                        continue;
+                    }
+                    // compressed values of the seeded columns
+                    for (size_t k = 0; k < columns; ++k){
+                        const size_t j = first + k;
+                        for (size_t p = 0; p < pattern[j].size(); ++p){
+                            J[offsets[j] + p] = f[pattern[j][p]].derivative(k);
+                        }
+                    }
+                }
+            }
+            for (size_t i = 0; i < n; ++i){
+                fx[i] = f[i].value();
+            }
+        };
+        integrate(forward, y0, y0.size(), sparsity);
+        return result;
+    }
+
+    template <typename Rhs>
+    vec& EulerImplicit::solve_taped(Rhs dydt, const vec& y0){
+        // the first recording gives the pattern, and with it the size of the compressed Jacobian
+        Tape tape;
+        tape.record(dydt, limit_low, y0);
+        Sparsity pattern = tape.sparsity();
+        linearization replay = [dydt, &tape, &pattern](double t, const vec& x, vec& fx, vec& J){
+            if (!tape.forward(t, x)){
+                // the recording holds the values at (t, x)
+                tape.record(dydt, t, x);
+                pattern = tape.sparsity();
+            }
+            tape.values(fx);
+            if (!J.empty()){
+                // compressed by the pattern of the recording, J takes its size if it changed
+                tape.compressed_jacobian(J);
+                // an empty J only asks for the values, keep an unused one for a Jacobian without entries
+                if (J.empty()){
+                    J.push_back(0.);
+                }
+            }
+        };
+        integrate(replay, y0, y0.size(), pattern);
+        return result;
+    }
 }
 
 #endif /*ORANGE_DRUM_EXPLORER_SOLVER_H*/
\ No newline at end of file
@@ -0,0 +1,366 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include "Tape.h"
+#include "FiniteDifference.h"
+#include "Trace.h"
+
+namespace OrangeDrumExplorer{
+
+    namespace {
+        // Tape recording on this thread
+        thread_local Tape* active = nullptr;
+
+        Tape* recording_tape(){
+            if (active == nullptr){
+                throw std::logic_error("TapeScalar used outside of Tape::record");
+            }
+            return active;
+        }
+
+        inline double apply(Tape::Op op, double a, double b, double constant){
+            switch (op){
+                case Tape::Op::input:
+                case Tape::Op::constant: return constant;
+                case Tape::Op::add: return a + b;
+                case Tape::Op::sub: return a - b;
+                case Tape::Op::mul: return a*b;
+                case Tape::Op::div: return a/b;
+                case Tape::Op::neg: return -a;
+                case Tape::Op::sqrt: return std::sqrt(a);
+                case Tape::Op::exp: return std::exp(a);
+                case Tape::Op::log: return std::log(a);
+                case Tape::Op::sin: return std::sin(a);
+                case Tape::Op::cos: return std::cos(a);
+                case Tape::Op::tan: return std::tan(a);
+                case Tape::Op::atan: return std::atan(a);
+                case Tape::Op::sinh: return std::sinh(a);
+                case Tape::Op::cosh: return std::cosh(a);
+                case Tape::Op::tanh: return std::tanh(a);
+                case Tape::Op::abs: return std::abs(a);
+                case Tape::Op::pow: return std::pow(a, b);
+            }
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+
+        inline bool holds(const Tape::Guard& g, double a, double b){
+            switch (g.compare){
+                case Tape::Compare::less: return (a < b) == (g.recorded != 0.);
+                case Tape::Compare::less_equal: return (a <= b) == (g.recorded != 0.);
+                case Tape::Compare::equal: return (a == b) == (g.recorded != 0.);
+                case Tape::Compare::not_equal: return (a != b) == (g.recorded != 0.);
+                case Tape::Compare::value: return a == g.recorded;
+            }
+            return false;
+        }
+
+        // out[l] = op(a[l], b[l]) for all lanes, one loop per operation so that it vectorizes
+        template <typename Operation>
+        inline void lanewise(double* out, const double* a, const double* b, size_t lanes, Operation op){
+            for (size_t l = 0; l < lanes; ++l){
+                out[l] = op(a[l], b[l]);
+            }
+        }
+    }
+
+// -------- TapeScalar ----------------
+
+    TapeScalar::TapeScalar(double constant)
+        : index(recording_tape()->push(Tape::Op::constant, 0, 0, constant))
+    {}
+
+    TapeScalar TapeScalar::unary(Tape::Op op, const TapeScalar& a){
+        return TapeScalar(recording_tape()->push(op, a.index, a.index), true);
+    }
+
+    TapeScalar TapeScalar::binary(Tape::Op op, const TapeScalar& a, const TapeScalar& b){
+        return TapeScalar(recording_tape()->push(op, a.index, b.index), true);
+    }
+
+    bool TapeScalar::compare(Tape::Compare compare, const TapeScalar& a, const TapeScalar& b){
+        return recording_tape()->guard(compare, a.index, b.index);
+    }
+
+    double TapeScalar::observe(const TapeScalar& a){
+        Tape* tape = recording_tape();
+        tape->guard(Tape::Compare::value, a.index, a.index);
+        return tape->val[a.index];
+    }
+
+// -------- Tape: recording ----------------
+
+    void Tape::begin(){
+        if (active != nullptr){
+            throw std::logic_error("Another tape is already recording on this thread");
+        }
+        nodes.clear();
+        guards.clear();
+        outputs.clear();
+        val.clear();
+        n_inputs = 0;
+        analysed = false;
+        ++n_recordings;
+        active = this;
+    }
+
+    TapeScalar Tape::input(double value){
+        ++n_inputs;
+        return TapeScalar(push(Op::input, 0, 0, value), true);
+    }
+
+    void Tape::end(const std::vector<TapeScalar>& f){
+        for (const TapeScalar& fi : f){
+            outputs.push_back(fi.index);
+        }
+        active = nullptr;
+    }
+
+    void Tape::abort(){
+        nodes.clear();
+        guards.clear();
+        outputs.clear();
+        val.clear();
+        n_inputs = 0;
+        analysed = false;
+        active = nullptr;
+    }
+
+    uint32_t Tape::push(Op op, uint32_t a, uint32_t b, double constant){
+        if (nodes.size() >= std::numeric_limits<uint32_t>::max()){
+            throw std::length_error("Tape has too many instructions");
+        }
+        nodes.push_back({op, a, b, constant});
+        val.push_back(apply(op, val.empty() ? 0. : val[a], val.empty() ? 0. : val[b], constant));
+        return static_cast<uint32_t>(nodes.size() - 1);
+    }
+
+    bool Tape::guard(Compare compare, uint32_t a, uint32_t b){
+        Guard g{compare, a, b, 1.};
+        if (compare == Compare::value){
+            g.recorded = val[a];
+        }
+        else if (!holds(g, val[a], val[b])){
+            g.recorded = 0.;
+        }
+        guards.push_back(g);
+        return g.recorded != 0.;
+    }
+
+// -------- Tape: replay ----------------
+
+    bool Tape::empty() const {
+        return nodes.empty();
+    }
+
+    size_t Tape::size() const {
+        return nodes.size();
+    }
+
+    size_t Tape::recordings() const {
+        return n_recordings;
+    }
+
+    bool Tape::forward(double t, const std::vector<double>& y){
+        if (y.size() + 1 != n_inputs){
+            throw std::invalid_argument("Number of inputs differs from the recording");
+        }
+        val[0] = t;
+        std::copy(y.begin(), y.end(), val.begin() + 1);
+        const size_t n = nodes.size();
+        for (size_t k = n_inputs; k < n; ++k){
+            const Node& node = nodes[k];
+            val[k] = apply(node.op, val[node.a], val[node.b], node.constant);
+        }
+        for (const Guard& g : guards){
+            if (!holds(g, val[g.a], val[g.b])){
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void Tape::values(std::vector<double>& f) const {
+        f.resize(outputs.size());
+        for (size_t i = 0; i < outputs.size(); ++i){
+            f[i] = val[outputs[i]];
+        }
+    }
+
+    const std::vector<std::vector<size_t>>& Tape::sparsity(){
+        if (!analysed){
+            analyse();
+        }
+        return pattern;
+    }
+
+    void Tape::analyse(){
+        const size_t m = outputs.size();
+        const size_t n = n_inputs - 1;
+        std::vector<char> reached(nodes.size());
+        row_columns.assign(m, {});
+        pattern.assign(n, {});
+        for (size_t i = 0; i < m; ++i){
+            const size_t last = outputs[i];
+            std::fill(reached.begin(), reached.begin() + last + 1, 0);
+            reached[last] = 1;
+            for (size_t k = last + 1; k-- > 0;){
+                if (!reached[k]){
+                    continue;
+                }
+                if (k < n_inputs){
+                    // input 0 is t
+                    if (k > 0){
+                        row_columns[i].push_back(k - 1);
+                    }
+                    continue;
+                }
+                const Node& node = nodes[k];
+                if (node.op != Op::constant){
+                    reached[node.a] = 1;
+                    reached[node.b] = 1;
+                }
+            }
+            std::reverse(row_columns[i].begin(), row_columns[i].end());
+            for (size_t j : row_columns[i]){
+                pattern[j].push_back(i);
+            }
+        }
+        // the rows were added to the columns in increasing order
+        std::vector<size_t> next = column_offsets(pattern);
+        n_values = next.back();
+        row_positions.assign(m, {});
+        for (size_t i = 0; i < m; ++i){
+            for (size_t j : row_columns[i]){
+                row_positions[i].push_back(next[j]++);
+            }
+        }
+        // rows without common columns are the columns of the transposed Jacobian without common rows
+        row_groups = column_groups(row_columns, m);
+        analysed = true;
+    }
+
+    void Tape::jacobian(std::vector<double>& J, bool clear){
+        ODE_TRACE_SCOPE("tape_jacobian");
+        if (!analysed){
+            analyse();
+        }
+        const size_t n = n_inputs - 1;
+        if (clear || J.size() != outputs.size()*n){
+            J.assign(outputs.size()*n, 0.);
+        }
+        sweep(J, false);
+    }
+
+    void Tape::compressed_jacobian(std::vector<double>& values){
+        ODE_TRACE_SCOPE("tape_jacobian");
+        if (!analysed){
+            analyse();
+        }
+        // every value is written, nothing to clear
+        values.resize(n_values);
+        sweep(values, true);
+    }
+
+    void Tape::sweep(std::vector<double>& J, bool compressed){
+        const size_t n = n_inputs - 1;
+        adjoint.resize(nodes.size());
+        for (const auto& group : row_groups){
+            // one reverse sweep from all outputs of the group, only the instructions before them contribute
+            size_t last = 0;
+            for (size_t i : group){
+                last = std::max<size_t>(last, outputs[i]);
+            }
+            std::fill(adjoint.begin(), adjoint.begin() + last + 1, 0.);
+            for (size_t i : group){
+                adjoint[outputs[i]] += 1.;
+            }
+            for (size_t k = last + 1; k-- > n_inputs;){
+                const double w = adjoint[k];
+                if (w == 0.){
+                    continue;
+                }
+                const Node& node = nodes[k];
+                const double a = val[node.a];
+                const double b = val[node.b];
+                switch (node.op){
+                    case Op::input:
+                    case Op::constant: break;
+                    case Op::add: adjoint[node.a] += w; adjoint[node.b] += w; break;
+                    case Op::sub: adjoint[node.a] += w; adjoint[node.b] -= w; break;
+                    case Op::mul: adjoint[node.a] += w*b; adjoint[node.b] += w*a; break;
+                    case Op::div:
+                        adjoint[node.a] += w/b;
+                        adjoint[node.b] -= w*val[k]/b;
+                        break;
+                    case Op::neg: adjoint[node.a] -= w; break;
+                    case Op::sqrt: adjoint[node.a] += w*0.5/val[k]; break;
+                    case Op::exp: adjoint[node.a] += w*val[k]; break;
+                    case Op::log: adjoint[node.a] += w/a; break;
+                    case Op::sin: adjoint[node.a] += w*std::cos(a); break;
+                    case Op::cos: adjoint[node.a] -= w*std::sin(a); break;
+                    case Op::tan: adjoint[node.a] += w*(1. + val[k]*val[k]); break;
+                    case Op::atan: adjoint[node.a] += w/(1. + a*a); break;
+                    case Op::sinh: adjoint[node.a] += w*std::cosh(a); break;
+                    case Op::cosh: adjoint[node.a] += w*std::sinh(a); break;
+                    case Op::tanh: adjoint[node.a] += w*(1. - val[k]*val[k]); break;
+                    case Op::abs: adjoint[node.a] += a < 0. ? -w : w; break;
+                    case Op::pow:
+                        adjoint[node.a] += w*b*std::pow(a, b - 1.);
+                        // the exponent is usually a constant, its derivative only exists for a > 0
+                        if (a > 0.){
+                            adjoint[node.b] += w*val[k]*std::log(a);
+                        }
+                        break;
+                }
+            }
+            // the rows of a group have distinct columns
+            for (size_t i : group){
+                for (size_t k = 0; k < row_columns[i].size(); ++k){
+                    const size_t j = row_columns[i][k];
+                    J[compressed ? row_positions[i][k] : i*n + j] = adjoint[j + 1];
+                }
+            }
+        }
+    }
+
+    bool Tape::forward_lanes(const double* t, const double* y, double* f, size_t lanes){
+        const size_t n = nodes.size();
+        lane_val.resize(n*lanes);
+        double* v = lane_val.data();
+        std::copy(t, t + lanes, v);
+        std::copy(y, y + (n_inputs - 1)*lanes, v + lanes);
+        for (size_t k = n_inputs; k < n; ++k){
+            const Node& node = nodes[k];
+            double* out = v + k*lanes;
+            const double* a = v + node.a*lanes;
+            const double* b = v + node.b*lanes;
+            switch (node.op){
+                case Op::input:
+                case Op::constant: std::fill(out, out + lanes, node.constant); break;
+                case Op::add: lanewise(out, a, b, lanes, [](double x, double z){ return x + z; }); break;
+                case Op::sub: lanewise(out, a, b, lanes, [](double x, double z){ return x - z; }); break;
+                case Op::mul: lanewise(out, a, b, lanes, [](double x, double z){ return x*z; }); break;
+                case Op::div: lanewise(out, a, b, lanes, [](double x, double z){ return x/z; }); break;
+                case Op::neg: lanewise(out, a, b, lanes, [](double x, double){ return -x; }); break;
+                default:
+                    for (size_t l = 0; l < lanes; ++l){
+                        out[l] = apply(node.op, a[l], b[l], node.constant);
+                    }
+            }
+        }
+        for (const Guard& g : guards){
+            for (size_t l = 0; l < lanes; ++l){
+                if (!holds(g, v[g.a*lanes + l], v[g.b*lanes + l])){
+                    return false;
+                }
+            }
+        }
+        for (size_t i = 0; i < outputs.size(); ++i){
+            std::copy(v + outputs[i]*lanes, v + (outputs[i] + 1)*lanes, f + i*lanes);
+        }
+        return true;
+    }
+
+}
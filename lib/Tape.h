@@ -0,0 +1,199 @@
+#ifndef ORANGE_DRUM_EXPLORER_TAPE_H
+#define ORANGE_DRUM_EXPLORER_TAPE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace OrangeDrumExplorer
+{
+    class TapeScalar;
+
+    /**
+     * Record-once, replay-many tape of a system f(t, y, dydt).\n
+     *
+     * The system, templated on the scalar type, is recorded once with TapeScalar into a flat
+     * array of instructions. A replay evaluates the values for new inputs by walking the array,
+     * without calling the function; the Jacobian follows by reverse sweeps over the array.
+     * The comparisons made while recording are checked on every replay; if a branch changes,
+     * forward() returns false and the function has to be recorded again at the new inputs.
+     * forward_lanes() evaluates the same instructions for an ensemble of inputs, with the
+     * innermost loop over the lanes.
+     */
+    class Tape
+    {
+        public:
+            enum class Op : uint8_t {
+                input, constant, add, sub, mul, div, neg, sqrt, exp, log,
+                sin, cos, tan, atan, sinh, cosh, tanh, abs, pow
+            };
+            enum class Compare : uint8_t { less, less_equal, equal, not_equal, value };
+            // Instruction, its result is stored at its own index
+            struct Node {
+                Op op;
+                uint32_t a;
+                uint32_t b;
+                double constant;
+            };
+            // Comparison made while recording, with its outcome or, for Compare::value, the value of a
+            struct Guard {
+                Compare compare;
+                uint32_t a;
+                uint32_t b;
+                double recorded;
+            };
+
+            // Record dydt(t, y, f) at the given inputs, the values of the recording are kept
+            template <typename Rhs>
+            void record(const Rhs& dydt, double t, const std::vector<double>& y);
+            // Evaluate the values for new inputs, false if a recorded branch isn't taken
+            bool forward(double t, const std::vector<double>& y);
+            // Values of the outputs at the last recording or forward
+            void values(std::vector<double>& f) const;
+            /**
+             * Jacobian of the outputs by y at the last recording or forward, row by row (J[i*n + j])
+             *
+             * Rows without common columns in sparsity() are taken together by one reverse sweep.
+             * @param clear - zero the entries outside sparsity(), may be skipped if J holds a
+             *      Jacobian of the same recording
+             */
+            void jacobian(std::vector<double>& J, bool clear = true);
+            // The same Jacobian compressed, column by column in the order of sparsity(), see column_offsets
+            void compressed_jacobian(std::vector<double>& values);
+            /**
+             * Sparsity pattern of the Jacobian, for every column the rows depending on it
+             *
+             * Follows the dependencies of the recorded instructions, so it holds for the recorded
+             * branches at any input. Found once per recording.
+             */
+            const std::vector<std::vector<size_t>>& sparsity();
+            /**
+             * Evaluate the outputs for `lanes` inputs at once
+             *
+             * @param t - one value of t per lane
+             * @param y - inputs, y[j*lanes + l] is component j of lane l
+             * @param f - outputs, f[i*lanes + l]
+             * @return false if a recorded branch isn't taken in some lane, f is then incomplete
+             */
+            bool forward_lanes(const double* t, const double* y, double* f, size_t lanes);
+
+            bool empty() const;
+            // Number of recorded instructions
+            size_t size() const;
+            // Number of recordings since construction
+            size_t recordings() const;
+
+        private:
+            std::vector<Node> nodes;
+            std::vector<Guard> guards;
+            std::vector<uint32_t> outputs;
+            size_t n_inputs = 0;
+            size_t n_recordings = 0;
+            std::vector<double> val;
+            std::vector<double> adjoint;
+            std::vector<double> lane_val;
+            // dependencies of the recording, empty until analysed
+            std::vector<std::vector<size_t>> pattern;
+            std::vector<std::vector<size_t>> row_columns;
+            // position of the entries of every row in the compressed Jacobian
+            std::vector<std::vector<size_t>> row_positions;
+            size_t n_values = 0;
+            std::vector<std::vector<size_t>> row_groups;
+            bool analysed = false;
+
+            void begin();
+            TapeScalar input(double value);
+            void end(const std::vector<TapeScalar>& f);
+            void abort();
+            uint32_t push(Op op, uint32_t a, uint32_t b, double constant = 0.);
+            bool guard(Compare compare, uint32_t a, uint32_t b);
+            void analyse();
+            // Reverse sweeps into the dense or the compressed Jacobian
+            void sweep(std::vector<double>& J, bool compressed);
+
+            friend class TapeScalar;
+    };
+
+    /**
+     * Scalar type recording the operations of a function into the active Tape.\n
+     *
+     * Only valid while Tape::record runs. Comparisons and value() are recorded as guards of the
+     * tape. The operators and math functions are found by argument dependent lookup, so call
+     * them unqualified (sin(x), not std::sin(x)).
+     */
+    class TapeScalar
+    {
+        public:
+            uint32_t index;
+
+            // Constant, recorded on the active tape
+            TapeScalar(double constant = 0.);
+
+            TapeScalar& operator+= (const TapeScalar& b){ return *this = binary(Tape::Op::add, *this, b); }
+            TapeScalar& operator-= (const TapeScalar& b){ return *this = binary(Tape::Op::sub, *this, b); }
+            TapeScalar& operator*= (const TapeScalar& b){ return *this = binary(Tape::Op::mul, *this, b); }
+            TapeScalar& operator/= (const TapeScalar& b){ return *this = binary(Tape::Op::div, *this, b); }
+
+            friend TapeScalar operator+ (const TapeScalar& a){ return a; }
+            friend TapeScalar operator- (const TapeScalar& a){ return unary(Tape::Op::neg, a); }
+            friend TapeScalar operator+ (const TapeScalar& a, const TapeScalar& b){ return binary(Tape::Op::add, a, b); }
+            friend TapeScalar operator- (const TapeScalar& a, const TapeScalar& b){ return binary(Tape::Op::sub, a, b); }
+            friend TapeScalar operator* (const TapeScalar& a, const TapeScalar& b){ return binary(Tape::Op::mul, a, b); }
+            friend TapeScalar operator/ (const TapeScalar& a, const TapeScalar& b){ return binary(Tape::Op::div, a, b); }
+
+            // Comparisons act on the recorded values and are checked again on replay
+            friend bool operator< (const TapeScalar& a, const TapeScalar& b){ return compare(Tape::Compare::less, a, b); }
+            friend bool operator> (const TapeScalar& a, const TapeScalar& b){ return compare(Tape::Compare::less, b, a); }
+            friend bool operator<= (const TapeScalar& a, const TapeScalar& b){ return compare(Tape::Compare::less_equal, a, b); }
+            friend bool operator>= (const TapeScalar& a, const TapeScalar& b){ return compare(Tape::Compare::less_equal, b, a); }
+            friend bool operator== (const TapeScalar& a, const TapeScalar& b){ return compare(Tape::Compare::equal, a, b); }
+            friend bool operator!= (const TapeScalar& a, const TapeScalar& b){ return compare(Tape::Compare::not_equal, a, b); }
+
+            friend TapeScalar sqrt(const TapeScalar& a){ return unary(Tape::Op::sqrt, a); }
+            friend TapeScalar exp(const TapeScalar& a){ return unary(Tape::Op::exp, a); }
+            friend TapeScalar log(const TapeScalar& a){ return unary(Tape::Op::log, a); }
+            friend TapeScalar sin(const TapeScalar& a){ return unary(Tape::Op::sin, a); }
+            friend TapeScalar cos(const TapeScalar& a){ return unary(Tape::Op::cos, a); }
+            friend TapeScalar tan(const TapeScalar& a){ return unary(Tape::Op::tan, a); }
+            friend TapeScalar atan(const TapeScalar& a){ return unary(Tape::Op::atan, a); }
+            friend TapeScalar sinh(const TapeScalar& a){ return unary(Tape::Op::sinh, a); }
+            friend TapeScalar cosh(const TapeScalar& a){ return unary(Tape::Op::cosh, a); }
+            friend TapeScalar tanh(const TapeScalar& a){ return unary(Tape::Op::tanh, a); }
+            friend TapeScalar abs(const TapeScalar& a){ return unary(Tape::Op::abs, a); }
+            friend TapeScalar fabs(const TapeScalar& a){ return unary(Tape::Op::abs, a); }
+            friend TapeScalar pow(const TapeScalar& a, const TapeScalar& b){ return binary(Tape::Op::pow, a, b); }
+            // Value while recording; a replay giving another value records the function again
+            friend double value(const TapeScalar& a){ return observe(a); }
+
+        private:
+            explicit TapeScalar(uint32_t node, bool) : index(node) {}
+            static TapeScalar unary(Tape::Op op, const TapeScalar& a);
+            static TapeScalar binary(Tape::Op op, const TapeScalar& a, const TapeScalar& b);
+            static bool compare(Tape::Compare compare, const TapeScalar& a, const TapeScalar& b);
+            static double observe(const TapeScalar& a);
+
+            friend class Tape;
+    };
+
+    template <typename Rhs>
+    void Tape::record(const Rhs& dydt, double t, const std::vector<double>& y){
+        begin();
+        try{
+            TapeScalar ts = input(t);
+            std::vector<TapeScalar> ys;
+            ys.reserve(y.size());
+            for (double v : y){
+                ys.push_back(input(v));
+            }
+            std::vector<TapeScalar> f(y.size());
+            dydt(ts, ys, f);
+            end(f);
+        }
+        catch (...){
+            abort();
+            throw;
+        }
+    }
+}
+
+#endif /*ORANGE_DRUM_EXPLORER_TAPE_H*/
@@ -0,0 +1,158 @@
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include "Trace.h"
+
+namespace OrangeDrumExplorer{
+namespace Trace{
+
+    namespace {
+        struct Event {
+            const char* name;
+            std::uint64_t begin;
+            std::uint64_t end;
+        };
+
+        // Single producer buffer: only the owning thread writes, the count is
+        // published with release semantics so the buffer can be read while its thread records
+        struct Buffer {
+            // left uninitialized, pages are only touched once events arrive
+            std::unique_ptr<Event[]> events;
+            const std::size_t capacity;
+            std::atomic<std::size_t> count{0};
+            std::atomic<std::size_t> dropped{0};
+            const std::size_t tid;
+            Buffer(std::size_t max_events, std::size_t id)
+                : events(new Event[max_events]), capacity(max_events), tid(id)
+            {}
+        };
+
+        struct Registry {
+            std::mutex mutex;
+            std::vector<std::unique_ptr<Buffer>> buffers;
+            std::size_t capacity = 1 << 20;
+        };
+
+        // Buffers outlive their threads so the timeline can be dumped after joining
+        Registry& registry(){
+            static Registry instance;
+            return instance;
+        }
+
+        Buffer* register_thread(){
+            Registry& reg = registry();
+            std::lock_guard<std::mutex> lock(reg.mutex);
+            reg.buffers.push_back(std::make_unique<Buffer>(reg.capacity, reg.buffers.size()));
+            return reg.buffers.back().get();
+        }
+
+        const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+        // Chrome trace timestamps are microseconds, keep the nanosecond resolution as decimals
+        void write_microseconds(std::ostream& out, std::uint64_t ns){
+            const char fraction[4] = {char('0' + ns%1000/100), char('0' + ns%100/10), char('0' + ns%10), 0};
+            out << ns/1000 << "." << fraction;
+        }
+
+        void write_escaped(std::ostream& out, const char* s){
+            for (; *s; ++s){
+                if (*s == '"' || *s == '\\'){
+                    out << '\\';
+                }
+                out << *s;
+            }
+        }
+    }
+
+    std::uint64_t now(){
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - epoch).count();
+    }
+
+    void record(const char* name, std::uint64_t begin, std::uint64_t end){
+        thread_local Buffer* buffer = register_thread();
+        const std::size_t i = buffer->count.load(std::memory_order_relaxed);
+        if (i >= buffer->capacity){
+            buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        buffer->events[i] = Event{name, begin, end};
+        buffer->count.store(i+1, std::memory_order_release);
+    }
+
+    void set_buffer_capacity(std::size_t capacity){
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        reg.capacity = capacity;
+    }
+
+    std::size_t size(){
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        std::size_t total = 0;
+        for (auto& buffer : reg.buffers){
+            total += buffer->count.load(std::memory_order_acquire);
+        }
+        return total;
+    }
+
+    std::size_t dropped(){
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        std::size_t total = 0;
+        for (auto& buffer : reg.buffers){
+            total += buffer->dropped.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    void clear(){
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        for (auto& buffer : reg.buffers){
+            buffer->count.store(0, std::memory_order_release);
+            buffer->dropped.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void write_chrome_json(std::ostream& out){
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+        bool first = true;
+        for (auto& buffer : reg.buffers){
+            out << (first ? "" : ",") << std::endl
+                << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->tid
+                << ",\"args\":{\"name\":\"solver thread " << buffer->tid << "\"}}";
+            first = false;
+            const std::size_t count = buffer->count.load(std::memory_order_acquire);
+            for (std::size_t i = 0; i < count; ++i){
+                const Event& e = buffer->events[i];
+                out << "," << std::endl << "{\"name\":\"";
+                write_escaped(out, e.name);
+                out << "\",\"cat\":\"solver\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->tid
+                    << ",\"ts\":";
+                write_microseconds(out, e.begin);
+                out << ",\"dur\":";
+                write_microseconds(out, e.end - e.begin);
+                out << "}";
+            }
+        }
+        out << std::endl << "]}" << std::endl;
+    }
+
+    void save(const std::string& filename){
+        std::ofstream out(filename);
+        if (!out.is_open()){
+            throw std::invalid_argument("Couldn't open trace file " + filename);
+        }
+        write_chrome_json(out);
+    }
+
+}
+}
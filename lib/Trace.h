@@ -0,0 +1,73 @@
+#ifndef ORANGE_DRUM_EXPLORER_TRACE_H
+#define ORANGE_DRUM_EXPLORER_TRACE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <ostream>
+#include <string>
+
+namespace OrangeDrumExplorer
+{
+    /**
+     * Timeline tracing of the solver phases.\n
+     *
+     * Every thread records completed scopes into its own fixed-size buffer,
+     * so recording never takes a lock. The buffers of all threads can be
+     * dumped as Chrome trace JSON, which can be opened in chrome://tracing
+     * or https://ui.perfetto.dev
+     *
+     * The ODE_TRACE_* macros are only compiled in if ORANGE_DRUM_EXPLORER_TRACE
+     * is defined (CMake option ODE_ENABLE_TRACING), otherwise they expand to nothing.
+     */
+    namespace Trace
+    {
+        // Nanoseconds since the first use of the trace clock
+        std::uint64_t now();
+        // Store a completed event in the buffer of the calling thread
+        void record(const char* name, std::uint64_t begin, std::uint64_t end);
+        // Set the number of events each thread can store. Applies to threads which haven't recorded yet.
+        void set_buffer_capacity(std::size_t);
+        // Number of events currently stored over all threads
+        std::size_t size();
+        // Number of events which didn't fit into the buffers
+        std::size_t dropped();
+        // Forget all stored events. Must not be called while other threads are recording.
+        void clear();
+        // Write all stored events as Chrome trace JSON
+        void write_chrome_json(std::ostream&);
+        // Write all stored events as Chrome trace JSON to a file
+        void save(const std::string& filename);
+
+        // Records the lifetime of the object as one event
+        class Scope
+        {
+            private:
+                const char* name;
+                std::uint64_t begin;
+            public:
+                explicit Scope(const char* scope_name)
+                    : name(scope_name), begin(now())
+                {}
+                ~Scope(){
+                    record(name, begin, now());
+                }
+                Scope(const Scope&) = delete;
+                Scope& operator=(const Scope&) = delete;
+        };
+    }
+}
+
+#ifdef ORANGE_DRUM_EXPLORER_TRACE
+#define ODE_TRACE_CONCAT_IMPL(a, b) a##b
+#define ODE_TRACE_CONCAT(a, b) ODE_TRACE_CONCAT_IMPL(a, b)
+// Trace the enclosing scope under the given (string literal) name
+#define ODE_TRACE_SCOPE(name) \
+    ::OrangeDrumExplorer::Trace::Scope ODE_TRACE_CONCAT(ode_trace_scope_, __LINE__)(name)
+// Dump the recorded timeline to a file
+#define ODE_TRACE_SAVE(filename) ::OrangeDrumExplorer::Trace::save(filename)
+#else
+#define ODE_TRACE_SCOPE(name)
+#define ODE_TRACE_SAVE(filename)
+#endif /*ORANGE_DRUM_EXPLORER_TRACE*/
+
+#endif /*ORANGE_DRUM_EXPLORER_TRACE_H*/
@@ -0,0 +1,114 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <cassert>
+#include <stdexcept>
+#include "Solver.h"
+#include "Adams.h"
+#include "test_problems.h"
+
+typedef OrangeDrumExplorer::vec vec;
+typedef OrangeDrumExplorer::AdamsPECE AdamsPECE;
+
+void test_tolerance(){
+    // the error follows the tolerance, with fewer evaluations for looser ones
+    double previous_error = 1.;
+    size_t previous_evaluations = 0;
+    for (double tolerance : {1e-4, 1e-7, 1e-10}){
+        AdamsPECE solver(0., 10.);
+        solver.set_tolerances(tolerance, tolerance);
+        const vec& y = solver.solve(_forced, {1.});
+        double error = 0.;
+        for (size_t i = 0; i < y.size(); ++i){
+            error = std::max(error, std::abs(y[i] - _forced_solution(0.1*i)));
+        }
+        const AdamsPECE::Statistics statistics = solver.get_statistics();
+        assert((y.size() == 101 && "Solution on the grid of the time step"));
+        assert((error < 100.*tolerance && "Error follows the tolerance"));
+        assert((error < previous_error && statistics.evaluations > previous_evaluations && "Tighter tolerance"));
+        assert((statistics.evaluations <= 2*(statistics.steps + statistics.rejected) + 16 && "PECE and the start"));
+        previous_error = error;
+        previous_evaluations = statistics.evaluations;
+    }
+}
+
+void test_efficiency(){
+    // harmonic oscillator over ten periods: the high orders take steps far longer than the grid
+    OrangeDrumExplorer::sysfunc f = [](double t, const vec& y, vec& dydt){dydt[0] = y[1]; dydt[1] = -y[0];};
+    const double T = 20.*M_PI;
+    AdamsPECE solver(0., T);
+    solver.set_time_step(T/1000);
+    solver.set_tolerances(1e-10, 1e-10);
+    const vec& y = solver.solve(f, {1., 0.});
+    for (size_t i = 0; i < y.size()/2; ++i){
+        assert((std::abs(y[2*i] - std::cos(i*T/1000)) < 1e-7 && "Interpolated between the steps"));
+    }
+    const AdamsPECE::Statistics statistics = solver.get_statistics();
+    assert((statistics.steps < 1000 && statistics.evaluations < 2000 && "Steps longer than the time step"));
+
+    // the first order takes many more steps for a loose tolerance
+    AdamsPECE first(0., T);
+    first.set_max_order(1);
+    first.set_tolerances(1e-4, 1e-4);
+    const vec& y_first = first.solve(f, {1., 0.});
+    assert((std::abs(y_first[200] - 1.) < 1e-2 && "First order"));
+    assert((first.get_statistics().steps > 5*statistics.steps && "First order takes small steps"));
+}
+
+void test_sink(){
+    OrangeDrumExplorer::sysfunc f = [](double t, const vec& y, vec& dydt){dydt[0] = y[1]; dydt[1] = -y[0];};
+    AdamsPECE stored(0., 1.), streamed(0., 1.);
+    const vec& y = stored.solve(f, {1., 0.});
+    size_t calls = 0;
+    bool matches = true;
+    const vec last = streamed.solve(f, {1., 0.}, [&](double t, const vec& state){
+        matches = matches && std::abs(t - 0.01*calls) < 1e-12
+                  && state[0] == y[2*calls] && state[1] == y[2*calls + 1];
+        ++calls;
+    });
+    assert((calls == 101 && matches && "Sink receives the stored states"));
+    assert((last[0] == y[200] && std::abs(last[0] - std::cos(1.)) < 1e-6 && "Last state is returned"));
+    assert((!streamed.check_solution_cache() && "Nothing is stored with a sink"));
+}
+
+void test_scalar(){
+    // y'' = -y as scalar form, plain and instrumented
+    OrangeDrumExplorer::func g = [](double t, const vec& y){return -y[0];};
+    OrangeDrumExplorer::adfunc adg = [](OrangeDrumExplorer::adouble t, const OrangeDrumExplorer::advec& y){return -y[0];};
+    AdamsPECE plain(0., 3.), instrumented(0., 3.);
+    const vec& y = plain.solve(g, {1., 0.});
+    const vec& ady = instrumented.solve(adg, {1., 0.});
+    assert((y.size() == 101 && ady.size() == 101 && "Scalar form stores the function value"));
+    for (size_t i = 0; i < y.size(); ++i){
+        assert((std::abs(y[i] - std::cos(0.03*i)) < 1e-5 && "Scalar form"));
+        assert((ady[i] == y[i] && "Instrumented functions give the same values"));
+    }
+}
+
+void test_arguments(){
+    AdamsPECE solver;
+    bool thrown = false;
+    try{
+        solver.set_max_order(0);
+    }
+    catch (std::invalid_argument&){
+        thrown = true;
+    }
+    assert((thrown && "Order 0 is rejected"));
+    thrown = false;
+    try{
+        solver.set_tolerances(1e-6, 0.);
+    }
+    catch (std::invalid_argument&){
+        thrown = true;
+    }
+    assert((thrown && "Absolute tolerance has to be positive"));
+}
+
+int main(int, char**) {
+    test_tolerance();
+    test_efficiency();
+    test_sink();
+    test_scalar();
+    test_arguments();
+}
@@ -0,0 +1,154 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <cassert>
+#include <stdexcept>
+#include "Solver.h"
+#include "AdditiveRK.h"
+#include "test_problems.h"
+
+typedef OrangeDrumExplorer::vec vec;
+typedef OrangeDrumExplorer::adouble adouble;
+typedef OrangeDrumExplorer::advec advec;
+typedef OrangeDrumExplorer::AdditiveRK AdditiveRK;
+
+// _forced split into the damping, implicit, and the forcing, explicit
+void _damping(adouble t, const advec& y, advec& dydt){
+    dydt[0] = -y[0];
+}
+
+void _forcing(double t, const vec& y, vec& dydt){
+    dydt[0] = std::cos(t);
+}
+
+// Prothero-Robinson y' = -lambda*(y - cos(t)) - sin(t) with y(0) = 2, y = cos(t) + exp(-lambda*t)
+const double lambda = 1e6;
+
+void _relaxation(adouble t, const advec& y, advec& dydt){
+    dydt[0] = -lambda*(y[0] - cos(t));
+}
+
+void _drift(double t, const vec& y, vec& dydt){
+    dydt[0] = -std::sin(t);
+}
+
+void test_order(){
+    for (const AdditiveRK::Tableau& tableau : {AdditiveRK::imex_euler(), AdditiveRK::ars222(), AdditiveRK::ars443(),
+                                               AdditiveRK::ark324()}){
+        auto error = [&tableau](double dt){
+            AdditiveRK solver(0., 1., tableau);
+            solver.set_time_step(dt);
+            const vec& y = solver.solve(OrangeDrumExplorer::adsysfunc(_damping), _forcing, {1.});
+            return std::abs(y.back() - _forced_solution(1.));
+        };
+        assert((_has_order(error, 0.1, tableau.order) && "Order of the pair"));
+    }
+}
+
+void test_stiff_part(){
+    // the stiff relaxation is implicit, so steps far above 1/lambda stay stable; ARS(4,4,3) ends the step
+    // on its last stage, so the stiff part isn't left with an undamped explicit error.
+    // Without the initial layer y = cos(t).
+    AdditiveRK solver(0., 1.);
+    solver.set_time_step(0.01);
+    const vec& y = solver.solve(OrangeDrumExplorer::adsysfunc(_relaxation), _drift, {1.});
+    for (size_t i = 0; i < y.size(); ++i){
+        assert((std::abs(y[i] - std::cos(0.01*i)) < 1e-6 && "Stiff relaxation at steps of 1e4/lambda"));
+    }
+    const AdditiveRK::Statistics statistics = solver.get_statistics();
+    assert((statistics.steps == 100 && statistics.jacobians == 100 && statistics.factorizations == 100
+            && "One Jacobian and one factorization per step"));
+    assert((statistics.nonstiff_evaluations == 4*100 && "The non-stiff part at the 4 weighted stages"));
+
+    // without the non-stiff part the implicit tableau alone
+    AdditiveRK stiff(0., 1.);
+    stiff.set_time_step(0.01);
+    const vec& z = stiff.solve(OrangeDrumExplorer::adsysfunc(_damping), {1.});
+    assert((std::abs(z.back() - std::exp(-1.)) < 1e-6 && stiff.get_statistics().nonstiff_evaluations == 0));
+}
+
+void test_scalar_form(){
+    // y'' = -100 y' + sin(y) - y, the lower derivative is part of the stiff companion system
+    OrangeDrumExplorer::adfunc stiff = [](adouble t, const advec& y) -> adouble { return -100.*y[1]; };
+    OrangeDrumExplorer::func nonstiff = [](double t, const vec& y){ return std::sin(y[0]) - y[0]; };
+    OrangeDrumExplorer::adsysfunc stiff_system = [](adouble t, const advec& y, advec& dydt){
+        dydt[0] = y[1];
+        dydt[1] = -100.*y[1];
+    };
+    OrangeDrumExplorer::sysfunc nonstiff_system = [](double t, const vec& y, vec& dydt){
+        dydt[0] = 0.;
+        dydt[1] = std::sin(y[0]) - y[0];
+    };
+    AdditiveRK scalar(0., 1.), system(0., 1.);
+    const vec& y = scalar.solve(stiff, nonstiff, {1., 0.});
+    const vec& ys = system.solve(stiff_system, nonstiff_system, {1., 0.});
+    assert((y.size() == 101 && ys.size() == 202 && "Function value and full state"));
+    for (size_t i = 0; i < y.size(); ++i){
+        assert((std::abs(y[i] - ys[2*i]) < 1e-12 && "Scalar form is the companion system"));
+    }
+}
+
+void test_step_control(){
+    // the error follows the tolerance, with more steps for tighter ones
+    double previous_error = 1.;
+    size_t previous_steps = 0;
+    for (double tolerance : {1e-3, 1e-5, 1e-7}){
+        AdditiveRK solver(0., 10., AdditiveRK::ark324());
+        solver.set_time_step(1.);
+        solver.set_tolerances(tolerance, tolerance);
+        const vec& y = solver.solve(OrangeDrumExplorer::adsysfunc(_damping), _forcing, {1.});
+        assert((y.size() == 11 && "Solution on the grid of the time step"));
+        double error = 0.;
+        for (size_t i = 0; i < y.size(); ++i){
+            error = std::max(error, std::abs(y[i] - _forced_solution(i)));
+        }
+        const AdditiveRK::Statistics statistics = solver.get_statistics();
+        assert((error < 10.*tolerance && "Error follows the tolerance"));
+        assert((error < previous_error && statistics.steps > previous_steps && "Tighter tolerance"));
+        previous_error = error;
+        previous_steps = statistics.steps;
+    }
+}
+
+void test_arguments(){
+    AdditiveRK solver(0., 1., AdditiveRK::ars222());
+    bool thrown = false;
+    solver.set_tolerances(1e-6, 1e-6);
+    try{
+        solver.solve(OrangeDrumExplorer::adsysfunc(_damping), _forcing, {1.});
+    }
+    catch (std::invalid_argument&){
+        thrown = true;
+    }
+    assert((thrown && "ARS(2,2,2) has no error estimate"));
+
+    thrown = false;
+    try{
+        AdditiveRK::Tableau varying = AdditiveRK::ark324();
+        varying.a_implicit[2][2] = 0.5;
+        solver.set_tableau(varying);
+    }
+    catch (std::invalid_argument&){
+        thrown = true;
+    }
+    assert((thrown && "The diagonal is a single gamma"));
+
+    thrown = false;
+    AdditiveRK krylov;
+    krylov.set_newton_krylov(10);
+    try{
+        krylov.solve(OrangeDrumExplorer::adsysfunc(_damping), _forcing, {1.});
+    }
+    catch (std::invalid_argument&){
+        thrown = true;
+    }
+    assert((thrown && "Newton-Krylov isn't supported"));
+}
+
+int main(int, char**) {
+    test_order();
+    test_stiff_part();
+    test_scalar_form();
+    test_step_control();
+    test_arguments();
+}
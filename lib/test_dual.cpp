@@ -0,0 +1,89 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <cassert>
+#include "Solver.h"
+#include "Dual.h"
+
+typedef OrangeDrumExplorer::Dual<double, 2> dual2;
+
+bool _close(double a, double b, double tolerance = 1e-12){
+    return std::abs(a - b) <= tolerance*std::max(1., std::abs(b));
+}
+
+void test_arithmetic(){
+    const dual2 x(1.5, 0);
+    const dual2 y(-0.5, 1);
+    dual2 z = 3*x*y - x/y + 2. - y;
+    // dz/dx = 3y - 1/y, dz/dy = 3x + x/y^2 - 1
+    assert((_close(z.value(), 3*1.5*-0.5 - 1.5/-0.5 + 2. + 0.5) && "Value of an arithmetic expression"));
+    assert((_close(z.derivative(0), 3*-0.5 + 2.) && "Derivative by the first direction"));
+    assert((_close(z.derivative(1), 3*1.5 + 1.5/0.25 - 1.) && "Derivative by the second direction"));
+    z = 1./x;
+    assert((_close(z.derivative(0), -1./(1.5*1.5)) && "Derivative of the reciprocal"));
+    assert((x > y && y < 0. && "Comparisons act on the value"));
+}
+
+void test_functions(){
+    const dual2 x(0.7, 0);
+    assert((_close(sin(x).derivative(0), std::cos(0.7)) && "Derivative of sin"));
+    assert((_close(cos(x).derivative(0), -std::sin(0.7)) && "Derivative of cos"));
+    assert((_close(exp(x).derivative(0), std::exp(0.7)) && "Derivative of exp"));
+    assert((_close(log(x).derivative(0), 1./0.7) && "Derivative of log"));
+    assert((_close(sqrt(x).derivative(0), 0.5/std::sqrt(0.7)) && "Derivative of sqrt"));
+    assert((_close(tanh(x).derivative(0), 1. - std::tanh(0.7)*std::tanh(0.7)) && "Derivative of tanh"));
+    assert((_close(pow(x, 3.).derivative(0), 3*0.7*0.7) && "Derivative of pow"));
+    assert((_close(pow(x, x).derivative(0), std::pow(0.7, 0.7)*(std::log(0.7) + 1.)) && "Derivative of x^x"));
+    // zero and negative bases
+    const dual2 zero(0., 0), negative(-2., 0);
+    assert((pow(zero, 0.5).value() == 0. && "Square root of zero"));
+    assert((pow(zero, 0.).value() == 1. && pow(zero, 0.).derivative(0) == 0. && "Zeroth power of zero"));
+    assert((pow(zero, 2.).value() == 0. && pow(zero, 2.).derivative(0) == 0. && "Square of zero"));
+    assert((_close(pow(negative, dual2(3.)).value(), -8.) && _close(pow(negative, dual2(3.)).derivative(0), 12.)
+            && "Negative base with a constant integer exponent"));
+    assert((_close(pow(negative, negative).value(), 0.25) && _close(pow(negative, negative).derivative(0), 0.25)
+            && "Negative base with an integer exponent depending on it"));
+    assert((_close(abs(-x).derivative(0), 1.) && "Derivative of abs"));
+    assert((x.derivative(1) == 0. && sin(x).derivative(1) == 0. && "Unseeded direction stays zero"));
+}
+
+// Van der Pol oscillator, templated on the scalar type
+struct VanDerPol {
+    template <typename T>
+    void operator()(const T& t, const std::vector<T>& y, std::vector<T>& dydt) const {
+        dydt[0] = y[1];
+        dydt[1] = 5.*(1. - y[0]*y[0])*y[1] - y[0];
+    }
+};
+
+// Coupled chain of 5 components, larger than the number of directions of a single pass
+struct Chain {
+    template <typename T>
+    void operator()(const T& t, const std::vector<T>& y, std::vector<T>& dydt) const {
+        const size_t n = y.size();
+        for (size_t i = 0; i < n; ++i){
+            dydt[i] = -2.*y[i] + sin(y[(i+1)%n]) + t;
+        }
+    }
+};
+
+template <size_t N, typename Rhs>
+void test_solve_equals_adept(Rhs rhs, const OrangeDrumExplorer::vec& y0, const char* message){
+    OrangeDrumExplorer::EulerImplicit tape(0., 2.);
+    OrangeDrumExplorer::EulerImplicit forward(0., 2.);
+    OrangeDrumExplorer::adsysfunc f = rhs;
+    OrangeDrumExplorer::vec expected = tape.solve(f, y0);
+    OrangeDrumExplorer::vec y1 = forward.solve_dual<N>(rhs, y0);
+    assert((y1.size() == expected.size() && forward.get_state_size() == y0.size() && "Dual solution stores the full state"));
+    for (size_t i = 0; i < y1.size(); ++i){
+        assert((_close(y1[i], expected[i], 1e-10) && message));
+    }
+}
+
+int main(int, char**) {
+    test_arithmetic();
+    test_functions();
+    test_solve_equals_adept<2>(VanDerPol(), {2., 0.}, "Dual Jacobian gives the adept solution");
+    test_solve_equals_adept<2>(Chain(), {1., 0., -1., 0.5, 2.}, "Jacobian in several passes gives the adept solution");
+    test_solve_equals_adept<8>(Chain(), {1., 0., -1., 0.5, 2.}, "Unused directions don't change the solution");
+}
@@ -0,0 +1,81 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <cassert>
+#include "Solver.h"
+#include "ExplicitRK.h"
+#include "test_problems.h"
+
+typedef OrangeDrumExplorer::vec vec;
+
+// Method declared by the user: the generic second-order method with alpha = 1/4
+constexpr OrangeDrumExplorer::ButcherTableau<2> quarter = {{{0., 0.}, {1./4., 0.}}, {-1., 2.}, {0., 1./4.}, 2};
+
+template <const auto& Tableau>
+void _check_order(){
+    auto error = [](double dt){
+        OrangeDrumExplorer::ExplicitRK<Tableau> solver(0., 2.);
+        solver.set_time_step(dt);
+        const vec& y = solver.solve(_forced, {1.});
+        return std::abs(y.back() - _forced_solution(2.));
+    };
+    assert((_has_order(error, 0.1, OrangeDrumExplorer::ExplicitRK<Tableau>::order) && "Observed order of the tableau"));
+}
+
+void test_order(){
+    namespace T = OrangeDrumExplorer::Tableaus;
+    _check_order<T::euler>();
+    _check_order<T::midpoint>();
+    _check_order<T::heun>();
+    _check_order<T::ralston>();
+    _check_order<T::kutta3>();
+    _check_order<T::ssprk3>();
+    _check_order<T::rk4>();
+    _check_order<T::rk38>();
+    _check_order<quarter>();
+}
+
+void test_euler(){
+    // the one-stage tableau is the explicit Euler method, to the last bit
+    OrangeDrumExplorer::sysfunc f = [](double t, const vec& y, vec& dydt){dydt[0] = y[1]; dydt[1] = t - y[0];};
+    OrangeDrumExplorer::ExplicitRK<OrangeDrumExplorer::Tableaus::euler> tableau(0., 1.);
+    OrangeDrumExplorer::EulerExplicit reference(0., 1.);
+    const vec& y = tableau.solve(f, {1., 0.});
+    const vec& expected = reference.solve(f, {1., 0.});
+    assert((y.size() == expected.size() && tableau.get_state_size() == 2 && "Full state is stored"));
+    for (size_t i = 0; i < y.size(); ++i){
+        assert((y[i] == expected[i] && "Euler tableau is the explicit Euler method"));
+    }
+}
+
+void test_interfaces(){
+    // y'' = -y in every form
+    OrangeDrumExplorer::ExplicitRK<OrangeDrumExplorer::Tableaus::rk4> solver(0., 3.);
+    const vec stored = solver.solve(OrangeDrumExplorer::func([](double t, const vec& y){return -y[0];}), {1., 0.});
+    const vec instrumented = solver.solve(OrangeDrumExplorer::adfunc([](OrangeDrumExplorer::adouble t,
+                                          const OrangeDrumExplorer::advec& y){return -y[0];}), {1., 0.});
+    const vec system = solver.solve(OrangeDrumExplorer::adsysfunc([](OrangeDrumExplorer::adouble t,
+                                    const OrangeDrumExplorer::advec& y, OrangeDrumExplorer::advec& dydt){
+                                        dydt[0] = y[1]; dydt[1] = -y[0];}), {1., 0.});
+    assert((stored.size() == 101 && instrumented.size() == 101 && system.size() == 202 && "Stored values"));
+    // any callable, inlined, into a sink
+    size_t calls = 0;
+    bool matches = true;
+    const vec last = solver.solve([](double t, const vec& y, vec& dydt){dydt[0] = y[1]; dydt[1] = -y[0];}, {1., 0.},
+                                  [&](double t, const vec& y){
+                                      matches = matches && y[0] == stored[calls] && std::abs(t - 0.03*calls) < 1e-12;
+                                      ++calls;
+                                  });
+    assert((calls == 101 && matches && "Sink receives every state"));
+    for (size_t i = 0; i < stored.size(); ++i){
+        assert((std::abs(stored[i] - std::cos(0.03*i)) < 1e-7 && "Harmonic oscillator"));
+        assert((instrumented[i] == stored[i] && system[2*i] == stored[i] && "Same values in every form"));
+    }
+    assert((last[0] == stored.back() && "Last state is returned"));
+}
+
+int main(int, char**) {
+    test_order();
+    test_euler();
+    test_interfaces();
+}
@@ -0,0 +1,213 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <cassert>
+#include <stdexcept>
+#include "Solver.h"
+#include "MethodOfLines.h"
+#include "Exponential.h"
+#include "test_problems.h"
+
+typedef OrangeDrumExplorer::vec vec;
+typedef OrangeDrumExplorer::adouble adouble;
+typedef OrangeDrumExplorer::advec advec;
+typedef OrangeDrumExplorer::Exponential Exponential;
+
+// y'' - y' + 3y = t with y(0) = 1, y'(0) = -2, the demo equation of main.cpp
+adouble _demo(adouble t, const advec& y){
+    return t + y[1] - 3.0*y[0];
+}
+
+double _demo_solution(double t){
+    const double omega = std::sqrt(11.)/2.;
+    return std::exp(t/2.)*(8./9.*std::cos(omega*t) - 25./(9.*omega)*std::sin(omega*t)) + t/3. + 1./9.;
+}
+
+// y' = -y^2 + cos(t) + (2 + sin(t))^2 with y(0) = 2, y = 2 + sin(t)
+void _quadratic(adouble t, const advec& y, advec& dydt){
+    dydt[0] = -y[0]*y[0] + cos(t) + (2. + sin(t))*(2. + sin(t));
+}
+
+// y' = -lambda*(y - cos(t)) - sin(t) - (y - cos(t))^2 with y(0) = 1, y = cos(t)
+const double lambda = 1e6;
+
+void _stiff(adouble t, const advec& y, advec& dydt){
+    dydt[0] = -lambda*(y[0] - cos(t)) - sin(t) - (y[0] - cos(t))*(y[0] - cos(t));
+}
+
+double _quadratic_error(Exponential::Method method, double dt){
+    Exponential solver(0., 1., method);
+    solver.set_time_step(dt);
+    const vec& y = solver.solve(OrangeDrumExplorer::adsysfunc(_quadratic), {2.});
+    return std::abs(y.back() - 2. - std::sin(1.));
+}
+
+void test_matrix_exponential(){
+    // rotations by small and large angles take the low degrees and the scaling and squaring
+    for (double angle : {1e-3, 0.5, 30.}){
+        vec E;
+        OrangeDrumExplorer::matrix_exponential({0., angle, -angle, 0.}, 2, E);
+        assert((std::abs(E[0] - std::cos(angle)) < 1e-13 && std::abs(E[1] - std::sin(angle)) < 1e-13
+                && std::abs(E[2] + std::sin(angle)) < 1e-13 && std::abs(E[3] - std::cos(angle)) < 1e-13
+                && "Rotation"));
+    }
+    // nilpotent and stiff
+    vec E;
+    OrangeDrumExplorer::matrix_exponential({0., 1., 0., 0.}, 2, E);
+    assert((E == vec{1., 1., 0., 1.} && "exp of a nilpotent matrix is its series"));
+    OrangeDrumExplorer::matrix_exponential({-1e4, 0., 0., 1.}, 2, E);
+    assert((std::abs(E[0]) < 1e-300 && std::abs(E[3] - std::exp(1.)) < 1e-12 && "Stiff diagonal"));
+}
+
+void test_linear(){
+    // the demo equation is linear with a forcing of degree 1, so every step is exact
+    Exponential solver(0., 4.);
+    solver.set_time_step(4./128);
+    const vec& y = solver.solve(_demo, {1., -2.});
+    for (size_t i = 0; i < y.size(); ++i){
+        assert((std::abs(y[i] - _demo_solution(i*4./128)) < 1e-12*std::max(1., std::abs(y[i])) && "Exact steps"));
+    }
+    const Exponential::Statistics statistics = solver.get_statistics();
+    assert((statistics.linear && statistics.steps == 128 && statistics.exponentials == 1 && "Linear fast path"));
+    assert((statistics.jacobians == 3 && statistics.evaluations == 1 + 4 + 1 + 2*128
+            && "Two evaluations per step after the detection"));
+
+    // steps of any size stay exact, also for a forcing of degree 2: y' = -y + t^2, y = t^2 - 2t + 2 - 2 exp(-t)
+    Exponential large(0., 10.);
+    large.set_time_step(2.5);
+    const vec& z = large.solve(OrangeDrumExplorer::adsysfunc([](adouble t, const advec& y, advec& dydt){
+        dydt[0] = -y[0] + t*t;
+    }), {0.});
+    assert((z.size() == 5 && std::abs(z.back() - (82. - 2.*std::exp(-10.))) < 1e-12*82. && "Quadratic forcing"));
+
+    // a stiff linear system with a smooth forcing: y' = -lambda*(y - cos(t)) - sin(t), y = cos(t)
+    Exponential stiff(0., 1.);
+    stiff.set_time_step(0.1);
+    const vec& u = stiff.solve(OrangeDrumExplorer::adsysfunc([](adouble t, const advec& y, advec& dydt){
+        dydt[0] = -lambda*(y[0] - cos(t)) - sin(t);
+    }), {1.});
+    for (size_t i = 0; i < u.size(); ++i){
+        assert((std::abs(u[i] - std::cos(0.1*i)) < 1e-9 && "Stiff forcing"));
+    }
+    assert((stiff.get_statistics().linear));
+}
+
+void test_detection(){
+    // non-linear in y, a Jacobian varying in t, and a piecewise affine f with a constant Jacobian
+    OrangeDrumExplorer::adsysfunc varying = [](adouble t, const advec& y, advec& dydt){ dydt[0] = -t*y[0]; };
+    OrangeDrumExplorer::adsysfunc piecewise = [](adouble t, const advec& y, advec& dydt){
+        dydt[0] = -y[0] + (y[0] > 1.1 ? 1. : 0.);
+    };
+    for (const OrangeDrumExplorer::adsysfunc& f : {OrangeDrumExplorer::adsysfunc(_quadratic), varying, piecewise}){
+        Exponential solver(0., 1.);
+        solver.solve(f, {1.});
+        assert((!solver.get_statistics().linear && "Non-linear system"));
+    }
+
+    // the declaration skips the detection, also for the approximate Jacobian of finite differences
+    OrangeDrumExplorer::sysfunc differences = [](double t, const vec& y, vec& dydt){ dydt[0] = -0.3*y[0] + t; };
+    Exponential declared(0., 1.), nonlinear(0., 1.);
+    declared.set_linearity(Exponential::Linearity::linear);
+    nonlinear.set_linearity(Exponential::Linearity::nonlinear);
+    const vec& y = declared.solve(differences, {1.});
+    const vec& z = nonlinear.solve(differences, {1.});
+    assert((declared.get_statistics().linear && !nonlinear.get_statistics().linear));
+    // y = (t - 1/0.3)/0.3 + (1 + 1/0.09) exp(-0.3 t)
+    const double solution = (1. - 1./0.3)/0.3 + (1. + 1./0.09)*std::exp(-0.3);
+    assert((std::abs(y.back() - solution) < 1e-6 && std::abs(z.back() - solution) < 1e-6));
+}
+
+void test_order(){
+    // a non-linear, non-autonomous problem
+    auto euler = [](double dt){ return _quadratic_error(Exponential::Method::rosenbrock_euler, dt); };
+    auto exprb32 = [](double dt){ return _quadratic_error(Exponential::Method::exprb32, dt); };
+    assert((_has_order(euler, 0.025, 2.) && "Exponential Rosenbrock-Euler of order 2"));
+    assert((_has_order(exprb32, 0.025, 3.) && "exprb32 of order 3"));
+}
+
+void test_stiff(){
+    // steps of 1e4/lambda without a linear solve
+    Exponential solver(0., 1.);
+    solver.set_time_step(0.01);
+    const vec& y = solver.solve(OrangeDrumExplorer::adsysfunc(_stiff), {1.});
+    for (size_t i = 0; i < y.size(); ++i){
+        assert((std::abs(y[i] - std::cos(0.01*i)) < 1e-8 && "Stiff semilinear problem"));
+    }
+    const Exponential::Statistics statistics = solver.get_statistics();
+    assert((!statistics.linear && statistics.steps == 100 && statistics.exponentials == 2*100));
+}
+
+void test_krylov(){
+    // heat equation with dt*|J| ~ 100: the Krylov approximation, with substeps where needed, agrees with the dense one
+    const size_t m = 50;
+    OrangeDrumExplorer::MethodOfLines pde(OrangeDrumExplorer::MethodOfLines::diffusion(1.), 1, m, 0., 1.,
+                                          OrangeDrumExplorer::MethodOfLines::Boundary::dirichlet(0.),
+                                          OrangeDrumExplorer::MethodOfLines::Boundary::dirichlet(0.));
+    const vec u0 = pde.discretize([](double x){ return std::sin(M_PI*x); });
+    for (Exponential::Method method : {Exponential::Method::rosenbrock_euler, Exponential::Method::exprb32}){
+        Exponential dense(0., 0.1, method), krylov(0., 0.1, method);
+        dense.set_time_step(0.01);
+        krylov.set_time_step(0.01);
+        dense.set_linearity(Exponential::Linearity::nonlinear);
+        krylov.set_newton_krylov(20);
+        const vec& u = dense.solve(pde.system(), u0);
+        const vec& v = krylov.solve(pde, u0);
+        for (size_t i = 0; i < m; ++i){
+            assert((std::abs(u[10*m + i] - v[10*m + i]) < 1e-7 && "Krylov and dense phi-functions"));
+            assert((std::abs(v[10*m + i] - std::exp(-M_PI*M_PI*0.1)*std::sin(M_PI*pde.x(i))) < 5e-4
+                    && "Heat equation"));
+        }
+        const Exponential::Statistics statistics = krylov.get_statistics();
+        assert((statistics.exponentials == 0 && statistics.products > 0 && statistics.steps == 10));
+    }
+}
+
+void test_interfaces(){
+    // the Jacobians of EulerImplicit linearize the steps
+    OrangeDrumExplorer::sysfunc f = [](double t, const vec& y, vec& dydt){
+        dydt[0] = y[1];
+        dydt[1] = -std::sin(y[0]);
+    };
+    OrangeDrumExplorer::jacfunc jacobian = [](double t, const vec& y, vec& J){
+        J[1] = 1.;
+        J[2] = -std::cos(y[0]);
+    };
+    OrangeDrumExplorer::adsysfunc adf = [](adouble t, const advec& y, advec& dydt){
+        dydt[0] = y[1];
+        dydt[1] = -sin(y[0]);
+    };
+    Exponential tape(0., 3.), analytic(0., 3.), dual(0., 3.);
+    const vec& y = tape.solve(adf, {1., 0.});
+    const vec& ay = analytic.solve(f, jacobian, {1., 0.});
+    const vec& dy = dual.solve_dual([](auto t, const auto& y, auto& dydt){
+        dydt[0] = y[1];
+        dydt[1] = -sin(y[0]);
+    }, {1., 0.});
+    for (size_t i = 0; i < y.size(); ++i){
+        assert((std::abs(ay[i] - y[i]) < 1e-12 && std::abs(dy[i] - y[i]) < 1e-12 && "Same steps with any Jacobian"));
+    }
+
+    // the banded Jacobian of the method of lines needs the Krylov approximation
+    OrangeDrumExplorer::MethodOfLines pde(OrangeDrumExplorer::MethodOfLines::diffusion(1.), 1, 20, 0., 1.,
+                                          OrangeDrumExplorer::MethodOfLines::Boundary::dirichlet(0.),
+                                          OrangeDrumExplorer::MethodOfLines::Boundary::dirichlet(0.));
+    bool thrown = false;
+    Exponential banded;
+    try{
+        banded.solve(pde, pde.discretize([](double x){ return std::sin(M_PI*x); }));
+    }
+    catch (std::invalid_argument&){
+        thrown = true;
+    }
+    assert((thrown && "Banded Jacobian"));
+}
+
+int main(int, char**) {
+    test_matrix_exponential();
+    test_linear();
+    test_detection();
+    test_order();
+    test_stiff();
+    test_krylov();
+    test_interfaces();
+}
@@ -0,0 +1,140 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <cassert>
+#include "Solver.h"
+#include "FiniteDifference.h"
+
+typedef OrangeDrumExplorer::vec vec;
+
+// Discrete reaction-diffusion on a line, the Jacobian is tridiagonal
+void _diffusion(double t, const vec& y, vec& dydt){
+    const size_t n = y.size();
+    for (size_t i = 0; i < n; ++i){
+        dydt[i] = -2.*y[i] - y[i]*y[i]*y[i] + std::sin(t);
+        if (i > 0){
+            dydt[i] += y[i-1];
+        }
+        if (i + 1 < n){
+            dydt[i] += y[i+1];
+        }
+    }
+}
+
+double _diffusion_jacobian(const vec& y, size_t i, size_t j){
+    if (i == j){
+        return -2. - 3.*y[i]*y[i];
+    }
+    return (i + 1 == j || j + 1 == i) ? 1. : 0.;
+}
+
+OrangeDrumExplorer::Sparsity _tridiagonal(size_t n){
+    OrangeDrumExplorer::Sparsity pattern(n);
+    for (size_t j = 0; j < n; ++j){
+        for (size_t i = (j > 0 ? j-1 : 0); i <= std::min(j+1, n-1); ++i){
+            pattern[j].push_back(i);
+        }
+    }
+    return pattern;
+}
+
+void test_column_groups(){
+    auto dense = OrangeDrumExplorer::column_groups({}, 4);
+    assert((dense.size()==4 && "Every column is a group without pattern"));
+    auto groups = OrangeDrumExplorer::column_groups(_tridiagonal(10), 10);
+    assert((groups.size()==3 && "Tridiagonal Jacobian needs three groups"));
+    for (auto& group : groups){
+        for (size_t k = 1; k < group.size(); ++k){
+            assert((group[k] - group[k-1] >= 3 && "Columns of a group don't share rows"));
+        }
+    }
+    bool thrown = false;
+    try{
+        OrangeDrumExplorer::column_groups({{0}}, 2);
+    }
+    catch (std::invalid_argument&){
+        thrown = true;
+    }
+    assert((thrown && "Pattern of the wrong size is rejected"));
+    // the out-of-range row is in the second column, which is checked against the first group
+    thrown = false;
+    try{
+        OrangeDrumExplorer::column_groups({{0}, {1, 7}}, 2);
+    }
+    catch (std::invalid_argument&){
+        thrown = true;
+    }
+    assert((thrown && "Row out of range is rejected"));
+}
+
+// The Jacobian is dense without pattern and compressed with one
+void _check_jacobian(const OrangeDrumExplorer::FiniteDifferenceJacobian& jacobian, const vec& y,
+                     const OrangeDrumExplorer::Sparsity& pattern, const char* message){
+    const size_t n = y.size();
+    vec f0(n), J(OrangeDrumExplorer::jacobian_values(pattern, n), -1.);
+    jacobian(0.3, y, f0, J);
+    vec f(n);
+    _diffusion(0.3, y, f);
+    for (size_t i = 0; i < n; ++i){
+        assert((f0[i] == f[i] && "Function value returned with the Jacobian"));
+    }
+    size_t k = 0;
+    for (size_t j = 0; j < n; ++j){
+        const size_t rows = pattern.empty() ? n : pattern[j].size();
+        for (size_t r = 0; r < rows; ++r){
+            const size_t i = pattern.empty() ? r : pattern[j][r];
+            const double exact = _diffusion_jacobian(y, i, j);
+            const double value = pattern.empty() ? J[i*n + j] : J[k++];
+            assert((std::abs(value - exact) < 1e-5*(1. + std::abs(exact)) && message));
+        }
+    }
+}
+
+void test_jacobian(){
+    vec y(40);
+    for (size_t i = 0; i < y.size(); ++i){
+        // components of different magnitude and sign
+        y[i] = std::cos(0.7*i)*(i%5 ? 1. : 4.);
+    }
+    const size_t n = y.size();
+    OrangeDrumExplorer::FiniteDifferenceJacobian dense(_diffusion, n);
+    assert((dense.evaluations()==n && "Dense Jacobian perturbs every column"));
+    _check_jacobian(dense, y, {}, "Dense finite difference Jacobian");
+    OrangeDrumExplorer::FiniteDifferenceJacobian grouped(_diffusion, n, _tridiagonal(n));
+    assert((grouped.evaluations()==3 && "Grouped Jacobian perturbs the groups"));
+    _check_jacobian(grouped, y, _tridiagonal(n), "Grouped finite difference Jacobian, compressed");
+    OrangeDrumExplorer::FiniteDifferenceJacobian threaded(_diffusion, n, OrangeDrumExplorer::Sparsity(), 4);
+    _check_jacobian(threaded, y, {}, "Finite difference Jacobian on several threads");
+}
+
+void test_solve(){
+    // plain double functions give the adept solution up to the finite difference error
+    OrangeDrumExplorer::EulerImplicit tape(0., 4.), fd(0., 4.);
+    tape.set_time_step(4./128);
+    fd.set_time_step(4./128);
+    OrangeDrumExplorer::adfunc adf = [](OrangeDrumExplorer::adouble t, const OrangeDrumExplorer::advec& y)
+                                     {return OrangeDrumExplorer::adouble(t + y[1] - 3*y[0]);};
+    OrangeDrumExplorer::func f = [](double t, const vec& y){return t + y[1] - 3*y[0];};
+    vec expected = tape.solve(adf, {1., -2.});
+    vec y1 = fd.solve(f, {1., -2.});
+    assert((y1.size()==expected.size() && "Scalar form with finite differences"));
+    for (size_t i = 0; i < y1.size(); ++i){
+        assert((std::abs(y1[i] - expected[i]) < 1e-6 && "Scalar form with finite differences"));
+    }
+
+    OrangeDrumExplorer::EulerImplicit dense(0., 1.), sparse(0., 1.);
+    const vec y0(30, 1.);
+    vec y_dense = dense.solve(OrangeDrumExplorer::sysfunc(_diffusion), y0);
+    sparse.set_sparsity(_tridiagonal(30));
+    sparse.set_jacobian_threads(2);
+    vec y_sparse = sparse.solve(OrangeDrumExplorer::sysfunc(_diffusion), y0);
+    for (size_t i = 0; i < y_dense.size(); ++i){
+        assert((std::abs(y_dense[i] - y_sparse[i]) < 1e-8 && "Sparse and dense finite differences agree"));
+    }
+}
+
+int main(int, char**) {
+    test_column_groups();
+    test_jacobian();
+    test_solve();
+}
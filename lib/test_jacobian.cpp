@@ -0,0 +1,115 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <cassert>
+#include "Solver.h"
+#include "Jacobian.h"
+
+typedef OrangeDrumExplorer::vec vec;
+
+// Van der Pol oscillator with its hand-derived Jacobian
+const double mu = 5.;
+
+void _vanderpol(double t, const vec& y, vec& dydt){
+    dydt[0] = y[1];
+    dydt[1] = mu*(1. - y[0]*y[0])*y[1] - y[0];
+}
+
+void _advanderpol(OrangeDrumExplorer::adouble t, const OrangeDrumExplorer::advec& y, OrangeDrumExplorer::advec& dydt){
+    dydt[0] = y[1];
+    dydt[1] = mu*(1. - y[0]*y[0])*y[1] - y[0];
+}
+
+void _jacobian(double t, const vec& y, vec& J){
+    J[0*2 + 1] = 1.;
+    J[1*2 + 0] = -2.*mu*y[0]*y[1] - 1.;
+    J[1*2 + 1] = mu*(1. - y[0]*y[0]);
+}
+
+// sign error in one entry
+void _wrong_jacobian(double t, const vec& y, vec& J){
+    _jacobian(t, y, J);
+    J[1*2 + 0] = 2.*mu*y[0]*y[1] - 1.;
+}
+
+// Robertson chemical kinetics, stiff with Jacobian entries up to 6e7*y_2
+void _robertson(double t, const vec& y, vec& dydt){
+    dydt[0] = -0.04*y[0] + 1e4*y[1]*y[2];
+    dydt[1] = 0.04*y[0] - 1e4*y[1]*y[2] - 3e7*y[1]*y[1];
+    dydt[2] = 3e7*y[1]*y[1];
+}
+
+void _adrobertson(OrangeDrumExplorer::adouble t, const OrangeDrumExplorer::advec& y, OrangeDrumExplorer::advec& dydt){
+    dydt[0] = -0.04*y[0] + 1e4*y[1]*y[2];
+    dydt[1] = 0.04*y[0] - 1e4*y[1]*y[2] - 3e7*y[1]*y[1];
+    dydt[2] = 3e7*y[1]*y[1];
+}
+
+void _robertson_jacobian(double t, const vec& y, vec& J){
+    J[0*3 + 0] = -0.04;
+    J[0*3 + 1] = 1e4*y[2];
+    J[0*3 + 2] = 1e4*y[1];
+    J[1*3 + 0] = 0.04;
+    J[1*3 + 1] = -1e4*y[2] - 6e7*y[1];
+    J[1*3 + 2] = -1e4*y[1];
+    J[2*3 + 1] = 6e7*y[1];
+}
+
+void test_robertson(){
+    // one-sided differences are off by 3e7*h in df_2/dy_2 at y_2 = 0
+    for (const vec& y : {vec{1., 0., 0.}, vec{0.9, 3e-5, 0.1}}){
+        assert((OrangeDrumExplorer::jacobian_error(_robertson, _robertson_jacobian, 0., y) < 1e-6
+                && "Correct stiff Jacobian against finite differences"));
+        assert((OrangeDrumExplorer::jacobian_error(_adrobertson, _robertson_jacobian, 0., y) < 1e-14
+                && "Correct stiff Jacobian against adept"));
+    }
+    OrangeDrumExplorer::EulerImplicit tape(0., 1.), analytic(0., 1.);
+    tape.set_time_step(0.01);
+    analytic.set_time_step(0.01);
+    const vec y0 = {1., 0., 0.};
+    const vec expected = tape.solve(OrangeDrumExplorer::adsysfunc(_adrobertson), y0);
+    const vec y1 = analytic.solve(_robertson, _robertson_jacobian, y0);
+    for (size_t i = 0; i < y1.size(); ++i){
+        assert((std::abs(y1[i] - expected[i]) < 1e-12 && "Analytic stiff Jacobian gives the adept solution"));
+    }
+}
+
+void test_jacobian_error(){
+    const vec y = {1.5, -0.7};
+    assert((OrangeDrumExplorer::jacobian_error(_vanderpol, _jacobian, 0., y) < 1e-6 && "Correct Jacobian against finite differences"));
+    assert((OrangeDrumExplorer::jacobian_error(_advanderpol, _jacobian, 0., y) < 1e-14 && "Correct Jacobian against adept"));
+    assert((OrangeDrumExplorer::jacobian_error(_vanderpol, _wrong_jacobian, 0., y) > 1. && "Wrong Jacobian against finite differences"));
+    assert((OrangeDrumExplorer::jacobian_error(_advanderpol, _wrong_jacobian, 0., y) > 1. && "Wrong Jacobian against adept"));
+}
+
+void test_solve(){
+    OrangeDrumExplorer::EulerImplicit tape(0., 2.), analytic(0., 2.);
+    const vec y0 = {2., 0.};
+    vec expected = tape.solve(OrangeDrumExplorer::adsysfunc(_advanderpol), y0);
+    vec y1 = analytic.solve(_vanderpol, _jacobian, y0);
+    assert((y1.size()==expected.size() && analytic.get_state_size()==2 && "Analytic Jacobian stores the full state"));
+    for (size_t i = 0; i < y1.size(); ++i){
+        assert((std::abs(y1[i] - expected[i]) < 1e-12 && "Analytic Jacobian gives the adept solution"));
+    }
+}
+
+void test_wrong_jacobian_detected(){
+#ifndef NDEBUG
+    OrangeDrumExplorer::EulerImplicit solver(0., 2.);
+    bool thrown = false;
+    try{
+        solver.solve(_vanderpol, _wrong_jacobian, {2., 0.5});
+    }
+    catch (std::invalid_argument&){
+        thrown = true;
+    }
+    assert((thrown && "Wrong Jacobian is detected in debug builds"));
+#endif
+}
+
+int main(int, char**) {
+    test_jacobian_error();
+    test_robertson();
+    test_solve();
+    test_wrong_jacobian_detected();
+}
@@ -0,0 +1,176 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <cassert>
+#include <memory>
+#include "Solver.h"
+#include "Krylov.h"
+#include "FiniteDifference.h"
+
+typedef OrangeDrumExplorer::vec vec;
+
+// Non-symmetric, diagonally dominant n x n matrix, row by row
+vec _matrix(size_t n){
+    vec A(n*n, 0.);
+    for (size_t i = 0; i < n; ++i){
+        A[i*n + i] = 4. + 0.1*i;
+        A[i*n + (i+1)%n] = -1.;
+        A[i*n + (i+3)%n] = 0.5;
+    }
+    return A;
+}
+
+OrangeDrumExplorer::linear_operator _product(const vec& A, size_t n){
+    return [A, n](const vec& x, vec& y){
+        for (size_t i = 0; i < n; ++i){
+            y[i] = 0.;
+            for (size_t j = 0; j < n; ++j){
+                y[i] += A[i*n + j]*x[j];
+            }
+        }
+    };
+}
+
+// Inverse of the diagonal of a matrix
+class Jacobi : public OrangeDrumExplorer::Preconditioner {
+    public:
+        vec diagonal;
+        size_t setups = 0;
+        void setup(double t, const vec& y, double dt, const OrangeDrumExplorer::linear_operator& jv) override {
+            // probe the diagonal of I - dt*J with unit vectors
+            const size_t n = y.size();
+            diagonal.assign(n, 1.);
+            vec e(n, 0.), Je(n);
+            for (size_t j = 0; j < n; ++j){
+                e[j] = 1.;
+                jv(e, Je);
+                diagonal[j] = 1. - dt*Je[j];
+                e[j] = 0.;
+            }
+            ++setups;
+        }
+        void apply(const vec& r, vec& z) override {
+            z.resize(r.size());
+            for (size_t i = 0; i < r.size(); ++i){
+                z[i] = r[i]/diagonal[i];
+            }
+        }
+};
+
+void test_gmres(){
+    const size_t n = 20;
+    const vec A = _matrix(n);
+    vec b(n);
+    for (size_t i = 0; i < n; ++i){
+        b[i] = std::sin(1. + i);
+    }
+    vec x(n, 0.), Ax(n);
+    OrangeDrumExplorer::GmresResult full = OrangeDrumExplorer::gmres(_product(A, n), b, x, n, 1e-12, 100);
+    _product(A, n)(x, Ax);
+    for (size_t i = 0; i < n; ++i){
+        assert((std::abs(Ax[i] - b[i]) < 1e-10 && "GMRES solves the system"));
+    }
+    assert((full.converged && full.iterations <= n && "Converges within n iterations without restart"));
+
+    vec restarted(n, 0.);
+    OrangeDrumExplorer::GmresResult short_basis = OrangeDrumExplorer::gmres(_product(A, n), b, restarted, 4, 1e-12, 200);
+    assert((short_basis.converged && "Restarted GMRES converges on a diagonally dominant matrix"));
+    for (size_t i = 0; i < n; ++i){
+        assert((std::abs(restarted[i] - x[i]) < 1e-9 && "Restarts give the same solution"));
+    }
+
+    // a diagonal matrix is inverted exactly by its diagonal preconditioner
+    class Diagonal : public OrangeDrumExplorer::Preconditioner {
+        public:
+            vec d;
+            void apply(const vec& r, vec& z) override {
+                for (size_t i = 0; i < r.size(); ++i){ z[i] = r[i]/d[i]; }
+            }
+    } diagonal;
+    vec D(n*n, 0.);
+    for (size_t i = 0; i < n; ++i){
+        diagonal.d.push_back(A[i*n + i]);
+        D[i*n + i] = A[i*n + i];
+    }
+    vec exact(n, 0.);
+    OrangeDrumExplorer::GmresResult one = OrangeDrumExplorer::gmres(_product(D, n), b, exact, 10, 1e-12, 10, &diagonal);
+    assert((one.converged && one.iterations == 1 && "Exact preconditioner converges in one iteration"));
+}
+
+// Reaction-diffusion on a line
+void _diffusion(double t, const vec& y, vec& dydt){
+    const size_t n = y.size();
+    for (size_t i = 0; i < n; ++i){
+        dydt[i] = -2.*y[i] - y[i]*y[i]*y[i] + std::sin(t);
+        if (i > 0){
+            dydt[i] += y[i-1];
+        }
+        if (i + 1 < n){
+            dydt[i] += y[i+1];
+        }
+    }
+}
+
+void test_directional_difference(){
+    const size_t n = 10;
+    vec y(n), v(n), f(n), Jv(n);
+    for (size_t i = 0; i < n; ++i){
+        y[i] = std::cos(0.4*i);
+        v[i] = 1. - 0.2*i;
+    }
+    OrangeDrumExplorer::DirectionalDifference product(_diffusion, n);
+    product.linearize(0.3, y, f);
+    product.apply(v, Jv);
+    for (size_t i = 0; i < n; ++i){
+        double exact = (-2. - 3.*y[i]*y[i])*v[i] + (i > 0 ? v[i-1] : 0.) + (i + 1 < n ? v[i+1] : 0.);
+        assert((std::abs(Jv[i] - exact) < 1e-6*(1. + std::abs(exact)) && "Directional difference of the Jacobian"));
+    }
+}
+
+void test_solve(){
+    const size_t n = 40;
+    vec y0(n);
+    for (size_t i = 0; i < n; ++i){
+        y0[i] = std::sin(0.2*i);
+    }
+    OrangeDrumExplorer::sysfunc f = _diffusion;
+    OrangeDrumExplorer::adsysfunc adf = [](OrangeDrumExplorer::adouble t, const OrangeDrumExplorer::advec& y,
+                                           OrangeDrumExplorer::advec& dydt){
+        const size_t n = y.size();
+        for (size_t i = 0; i < n; ++i){
+            dydt[i] = -2.*y[i] - y[i]*y[i]*y[i] + sin(t) + (i > 0 ? y[i-1] : 0.) + (i + 1 < n ? y[i+1] : 0.);
+        }
+    };
+    OrangeDrumExplorer::EulerImplicit direct(0., 1.);
+    const vec expected = direct.solve(adf, y0);
+
+    OrangeDrumExplorer::EulerImplicit tangent(0., 1.);
+    tangent.set_newton_krylov(10);
+    const vec y_tangent = tangent.solve(adf, y0);
+    OrangeDrumExplorer::EulerImplicit differences(0., 1.);
+    auto jacobi = std::make_shared<Jacobi>();
+    differences.set_newton_krylov(10, jacobi);
+    const vec y_differences = differences.solve(f, y0);
+    assert((y_tangent.size() == expected.size() && y_differences.size() == expected.size() && "Full state is stored"));
+    for (size_t i = 0; i < expected.size(); ++i){
+        assert((std::abs(y_tangent[i] - expected[i]) < 1e-8 && "Newton-Krylov with the adept tangent gives the direct solution"));
+        assert((std::abs(y_differences[i] - expected[i]) < 1e-6 && "Newton-Krylov with directional differences gives the direct solution"));
+    }
+    assert((jacobi->setups >= 100 && "Preconditioner set up in every Newton iteration"));
+
+    // scalar form through the companion system
+    OrangeDrumExplorer::func g = [](double t, const vec& y){return t + y[1] - 3*y[0];};
+    OrangeDrumExplorer::EulerImplicit scalar(0., 2.), scalar_krylov(0., 2.);
+    scalar_krylov.set_newton_krylov(5);
+    const vec s_direct = scalar.solve(g, {1., -2.});
+    const vec s_krylov = scalar_krylov.solve(g, {1., -2.});
+    for (size_t i = 0; i < s_direct.size(); ++i){
+        assert((std::abs(s_direct[i] - s_krylov[i]) < 1e-6 && "Scalar form with Newton-Krylov"));
+    }
+}
+
+int main(int, char**) {
+    test_gmres();
+    test_directional_difference();
+    test_solve();
+}
@@ -0,0 +1,176 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <cassert>
+#include <memory>
+#include <stdexcept>
+#include "Solver.h"
+#include "LinearSolver.h"
+
+typedef OrangeDrumExplorer::vec vec;
+typedef OrangeDrumExplorer::Sparsity Sparsity;
+
+// Band matrix with kl subdiagonals and ku superdiagonals, row by row, and its pattern
+vec _band(size_t n, size_t kl, size_t ku, Sparsity& pattern){
+    vec J(n*n, 0.);
+    pattern.assign(n, {});
+    for (size_t i = 0; i < n; ++i){
+        for (size_t j = (i > kl ? i - kl : 0); j <= std::min(n - 1, i + ku); ++j){
+            // for dt = 1 the diagonal of dt*J - I is smaller than the subdiagonal, so the LU has to pivot
+            J[i*n + j] = i == j ? 1.05 : (i == j + 1 ? 1. : (j == i + 1 ? -1. : 0.2*std::sin(1. + i)));
+            pattern[j].push_back(i);
+        }
+    }
+    return J;
+}
+
+// Values of the entries of the pattern, column by column, as the solvers get them with a pattern
+vec _compress(const vec& J, const Sparsity& pattern){
+    const size_t n = pattern.size();
+    vec values;
+    for (size_t j = 0; j < n; ++j){
+        for (size_t i : pattern[j]){
+            values.push_back(J[i*n + j]);
+        }
+    }
+    return values;
+}
+
+// (dt*J - I) x
+vec _apply(const vec& J, double dt, const vec& x){
+    const size_t n = x.size();
+    vec y(n);
+    for (size_t i = 0; i < n; ++i){
+        y[i] = -x[i];
+        for (size_t j = 0; j < n; ++j){
+            y[i] += dt*J[i*n + j]*x[j];
+        }
+    }
+    return y;
+}
+
+// Factorize the dense J, compressed if there is a pattern, and check the solution
+void _check(OrangeDrumExplorer::LinearSolver& solver, const vec& J, double dt, const Sparsity& pattern,
+            const char* message){
+    const size_t n = std::lround(std::sqrt(J.size()));
+    vec b(n), x;
+    for (size_t i = 0; i < n; ++i){
+        b[i] = std::cos(0.3*i);
+    }
+    assert((solver.factorize(pattern.empty() ? J : _compress(J, pattern), n, dt, pattern) && message));
+    assert((solver.solve(b, x) && message));
+    const vec y = _apply(J, dt, x);
+    for (size_t i = 0; i < n; ++i){
+        assert((std::abs(y[i] - b[i]) < 1e-10 && message));
+    }
+}
+
+void test_strategies(){
+    Sparsity pattern;
+    const vec J = _band(60, 2, 1, pattern);
+    OrangeDrumExplorer::FullPivLUSolver full;
+    OrangeDrumExplorer::PartialPivLUSolver partial;
+    OrangeDrumExplorer::BandedLUSolver banded, bandwidths(2, 1);
+    OrangeDrumExplorer::SparseLUSolver sparse;
+    OrangeDrumExplorer::AutomaticSolver automatic;
+    _check(full, J, 1., pattern, "Full pivoting LU");
+    _check(partial, J, 1., pattern, "Partial pivoting LU");
+    _check(banded, J, 1., pattern, "Banded LU with the bandwidths of the pattern");
+    _check(bandwidths, J, 1., pattern, "Banded LU with given bandwidths");
+    _check(sparse, J, 1., pattern, "Sparse LU");
+    _check(sparse, J, 0.5, pattern, "Sparse LU reusing the analysed pattern");
+    _check(automatic, J, 1., pattern, "Automatic choice");
+    _check(automatic, J, 1., Sparsity(), "Automatic choice without pattern");
+
+    // diffusion, I - dt*J is positive definite
+    const size_t n = 30;
+    vec diffusion(n*n, 0.);
+    Sparsity tridiagonal(n);
+    for (size_t i = 0; i < n; ++i){
+        diffusion[i*n + i] = -2.;
+        tridiagonal[i].push_back(i);
+        if (i > 0){
+            diffusion[i*n + i - 1] = 1.;
+            tridiagonal[i-1].push_back(i);
+        }
+        if (i + 1 < n){
+            diffusion[i*n + i + 1] = 1.;
+            tridiagonal[i+1].push_back(i);
+        }
+    }
+    OrangeDrumExplorer::CholeskySolver cholesky;
+    _check(cholesky, diffusion, 10., tridiagonal, "Cholesky of a symmetric positive definite matrix");
+    _check(banded, diffusion, 10., tridiagonal, "Banded LU of a tridiagonal matrix");
+    const vec negative(n*n, 0.);
+    vec growth = diffusion;
+    for (double& v : growth){
+        v = -v;
+    }
+    assert((cholesky.factorize(_compress(negative, tridiagonal), n, 1., tridiagonal) && "I is positive definite"));
+    assert((!cholesky.factorize(_compress(growth, tridiagonal), n, 1., tridiagonal)
+            && "Cholesky refuses an indefinite matrix"));
+
+    bool thrown = false;
+    try{
+        banded.factorize(diffusion, n, 1., Sparsity());
+    }
+    catch (std::invalid_argument&){
+        thrown = true;
+    }
+    assert((thrown && "The banded LU needs bandwidths or a pattern"));
+
+    // singular: dt*J - I = 0
+    vec identity(n*n, 0.);
+    for (size_t i = 0; i < n; ++i){
+        identity[i*n + i] = 1.;
+    }
+    vec b(n, 1.), x;
+    assert((!bandwidths.factorize(_compress(identity, tridiagonal), n, 1., tridiagonal)
+            && "Banded LU detects a zero pivot"));
+    partial.factorize(_compress(identity, tridiagonal), n, 1., tridiagonal);
+    assert((!partial.solve(b, x) && "Partial pivoting LU detects a singular matrix by the residual"));
+}
+
+// Heat equation with a cubic source
+struct Heat {
+    template <typename T>
+    void operator()(T t, const std::vector<T>& y, std::vector<T>& dydt) const {
+        const size_t n = y.size();
+        for (size_t i = 0; i < n; ++i){
+            dydt[i] = -2.*y[i] - 0.1*y[i]*y[i]*y[i] + (i > 0 ? y[i-1] : T(0.)) + (i + 1 < n ? y[i+1] : T(0.));
+        }
+    }
+};
+
+void test_solve(){
+    const size_t n = 40;
+    vec y0(n);
+    for (size_t i = 0; i < n; ++i){
+        y0[i] = std::sin(0.2*i);
+    }
+    OrangeDrumExplorer::EulerImplicit automatic(0., 1.);
+    const vec expected = automatic.solve_dual(Heat(), y0);
+
+    // runtime selection
+    OrangeDrumExplorer::EulerImplicit cholesky(0., 1.);
+    cholesky.set_linear_solver(std::make_shared<OrangeDrumExplorer::CholeskySolver>());
+    const vec y_cholesky = cholesky.solve_dual(Heat(), y0);
+    OrangeDrumExplorer::EulerImplicit full(0., 1.);
+    full.set_linear_solver(std::make_shared<OrangeDrumExplorer::FullPivLUSolver>());
+    const vec y_full = full.solve_dual(Heat(), y0);
+    // compile-time selection, with the pattern from the tape
+    OrangeDrumExplorer::EulerImplicitWith<OrangeDrumExplorer::BandedLUSolver> banded(0., 1.);
+    const vec y_banded = banded.solve_taped(Heat(), y0);
+    assert((y_cholesky.size() == expected.size() && y_full.size() == expected.size()
+            && y_banded.size() == expected.size() && "Full state is stored"));
+    for (size_t i = 0; i < expected.size(); ++i){
+        assert((std::abs(y_cholesky[i] - expected[i]) < 1e-10 && "Cholesky gives the default solution"));
+        assert((std::abs(y_full[i] - expected[i]) < 1e-10 && "Full pivoting gives the default solution"));
+        assert((std::abs(y_banded[i] - expected[i]) < 1e-10 && "Banded LU gives the default solution"));
+    }
+}
+
+int main(int, char**) {
+    test_strategies();
+    test_solve();
+}
@@ -0,0 +1,83 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <cassert>
+#include <stdexcept>
+#include "Solver.h"
+#include "LowStorageRK.h"
+#include "test_problems.h"
+
+typedef OrangeDrumExplorer::vec vec;
+typedef OrangeDrumExplorer::LowStorageRK LowStorageRK;
+
+void test_order(){
+    for (const LowStorageRK::Scheme& scheme : {LowStorageRK::williamson3(), LowStorageRK::carpenter_kennedy4()}){
+        auto error = [&scheme](double dt){
+            LowStorageRK solver(0., 2., scheme);
+            solver.set_time_step(dt);
+            const vec& y = solver.solve(_forced, {1.});
+            return std::abs(y.back() - _forced_solution(2.));
+        };
+        assert((_has_order(error, 0.1, scheme.order) && "Observed order of the scheme"));
+    }
+}
+
+void test_sink(){
+    // harmonic oscillator as system
+    OrangeDrumExplorer::sysfunc f = [](double t, const vec& y, vec& dydt){dydt[0] = y[1]; dydt[1] = -y[0];};
+    LowStorageRK stored(0., 1.), streamed(0., 1.);
+    const vec& y = stored.solve(f, {1., 0.});
+    size_t calls = 0;
+    bool matches = true;
+    const vec last = streamed.solve(f, {1., 0.}, [&](double t, const vec& state){
+        matches = matches && std::abs(t - 0.01*calls) < 1e-12
+                  && state[0] == y[2*calls] && state[1] == y[2*calls + 1];
+        ++calls;
+    });
+    assert((calls == 101 && "Sink receives the initial state and every step"));
+    assert((matches && "Sink receives the stored states"));
+    assert((last[0] == y[200] && last[1] == y[201] && "Last state is returned"));
+    assert((std::abs(last[0] - std::cos(1.)) < 1e-9 && "Harmonic oscillator"));
+    assert((!streamed.check_solution_cache() && "Nothing is stored with a sink"));
+
+    // the one-stage scheme is the explicit Euler method
+    LowStorageRK euler(0., 1., {{0.}, {1.}, {0.}, 1});
+    OrangeDrumExplorer::EulerExplicit reference(0., 1.);
+    const vec& y_euler = euler.solve(f, {1., 0.});
+    const vec& y_reference = reference.solve(f, {1., 0.});
+    for (size_t i = 0; i < y_reference.size(); ++i){
+        assert((y_euler[i] == y_reference[i] && "One-stage scheme is the explicit Euler method"));
+    }
+
+    bool thrown = false;
+    try{
+        euler.set_scheme({{0.5, 0.}, {1., 1.}, {0., 1.}, 1});
+    }
+    catch (std::invalid_argument&){
+        thrown = true;
+    }
+    assert((thrown && "The first stage has no increment to carry"));
+}
+
+void test_scalar(){
+    // y'' = -y as scalar form, plain and instrumented
+    OrangeDrumExplorer::func g = [](double t, const vec& y){return -y[0];};
+    OrangeDrumExplorer::adfunc adg = [](OrangeDrumExplorer::adouble t, const OrangeDrumExplorer::advec& y){return -y[0];};
+    OrangeDrumExplorer::adsysfunc adf = [](OrangeDrumExplorer::adouble t, const OrangeDrumExplorer::advec& y,
+                                           OrangeDrumExplorer::advec& dydt){dydt[0] = y[1]; dydt[1] = -y[0];};
+    LowStorageRK plain(0., 3.), instrumented(0., 3.), system(0., 3.);
+    const vec& y = plain.solve(g, {1., 0.});
+    const vec& ady = instrumented.solve(adg, {1., 0.});
+    const vec& ys = system.solve(adf, {1., 0.});
+    assert((y.size() == 101 && ady.size() == 101 && ys.size() == 202 && "Scalar form stores the function value"));
+    for (size_t i = 0; i < y.size(); ++i){
+        assert((std::abs(y[i] - std::cos(0.03*i)) < 1e-8 && "Scalar form"));
+        assert((ady[i] == y[i] && ys[2*i] == y[i] && "Instrumented functions give the same values"));
+    }
+}
+
+int main(int, char**) {
+    test_order();
+    test_sink();
+    test_scalar();
+}
@@ -0,0 +1,125 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <cassert>
+#include <stdexcept>
+#include "Solver.h"
+#include "FiniteDifference.h"
+#include "MethodOfLines.h"
+
+typedef OrangeDrumExplorer::vec vec;
+typedef OrangeDrumExplorer::MethodOfLines MethodOfLines;
+
+const double pi = std::acos(-1.);
+
+// Fourth-order diffusion with advection and a cubic reaction, five-point stencil
+double _stencil(double t, double x, const double* u, double dx){
+    const double uxx = (-u[-2] + 16.*u[-1] - 30.*u[0] + 16.*u[1] - u[2])/(12.*dx*dx);
+    const double ux = (u[1] - u[-1])/(2.*dx);
+    return 0.1*uxx - (1. + x)*ux - u[0]*u[0]*u[0] + std::sin(t);
+}
+
+void test_jacobian(){
+    const size_t m = 12;
+    MethodOfLines pde(_stencil, 2, m, 0., 2., MethodOfLines::Boundary::neumann(0.5),
+                      MethodOfLines::Boundary::dirichlet([](double t){ return std::cos(t); }));
+    assert((pde.points() == m && pde.radius() == 2 && std::abs(pde.dx() - 2./m) < 1e-15 && "Grid"));
+    assert((std::abs(pde.x(0) - 1./m) < 1e-15 && "Unknowns at the cell centres"));
+    const vec u = pde.discretize([](double x){ return std::sin(2.*x) + 0.3; });
+    const double t = 0.4;
+
+    vec f(m), band;
+    pde.linearize(t, u, f, band);
+    assert((band.size() == 5*m && "Only the band is stored"));
+    vec f_system(m), dense(m*m), f_dense(m);
+    pde(t, u, f_system);
+    OrangeDrumExplorer::FiniteDifferenceJacobian(pde.system(), m)(t, u, f_dense, dense);
+    for (size_t i = 0; i < m; ++i){
+        assert((f[i] == f_system[i] && "The system is evaluated at the state"));
+        for (size_t j = 0; j < m; ++j){
+            if (i + 2 < j || j + 2 < i){
+                assert((dense[i*m + j] == 0. && "The mirrored boundaries keep the Jacobian banded"));
+            }
+            else{
+                assert((std::abs(band[(2 + i - j) + j*5] - dense[i*m + j]) < 1e-5*(1. + std::abs(dense[i*m + j]))
+                        && "Band by compressed differences"));
+            }
+        }
+    }
+    const OrangeDrumExplorer::Sparsity pattern = pde.sparsity();
+    assert((pattern.size() == m && pattern[0].size() == 3 && pattern[5].size() == 5 && "Pattern of the band"));
+}
+
+void test_boundaries(){
+    const size_t m = 8;
+    // the stencil sees the mirrored ghost values
+    MethodOfLines::stencil left = [](double, double, const double* u, double){ return u[-1]; };
+    MethodOfLines dirichlet(left, 1, m, 0., 1., MethodOfLines::Boundary::dirichlet(2.), MethodOfLines::Boundary::dirichlet(0.));
+    MethodOfLines neumann(left, 1, m, 0., 1., MethodOfLines::Boundary::neumann(3.), MethodOfLines::Boundary::neumann(0.));
+    const vec u(m, 0.5);
+    vec f(m);
+    dirichlet(0., u, f);
+    assert((std::abs(f[0] - 3.5) < 1e-15 && "Dirichlet ghost 2g - u"));
+    neumann(0., u, f);
+    assert((std::abs(f[0] - (0.5 - 3./m)) < 1e-15 && "Neumann ghost u - dx*q"));
+
+    bool thrown = false;
+    try{
+        MethodOfLines narrow(_stencil, 2, 1, 0., 1., MethodOfLines::Boundary::neumann(0.), MethodOfLines::Boundary::neumann(0.));
+    }
+    catch (std::invalid_argument&){
+        thrown = true;
+    }
+    assert((thrown && "The stencil has to fit into the grid"));
+}
+
+void test_heat(){
+    // u_t = u_xx on [0, 1] with u = 0 at both ends, u = exp(-pi^2 t) sin(pi x)
+    const size_t m = 100;
+    MethodOfLines pde(MethodOfLines::diffusion(1.), 1, m, 0., 1., MethodOfLines::Boundary::dirichlet(0.),
+                      MethodOfLines::Boundary::dirichlet(0.));
+    const vec u0 = pde.discretize([](double x){ return std::sin(pi*x); });
+    OrangeDrumExplorer::EulerImplicit banded(0., 0.1);
+    const vec& u = banded.solve(pde, u0);
+    assert((banded.get_state_size() == m && u.size() == 101*m && "Full state is stored"));
+    for (size_t i = 0; i < m; ++i){
+        const double exact = std::exp(-pi*pi*0.1)*std::sin(pi*pde.x(i));
+        assert((std::abs(u[100*m + i] - exact) < 5e-3 && "Heat equation"));
+    }
+
+    // the same system through the dense path
+    OrangeDrumExplorer::EulerImplicit dense(0., 0.1);
+    dense.set_sparsity(pde.sparsity());
+    const vec& expected = dense.solve(pde.system(), u0);
+    for (size_t i = 0; i < u.size(); ++i){
+        assert((std::abs(u[i] - expected[i]) < 1e-8 && "Banded and dense paths agree"));
+    }
+
+    // insulated ends conserve the heat
+    MethodOfLines insulated(MethodOfLines::diffusion(1.), 1, m, 0., 1., MethodOfLines::Boundary::neumann(0.),
+                            MethodOfLines::Boundary::neumann(0.));
+    OrangeDrumExplorer::EulerImplicit conserving(0., 1.);
+    const vec& v = conserving.solve(insulated, insulated.discretize([](double x){ return x*x; }));
+    double before = 0., after = 0.;
+    for (size_t i = 0; i < m; ++i){
+        before += v[i];
+        after += v[100*m + i];
+    }
+    assert((std::abs(before - after) < 1e-9 && "Zero flux conserves the sum"));
+    assert((std::abs(v[100*m] - v[101*m - 1]) < 1e-2 && "Insulated rod levels out"));
+
+    bool thrown = false;
+    try{
+        banded.solve(pde, vec(m + 1, 0.));
+    }
+    catch (std::invalid_argument&){
+        thrown = true;
+    }
+    assert((thrown && "One initial value per point"));
+}
+
+int main(int, char**) {
+    test_jacobian();
+    test_boundaries();
+    test_heat();
+}
@@ -0,0 +1,147 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <cassert>
+#include <memory>
+#include <stdexcept>
+#include "Solver.h"
+#include "LowStorageRK.h"
+#include "Parareal.h"
+
+typedef OrangeDrumExplorer::vec vec;
+typedef OrangeDrumExplorer::adouble adouble;
+typedef OrangeDrumExplorer::advec advec;
+typedef OrangeDrumExplorer::Parareal Parareal;
+
+// y'' - y' + 3y = t, the demo equation of main.cpp, as a system
+void _demo(double t, const vec& y, vec& dydt){
+    dydt[0] = y[1];
+    dydt[1] = t + y[1] - 3.*y[0];
+}
+
+adouble _demo_scalar(adouble t, const advec& y){
+    return t + y[1] - 3.0*y[0];
+}
+
+std::unique_ptr<OrangeDrumExplorer::Solver> _euler(){
+    return std::make_unique<OrangeDrumExplorer::EulerExplicit>();
+}
+
+std::unique_ptr<OrangeDrumExplorer::Solver> _rk4(){
+    return std::make_unique<OrangeDrumExplorer::LowStorageRK>();
+}
+
+void test_exact(){
+    // after as many iterations as slices, Parareal is the sequential fine solve
+    OrangeDrumExplorer::LowStorageRK sequential(0., 4.);
+    sequential.set_time_step(4./1024);
+    const vec& y = sequential.solve(OrangeDrumExplorer::sysfunc(_demo), {1., -2.});
+    Parareal parareal(0., 4., _euler, _rk4);
+    parareal.set_time_step(4./1024);
+    parareal.set_slices(6);
+    parareal.set_tolerance(0.);
+    const vec& z = parareal.solve(OrangeDrumExplorer::sysfunc(_demo), {1., -2.});
+    assert((y.size() == z.size() && parareal.get_state_size() == 2));
+    for (size_t i = 0; i < y.size(); ++i){
+        assert((std::abs(y[i] - z[i]) < 1e-12*std::max(1., std::abs(y[i])) && "Sequential fine solution"));
+    }
+    const Parareal::Statistics statistics = parareal.get_statistics();
+    // the first slices are exact early and aren't solved again
+    assert((statistics.converged && statistics.iterations == 6 && statistics.fine_solves == 6+5+4+3+2+1));
+    assert((statistics.coarse_solves == 5 + 4+3+2+1));
+}
+
+void test_convergence(){
+    // the corrections shrink and the solve stops at the tolerance, before the exact iteration count
+    OrangeDrumExplorer::LowStorageRK sequential(0., 4.);
+    sequential.set_time_step(4./1024);
+    const vec& y = sequential.solve(OrangeDrumExplorer::sysfunc(_demo), {1., -2.});
+    vec previous;
+    for (size_t threads : {1, 3}){
+        Parareal parareal(0., 4., _euler, _rk4);
+        parareal.set_time_step(4./1024);
+        parareal.set_slices(16);
+        parareal.set_coarse_steps(16);
+        parareal.set_threads(threads);
+        const vec& z = parareal.solve(OrangeDrumExplorer::sysfunc(_demo), {1., -2.});
+        const Parareal::Statistics statistics = parareal.get_statistics();
+        assert((statistics.converged && statistics.iterations < 16 && statistics.corrections.back() <= 1e-8));
+        for (size_t j = 1; j < statistics.corrections.size(); ++j){
+            assert((statistics.corrections[j] < statistics.corrections[j-1] && "Contracting corrections"));
+        }
+        for (size_t i = 0; i < y.size(); ++i){
+            assert((std::abs(y[i] - z[i]) < 1e-6*std::max(1., std::abs(y[i])) && "Converged to the fine solution"));
+        }
+        // the same operations in any thread
+        assert((previous.empty() || previous == z));
+        previous = z;
+    }
+
+    // a limit of the iterations stops the solve unconverged
+    Parareal limited(0., 4., _euler, _rk4);
+    limited.set_time_step(4./1024);
+    limited.set_slices(16);
+    limited.set_max_iterations(1);
+    limited.solve(OrangeDrumExplorer::sysfunc(_demo), {1., -2.});
+    assert((!limited.get_statistics().converged && limited.get_statistics().iterations == 1));
+}
+
+void test_scalar(){
+    // a scalar equation is solved as its companion system and stores its function value only
+    OrangeDrumExplorer::EulerExplicit sequential(0., 4.);
+    sequential.set_time_step(4./512);
+    const vec& y = sequential.solve(OrangeDrumExplorer::companion(OrangeDrumExplorer::adfunc(_demo_scalar)),
+                                    {1., -2.});
+    Parareal parareal(0., 4., _euler, _euler);
+    parareal.set_time_step(4./512);
+    parareal.set_slices(4);
+    parareal.set_tolerance(0.);
+    const vec& z = parareal.solve(_demo_scalar, {1., -2.});
+    assert((2*z.size() == y.size() && parareal.get_state_size() == 1));
+    for (size_t i = 0; i < z.size(); ++i){
+        assert((std::abs(y[2*i] - z[i]) < 1e-12*std::max(1., std::abs(z[i])) && "Scalar form"));
+    }
+}
+
+void test_stiff(){
+    // Implicit Euler as the coarse solver of a stiff problem: y' = -1e3 (y - cos(t)), y ~ cos(t)
+    OrangeDrumExplorer::adsysfunc stiff = [](adouble t, const advec& y, advec& dydt){
+        dydt[0] = -1e3*(y[0] - cos(t));
+    };
+    Parareal parareal(0., 2., []{ return std::make_unique<OrangeDrumExplorer::EulerImplicit>(); }, _rk4);
+    parareal.set_time_step(2./4096);
+    parareal.set_threads(2);
+    const vec& z = parareal.solve(stiff, {1.});
+    assert((parareal.get_statistics().converged && parareal.get_statistics().iterations < 8));
+    assert((std::abs(z.back() - std::cos(2.)) < 2e-3 && "Stiff problem"));
+}
+
+void test_arguments(){
+    Parareal parareal(0., 1., _euler, _euler);
+    parareal.set_time_step(1./10);
+    parareal.set_slices(6);
+    bool thrown = false;
+    try{
+        parareal.solve(OrangeDrumExplorer::sysfunc(_demo), {1., -2.});
+    }
+    catch (std::invalid_argument&){
+        thrown = true;
+    }
+    assert((thrown && "Every slice needs two steps"));
+    thrown = false;
+    try{
+        parareal.set_coarse_steps(1);
+    }
+    catch (std::invalid_argument&){
+        thrown = true;
+    }
+    assert((thrown && "Two coarse steps per slice"));
+}
+
+int main(int, char**) {
+    test_exact();
+    test_convergence();
+    test_scalar();
+    test_stiff();
+    test_arguments();
+}
@@ -0,0 +1,35 @@
+#ifndef ORANGE_DRUM_EXPLORER_TEST_PROBLEMS_H
+#define ORANGE_DRUM_EXPLORER_TEST_PROBLEMS_H
+
+#include <cmath>
+
+#include "Solver.h"
+
+// Problems and order checks shared by the tests of the solvers
+
+// y' = -y + cos(t) with y(0) = 1, y = (cos(t) + sin(t) + exp(-t))/2
+inline void _forced(double t, const OrangeDrumExplorer::vec& y, OrangeDrumExplorer::vec& dydt){
+    dydt[0] = -y[0] + std::cos(t);
+}
+
+inline double _forced_solution(double t){
+    return (std::cos(t) + std::sin(t) + std::exp(-t))/2.;
+}
+
+/**
+ * Order observed from halving the step: the error divides by 2^order
+ *
+ * @param error(dt) - error of a solve with the time step dt
+ */
+template <typename E>
+double _observed_order(const E& error, double dt){
+    return std::log2(error(dt)/error(dt/2.));
+}
+
+// The observed order is within 0.3 of the order of the method
+template <typename E>
+bool _has_order(const E& error, double dt, double order){
+    return std::abs(_observed_order(error, dt) - order) < 0.3;
+}
+
+#endif /*ORANGE_DRUM_EXPLORER_TEST_PROBLEMS_H*/
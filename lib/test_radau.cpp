@@ -0,0 +1,175 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <cassert>
+#include <stdexcept>
+#include "Solver.h"
+#include "MethodOfLines.h"
+#include "RadauIIA.h"
+#include "test_problems.h"
+
+typedef OrangeDrumExplorer::vec vec;
+typedef OrangeDrumExplorer::RadauIIA RadauIIA;
+
+// Prothero-Robinson y' = -lambda*(y - cos(t)) - sin(t) with y(0) = 2, y = cos(t) + exp(-lambda*t)
+const double lambda = 1e4;
+
+void _prothero_robinson(double t, const vec& y, vec& dydt){
+    dydt[0] = -lambda*(y[0] - std::cos(t)) - std::sin(t);
+}
+
+// Van der Pol with mu = 1000, relaxation oscillations
+void _vanderpol(double t, const vec& y, vec& dydt){
+    dydt[0] = y[1];
+    dydt[1] = 1000.*(1. - y[0]*y[0])*y[1] - y[0];
+}
+
+void test_order(){
+    auto error = [](double dt){
+        RadauIIA solver(0., 1.);
+        solver.set_time_step(dt);
+        const vec& y = solver.solve(OrangeDrumExplorer::sysfunc(_forced), {1.});
+        return std::abs(y.back() - _forced_solution(1.));
+    };
+    assert((_has_order(error, 0.25, 5.) && "Order 5"));
+}
+
+void test_reuse(){
+    // the exact Jacobian of a linear problem converges at once, so it and the factorizations are kept
+    RadauIIA solver(0., 1.);
+    OrangeDrumExplorer::jacfunc jacobian = [](double t, const vec& y, vec& J){J[0] = -lambda;};
+    const vec& y = solver.solve(_prothero_robinson, jacobian, {2.});
+    const RadauIIA::Statistics statistics = solver.get_statistics();
+    assert((statistics.steps == 100 && statistics.jacobians == 1 && statistics.factorizations == 2
+            && "One Jacobian and one factorization of each system for all steps"));
+    assert((statistics.newton_iterations <= 2*100 && "Simplified Newton iterations"));
+    // stiffly accurate: the transient is damped within a step of 1e2/lambda
+    assert((std::abs(y.back() - std::cos(1.)) < 1e-8 && "Stiff problem at steps far above 1/lambda"));
+}
+
+void test_step_control(){
+    // the error follows the tolerance, with more steps for tighter ones
+    double previous_error = 1.;
+    size_t previous_steps = 0;
+    for (double tolerance : {1e-3, 1e-6, 1e-9}){
+        RadauIIA solver(0., 10.);
+        solver.set_time_step(1.);
+        solver.set_tolerances(tolerance, tolerance);
+        const vec& y = solver.solve(OrangeDrumExplorer::sysfunc(_prothero_robinson), {2.});
+        assert((y.size() == 11 && "Solution on the grid of the time step"));
+        double error = 0.;
+        for (size_t i = 0; i < y.size(); ++i){
+            error = std::max(error, std::abs(y[i] - std::cos(i) - std::exp(-lambda*i)));
+        }
+        const RadauIIA::Statistics statistics = solver.get_statistics();
+        assert((error < 10.*tolerance && "Error follows the tolerance"));
+        assert((error < previous_error && statistics.steps > previous_steps && "Tighter tolerance"));
+        assert((statistics.jacobians < statistics.steps && "Jacobians are kept"));
+        previous_error = error;
+        previous_steps = statistics.steps;
+    }
+
+    // relaxation oscillations against a tight tolerance, interpolated by the collocation polynomials
+    RadauIIA loose(0., 2.), tight(0., 2.);
+    loose.set_time_step(0.1);
+    tight.set_time_step(0.1);
+    loose.set_tolerances(1e-6, 1e-6);
+    tight.set_tolerances(1e-11, 1e-11);
+    const vec& y = loose.solve(_vanderpol, {2., 0.});
+    const vec& reference = tight.solve(_vanderpol, {2., 0.});
+    for (size_t i = 0; i < y.size(); i += 2){
+        assert((std::abs(y[i] - reference[i]) < 1e-4 && "Van der Pol"));
+    }
+    assert((loose.get_statistics().steps < tight.get_statistics().steps));
+}
+
+void test_parallel(){
+    // the real and the complex system on two threads give the same result as one after the other
+    const size_t m = 100;
+    OrangeDrumExplorer::MethodOfLines pde(OrangeDrumExplorer::MethodOfLines::diffusion(1.), 1, m, 0., 1.,
+                                          OrangeDrumExplorer::MethodOfLines::Boundary::dirichlet(0.),
+                                          OrangeDrumExplorer::MethodOfLines::Boundary::dirichlet(0.));
+    const vec u0 = pde.discretize([](double x){ return std::sin(M_PI*x); });
+    RadauIIA serial(0., 0.1), parallel(0., 0.1);
+    serial.set_time_step(0.01);
+    parallel.set_time_step(0.01);
+    serial.set_sparsity(pde.sparsity());
+    parallel.set_sparsity(pde.sparsity());
+    serial.set_parallel_size(m + 1);
+    parallel.set_parallel_size(0);
+    const vec& u = serial.solve(pde.system(), u0);
+    const vec& v = parallel.solve(pde.system(), u0);
+    assert((u == v && "Same result on two threads"));
+    for (size_t i = 0; i < m; ++i){
+        assert((std::abs(u[10*m + i] - std::exp(-M_PI*M_PI*0.1)*std::sin(M_PI*pde.x(i))) < 5e-4 && "Heat equation"));
+    }
+}
+
+void test_interfaces(){
+    // the Jacobians of EulerImplicit drive the Newton iterations
+    OrangeDrumExplorer::sysfunc f = [](double t, const vec& y, vec& dydt){dydt[0] = y[1]; dydt[1] = -y[0];};
+    OrangeDrumExplorer::adsysfunc adf = [](OrangeDrumExplorer::adouble t, const OrangeDrumExplorer::advec& y,
+                                           OrangeDrumExplorer::advec& dydt){dydt[0] = y[1]; dydt[1] = -y[0];};
+    OrangeDrumExplorer::jacfunc jacobian = [](double t, const vec& y, vec& J){J[1] = 1.; J[2] = -1.;};
+    OrangeDrumExplorer::adfunc adg = [](OrangeDrumExplorer::adouble t, const OrangeDrumExplorer::advec& y)
+                                         -> OrangeDrumExplorer::adouble {return -y[0];};
+    RadauIIA differences(0., 3.), tape(0., 3.), analytic(0., 3.), dual(0., 3.), scalar(0., 3.);
+    const vec& y = differences.solve(f, {1., 0.});
+    const vec& ady = tape.solve(adf, {1., 0.});
+    const vec& ay = analytic.solve(f, jacobian, {1., 0.});
+    const vec& dy = dual.solve_dual([](auto t, const auto& y, auto& dydt){dydt[0] = y[1]; dydt[1] = -y[0];}, {1., 0.});
+    const vec& sy = scalar.solve(adg, {1., 0.});
+    assert((y.size() == 202 && sy.size() == 101 && "Full state and scalar form"));
+    for (size_t i = 0; i < y.size()/2; ++i){
+        assert((std::abs(y[2*i] - std::cos(0.03*i)) < 1e-9 && "Fifth order"));
+        assert((std::abs(ady[2*i] - y[2*i]) < 1e-9 && std::abs(ay[2*i] - y[2*i]) < 1e-9
+                && std::abs(dy[2*i] - y[2*i]) < 1e-9 && std::abs(sy[i] - y[2*i]) < 1e-9
+                && "Same stages with any Jacobian"));
+    }
+
+    // the banded Jacobian of the method of lines isn't supported
+    OrangeDrumExplorer::MethodOfLines pde(OrangeDrumExplorer::MethodOfLines::diffusion(1.), 1, 20, 0., 1.,
+                                          OrangeDrumExplorer::MethodOfLines::Boundary::dirichlet(0.),
+                                          OrangeDrumExplorer::MethodOfLines::Boundary::dirichlet(0.));
+    bool thrown = false;
+    RadauIIA banded;
+    try{
+        banded.solve(pde, pde.discretize([](double x){ return std::sin(M_PI*x); }));
+    }
+    catch (std::invalid_argument&){
+        thrown = true;
+    }
+    assert((thrown && "Banded Jacobian"));
+
+    thrown = false;
+    RadauIIA krylov;
+    krylov.set_newton_krylov(10);
+    try{
+        krylov.solve(f, {1., 0.});
+    }
+    catch (std::invalid_argument&){
+        thrown = true;
+    }
+    assert((thrown && "Newton-Krylov isn't supported"));
+}
+
+void test_arguments(){
+    RadauIIA solver;
+    bool thrown = false;
+    try{
+        solver.set_tolerances(1e-6, 0.);
+    }
+    catch (std::invalid_argument&){
+        thrown = true;
+    }
+    assert((thrown && "Absolute tolerance has to be positive"));
+}
+
+int main(int, char**) {
+    test_order();
+    test_reuse();
+    test_step_control();
+    test_parallel();
+    test_interfaces();
+    test_arguments();
+}
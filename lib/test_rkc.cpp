@@ -0,0 +1,146 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <cassert>
+#include <stdexcept>
+#include "Solver.h"
+#include "Krylov.h"
+#include "RKC.h"
+#include "test_problems.h"
+
+typedef OrangeDrumExplorer::vec vec;
+typedef OrangeDrumExplorer::RKC RKC;
+
+// u_t = u_xx on (0, 1) with zero ends on m interior points, u = exp(-pi^2 t) sin(pi x) for u(0) = sin(pi x)
+const size_t m = 100;
+const double dx = 1./(m + 1);
+
+void _heat(double t, const vec& u, vec& dudt){
+    for (size_t i = 0; i < m; ++i){
+        const double left = i > 0 ? u[i-1] : 0.;
+        const double right = i + 1 < m ? u[i+1] : 0.;
+        dudt[i] = (left - 2.*u[i] + right)/(dx*dx);
+    }
+}
+
+vec _heat_initial(){
+    vec u(m);
+    for (size_t i = 0; i < m; ++i){
+        u[i] = std::sin(M_PI*(i + 1)*dx);
+    }
+    return u;
+}
+
+// largest deviation of the last state from the continuous solution at t
+double _heat_error(const vec& u, double t){
+    double error = 0.;
+    for (size_t i = 0; i < m; ++i){
+        error = std::max(error, std::abs(u[i] - std::exp(-M_PI*M_PI*t)*std::sin(M_PI*(i + 1)*dx)));
+    }
+    return error;
+}
+
+void test_spectral_radius(){
+    // second difference with unit spacing, eigenvalues -4 sin^2(k pi/(2(n+1)))
+    const size_t n = 50;
+    OrangeDrumExplorer::linear_operator A = [n](const vec& x, vec& y){
+        for (size_t i = 0; i < n; ++i){
+            y[i] = -2.*x[i] + (i > 0 ? x[i-1] : 0.) + (i + 1 < n ? x[i+1] : 0.);
+        }
+    };
+    const double exact = 4.*std::pow(std::sin(n*M_PI/(2.*(n + 1))), 2);
+    vec v(n, 0.);
+    const double estimate = OrangeDrumExplorer::spectral_radius(A, v, 1e-6, 200);
+    assert((estimate <= exact*(1. + 1e-12) && estimate > 0.99*exact && "Power iteration from below"));
+    // warm start from the last iterate
+    const double again = OrangeDrumExplorer::spectral_radius(A, v, 0.01, 2);
+    assert((std::abs(again - estimate) < 1e-3*exact && "Warm start"));
+}
+
+void test_heat(){
+    // explicit Euler is stable up to dt = dx^2/2 = 4.9e-5
+    const double dt = 1e-3;
+    RKC solver(0., 0.1);
+    solver.set_time_step(dt);
+    const vec& u = solver.solve(_heat, _heat_initial());
+    const vec last(u.end() - m, u.end());
+    assert((_heat_error(last, 0.1) < 1e-3 && "Heat equation far above the explicit Euler limit"));
+    const RKC::Statistics statistics = solver.get_statistics();
+    assert((statistics.max_stages >= 7 && statistics.max_stages <= 10 && "Stages from the spectral radius"));
+    assert((statistics.estimates == 4 && "Estimate every 25 steps"));
+
+    OrangeDrumExplorer::EulerExplicit euler(0., 0.1);
+    euler.set_time_step(dt);
+    const vec& unstable = euler.solve(_heat, _heat_initial());
+    assert((!(std::abs(unstable[unstable.size() - m/2]) < 1e10) && "Explicit Euler is unstable"));
+
+    // the known bound replaces the power iteration
+    RKC bounded(0., 0.1);
+    bounded.set_time_step(dt);
+    bounded.set_spectral_radius([](double t, const vec& u){ return 4./(dx*dx); });
+    const vec& ub = bounded.solve(_heat, _heat_initial());
+    const vec last_bounded(ub.end() - m, ub.end());
+    const size_t s = RKC::stages(dt, 4./(dx*dx));
+    assert((bounded.get_statistics().estimates == 0 && bounded.get_statistics().evaluations == 100*s
+            && "s evaluations per step"));
+    assert((_heat_error(last_bounded, 0.1) < 1e-3 && "Known spectral radius"));
+
+    // a bound that grows along the solution is followed in every step, not every 25
+    RKC growing(0., 0.1);
+    growing.set_time_step(dt);
+    size_t calls = 0;
+    growing.set_spectral_radius([&calls](double t, const vec& u){ ++calls; return (1. + 10.*t)*4./(dx*dx); });
+    growing.solve(_heat, _heat_initial());
+    assert((calls == 100 && growing.get_statistics().max_stages == RKC::stages(dt, (1. + 10.*0.099)*4./(dx*dx))
+            && "Bound in every step"));
+}
+
+void test_order(){
+    auto error = [](double dt){
+        RKC solver(0., 2.);
+        solver.set_time_step(dt);
+        const vec& y = solver.solve(_forced, {1.});
+        return std::abs(y.back() - _forced_solution(2.));
+    };
+    assert((_has_order(error, 0.1, 2.) && "Second order"));
+}
+
+void test_interfaces(){
+    // y'' = -y/100 in every form
+    OrangeDrumExplorer::func g = [](double t, const vec& y){return -y[0]/100.;};
+    // the explicit return type evaluates the adept expression before its temporaries go away
+    OrangeDrumExplorer::adfunc adg = [](OrangeDrumExplorer::adouble t,
+                                        const OrangeDrumExplorer::advec& y) -> OrangeDrumExplorer::adouble {
+        return -y[0]/100.;};
+    RKC plain(0., 3.), instrumented(0., 3.), streamed(0., 3.);
+    const vec& y = plain.solve(g, {1., 0.});
+    const vec& ady = instrumented.solve(adg, {1., 0.});
+    assert((y.size() == 101 && ady.size() == 101 && "Scalar form stores the function value"));
+    size_t calls = 0;
+    bool matches = true;
+    const vec last = streamed.solve(OrangeDrumExplorer::companion(g), {1., 0.}, [&](double t, const vec& state){
+        matches = matches && state[0] == y[calls];
+        ++calls;
+    });
+    assert((calls == 101 && matches && last[0] == y.back() && "Sink receives every state"));
+    for (size_t i = 0; i < y.size(); ++i){
+        assert((std::abs(y[i] - std::cos(0.003*i)) < 1e-6 && "Scalar form"));
+        assert((ady[i] == y[i] && "Instrumented functions give the same values"));
+    }
+
+    bool thrown = false;
+    try{
+        plain.set_estimate_interval(0);
+    }
+    catch (std::invalid_argument&){
+        thrown = true;
+    }
+    assert((thrown && "The spectral radius is estimated at least once"));
+}
+
+int main(int, char**) {
+    test_spectral_radius();
+    test_heat();
+    test_order();
+    test_interfaces();
+}
@@ -0,0 +1,123 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <cassert>
+#include <random>
+#include <stdexcept>
+#include "Solver.h"
+#include "Scan.h"
+
+typedef OrangeDrumExplorer::vec vec;
+
+// random contractive maps of a state of 3
+vec _maps(size_t N){
+    std::mt19937 generator(7);
+    std::uniform_real_distribution<double> uniform(-0.5, 0.5);
+    vec maps(N*12);
+    for (double& x : maps){
+        x = uniform(generator);
+    }
+    return maps;
+}
+
+vec _sequential(const vec& maps, const vec& y0, size_t N){
+    vec y = y0, next(3), states;
+    for (size_t i = 0; i < N; ++i){
+        for (size_t j = 0; j < 3; ++j){
+            next[j] = maps[i*12 + 9 + j];
+            for (size_t k = 0; k < 3; ++k){
+                next[j] += maps[i*12 + 3*j + k]*y[k];
+            }
+        }
+        y = next;
+        states.insert(states.end(), y.begin(), y.end());
+    }
+    return states;
+}
+
+void test_scan(){
+    const vec y0 = {1., -2., 0.5};
+    for (size_t N : {0, 5, 1000}){
+        const vec maps = _maps(N);
+        const vec expected = _sequential(maps, y0, N);
+        OrangeDrumExplorer::affine_step step = [&](size_t i, vec& M, vec& c){
+            std::copy(maps.begin() + i*12, maps.begin() + i*12 + 9, M.begin());
+            std::copy(maps.begin() + i*12 + 9, maps.begin() + i*12 + 12, c.begin());
+        };
+        // the block count doesn't divide the steps for 7 threads
+        for (size_t threads : {1, 2, 3, 7}){
+            vec states(N*3);
+            std::vector<int> stored(N + 1, 0);
+            OrangeDrumExplorer::affine_scan(step, y0, N, threads, [&](size_t i, const vec& y){
+                std::copy(y.begin(), y.end(), states.begin() + (i-1)*3);
+                ++stored[i];
+            });
+            for (size_t i = 1; i <= N; ++i){
+                assert((stored[i] == 1 && "Every state is stored once"));
+            }
+            for (size_t i = 0; i < states.size(); ++i){
+                assert((std::abs(states[i] - expected[i]) < 1e-13*std::max(1., std::abs(expected[i]))
+                        && "Scan and sequential steps"));
+            }
+        }
+    }
+
+    // an exception in any block reaches the caller
+    bool thrown = false;
+    try{
+        OrangeDrumExplorer::affine_scan([](size_t i, vec& M, vec& c){
+            if (i == 900){
+                throw std::runtime_error("step");
+            }
+        }, y0, 1000, 4, [](size_t, const vec&){});
+    }
+    catch (std::runtime_error&){
+        thrown = true;
+    }
+    assert((thrown && "Exception of a block"));
+}
+
+void test_solve_affine(){
+    // y'' - y' + 3y = t, the demo equation of main.cpp, as a system
+    OrangeDrumExplorer::sysfunc f = [](double t, const vec& y, vec& dydt){
+        dydt[0] = y[1];
+        dydt[1] = t + y[1] - 3.*y[0];
+    };
+    OrangeDrumExplorer::affinefunc coefficients = [](double t, vec& A, vec& b){
+        A[1] = 1.;
+        A[2] = -3.;
+        A[3] = 1.;
+        b[1] = t;
+    };
+    OrangeDrumExplorer::EulerExplicit euler(0., 4.), scan(0., 4.);
+    euler.set_time_step(4./1024);
+    scan.set_time_step(4./1024);
+    scan.set_scan_threads(4);
+    const vec& y = euler.solve(f, {1., -2.});
+    const vec& z = scan.solve_affine(coefficients, {1., -2.});
+    assert((y.size() == z.size()));
+    for (size_t i = 0; i < y.size(); ++i){
+        assert((std::abs(y[i] - z[i]) < 1e-11*std::max(1., std::abs(y[i])) && "Same steps as solve(sysfunc)"));
+    }
+
+    // varying coefficients: y' = -t y, y = exp(-t^2/2)
+    OrangeDrumExplorer::EulerExplicit varying(0., 2.);
+    varying.set_time_step(2./4096);
+    varying.set_scan_threads(3);
+    const vec& u = varying.solve_affine([](double t, vec& A, vec&){ A[0] = -t; }, {1.});
+    assert((u.size() == 4097 && std::abs(u.back() - std::exp(-2.)) < 1e-3 && "Varying coefficients"));
+
+    bool thrown = false;
+    try{
+        varying.set_scan_threads(0);
+    }
+    catch (std::invalid_argument&){
+        thrown = true;
+    }
+    assert((thrown && "At least one thread"));
+}
+
+int main(int, char**) {
+    test_scan();
+    test_solve_affine();
+}
@@ -0,0 +1,163 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <cassert>
+#include <stdexcept>
+#include "Solver.h"
+#include "SDC.h"
+#include "test_problems.h"
+
+typedef OrangeDrumExplorer::vec vec;
+typedef OrangeDrumExplorer::adouble adouble;
+typedef OrangeDrumExplorer::advec advec;
+typedef OrangeDrumExplorer::SDC SDC;
+
+// y' = -y^2 + cos(t) + (2 + sin(t))^2 with y(0) = 2, y = 2 + sin(t)
+void _quadratic(adouble t, const advec& y, advec& dydt){
+    dydt[0] = -y[0]*y[0] + cos(t) + (2. + sin(t))*(2. + sin(t));
+}
+
+void _quadratic_plain(double t, const vec& y, vec& dydt){
+    dydt[0] = -y[0]*y[0] + std::cos(t) + (2. + std::sin(t))*(2. + std::sin(t));
+}
+
+double _error(size_t nodes, size_t sweeps, SDC::Sweeper sweeper, size_t parallel, double dt){
+    SDC solver(0., 1., nodes, sweeps, sweeper);
+    solver.set_time_step(dt);
+    solver.set_parallel_sweeps(parallel);
+    const vec& y = solver.solve(OrangeDrumExplorer::adsysfunc(_quadratic), {2.});
+    return std::abs(y.back() - 2. - std::sin(1.));
+}
+
+bool _has_order(size_t nodes, size_t sweeps, SDC::Sweeper sweeper, size_t parallel, double dt, double order){
+    auto error = [=](double h){ return _error(nodes, sweeps, sweeper, parallel, h); };
+    return _has_order(error, dt, order);
+}
+
+void test_nodes(){
+    const vec three = SDC::lobatto_nodes(3);
+    assert((three == vec{0., 0.5, 1.}));
+    const vec five = SDC::lobatto_nodes(5);
+    const vec expected = {0., (1. - std::sqrt(3./7.))/2., 0.5, (1. + std::sqrt(3./7.))/2., 1.};
+    for (size_t i = 0; i < 5; ++i){
+        assert((std::abs(five[i] - expected[i]) < 1e-15 && "Gauss-Lobatto nodes"));
+    }
+}
+
+void test_order(){
+    // every sweep raises the order by one, up to 2M - 2; the implicit sweeps reach it at smaller steps
+    for (SDC::Sweeper sweeper : {SDC::Sweeper::implicit_euler, SDC::Sweeper::explicit_euler}){
+        const double dt = sweeper == SDC::Sweeper::implicit_euler ? 0.0125 : 0.05;
+        for (size_t parallel : {0, 1}){
+            for (size_t sweeps = 1; sweeps <= 4; ++sweeps){
+                assert((_has_order(3, sweeps, sweeper, parallel, dt, sweeps) && "Order of the sweeps"));
+            }
+        }
+        assert((_has_order(2, 5, sweeper, 0, dt, 2.) && "Order 2M - 2 of the collocation"));
+    }
+    // four nodes reach order 6
+    assert((_has_order(4, 6, SDC::Sweeper::explicit_euler, 0, 0.05, 6.) && "Order 6"));
+}
+
+void test_parallel(){
+    // the concurrent node updates are the Jacobi sweeps on one thread, which converge slower than Gauss-Seidel
+    vec previous;
+    for (size_t threads : {1, 2, 4}){
+        SDC solver(0., 1., 5, 12);
+        solver.set_time_step(0.1);
+        solver.set_parallel_sweeps(threads);
+        const vec& y = solver.solve(OrangeDrumExplorer::sysfunc(_quadratic_plain), {2.});
+        assert((std::abs(y.back() - 2. - std::sin(1.)) < 1e-8 && "Parallel sweeps"));
+        assert((previous.empty() || previous == y));
+        previous = y;
+        const SDC::Statistics statistics = solver.get_statistics();
+        assert((statistics.steps == 10 && statistics.sweeps == 120 && statistics.node_updates == 480));
+    }
+
+    // the analytic Jacobian compressed by a sparsity pattern, three uncoupled copies of the problem
+    const size_t n = 3;
+    OrangeDrumExplorer::Sparsity diagonal(n);
+    for (size_t j = 0; j < n; ++j){
+        diagonal[j].push_back(j);
+    }
+    auto copies = [](double t, const vec& y, vec& dydt){
+        for (size_t i = 0; i < y.size(); ++i){
+            dydt[i] = -y[i]*y[i] + std::cos(t) + (2. + std::sin(t))*(2. + std::sin(t));
+        }
+    };
+    auto jacobian = [](double, const vec& y, vec& J){
+        for (size_t i = 0; i < y.size(); ++i){
+            J[i*y.size() + i] = -2.*y[i];
+        }
+    };
+    previous.clear();
+    for (size_t threads : {1, 4}){
+        SDC solver(0., 1., 5, 3);
+        solver.set_time_step(0.1);
+        solver.set_sparsity(diagonal);
+        solver.set_parallel_sweeps(threads);
+        const vec& y = solver.solve(copies, jacobian, vec(n, 2.));
+        assert((std::abs(y.back() - 2. - std::sin(1.)) < 1e-3 && "Parallel sweeps with a sparsity pattern"));
+        assert((previous.empty() || previous == y));
+        previous = y;
+    }
+
+    // the adept tape can't be shared between threads
+    SDC taped(0., 1.);
+    taped.set_parallel_sweeps(2);
+    bool thrown = false;
+    try{
+        taped.solve(OrangeDrumExplorer::adsysfunc(_quadratic), {2.});
+    }
+    catch (std::invalid_argument&){
+        thrown = true;
+    }
+    assert((thrown && "Concurrent sweeps with a plain double function only"));
+}
+
+void test_stiff(){
+    // steps of 100/lambda: y' = -lambda*(y - cos(t)) - sin(t), y = cos(t); the stiffness reduces the order
+    for (size_t parallel : {0, 1}){
+        SDC solver(0., 1.);
+        solver.set_time_step(0.1);
+        solver.set_parallel_sweeps(parallel);
+        const vec& y = solver.solve(OrangeDrumExplorer::adsysfunc([](adouble t, const advec& y, advec& dydt){
+            dydt[0] = -1e3*(y[0] - cos(t)) - sin(t);
+        }), {1.});
+        for (size_t i = 0; i < y.size(); ++i){
+            assert((std::abs(y[i] - std::cos(0.1*i)) < 3e-5 && "Stiff problem"));
+        }
+    }
+}
+
+void test_interfaces(){
+    // the Jacobians of EulerImplicit take the same implicit sweeps
+    OrangeDrumExplorer::jacfunc jacobian = [](double t, const vec& y, vec& J){
+        J[0] = -2.*y[0];
+    };
+    SDC tape(0., 1.), analytic(0., 1.), differences(0., 1.);
+    const vec& y = tape.solve(OrangeDrumExplorer::adsysfunc(_quadratic), {2.});
+    const vec& ay = analytic.solve(_quadratic_plain, jacobian, {2.});
+    const vec& dy = differences.solve(OrangeDrumExplorer::sysfunc(_quadratic_plain), {2.});
+    for (size_t i = 0; i < y.size(); ++i){
+        assert((std::abs(ay[i] - y[i]) < 1e-12 && std::abs(dy[i] - y[i]) < 1e-9 && "Same steps with any Jacobian"));
+    }
+
+    bool thrown = false;
+    try{
+        SDC solver;
+        solver.set_nodes(1);
+    }
+    catch (std::invalid_argument&){
+        thrown = true;
+    }
+    assert((thrown && "Two nodes"));
+}
+
+int main(int, char**) {
+    test_nodes();
+    test_order();
+    test_parallel();
+    test_stiff();
+    test_interfaces();
+}
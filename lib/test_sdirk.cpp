@@ -0,0 +1,157 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <cassert>
+#include <stdexcept>
+#include <type_traits>
+#include "Solver.h"
+#include "MethodOfLines.h"
+#include "SDIRK.h"
+#include "test_problems.h"
+
+typedef OrangeDrumExplorer::vec vec;
+typedef OrangeDrumExplorer::SDIRK SDIRK;
+
+// The IMEX solve and the pairs of AdditiveRK aren't reachable through an SDIRK
+static_assert(!std::is_base_of<OrangeDrumExplorer::AdditiveRK, SDIRK>::value, "SDIRK isn't an AdditiveRK");
+
+// Prothero-Robinson y' = -lambda*(y - cos(t)) - sin(t) with y(0) = 2, y = cos(t) + exp(-lambda*t)
+const double lambda = 1e4;
+
+void _prothero_robinson(double t, const vec& y, vec& dydt){
+    dydt[0] = -lambda*(y[0] - std::cos(t)) - std::sin(t);
+}
+
+void test_order(){
+    for (const SDIRK::Tableau& tableau : {SDIRK::trapezoidal(), SDIRK::tr_bdf2(), SDIRK::sdirk2(),
+                                          SDIRK::sdirk3(), SDIRK::sdirk4()}){
+        auto error = [&tableau](double dt){
+            SDIRK solver(0., 1., tableau);
+            solver.set_time_step(dt);
+            const vec& y = solver.solve(OrangeDrumExplorer::sysfunc(_forced), {1.});
+            return std::abs(y.back() - _forced_solution(1.));
+        };
+        assert((_has_order(error, 0.1, tableau.order) && "Order of the tableau"));
+    }
+}
+
+void test_one_factorization(){
+    // with the exact Jacobian of a linear problem every stage takes one update and one check
+    SDIRK solver(0., 1., SDIRK::sdirk4());
+    OrangeDrumExplorer::jacfunc jacobian = [](double t, const vec& y, vec& J){J[0] = -lambda;};
+    const vec& y = solver.solve(_prothero_robinson, jacobian, {2.});
+    const SDIRK::Statistics statistics = solver.get_statistics();
+    assert((statistics.steps == 100 && statistics.jacobians == 100 && statistics.factorizations == 100
+            && "One Jacobian and one factorization per step"));
+    assert((statistics.newton_iterations <= 2*5*100 && "Stages reuse the factorization"));
+    // L-stable: the transient is damped within a step of 1e2/lambda
+    assert((std::abs(y.back() - std::cos(1.)) < 1e-6 && "Stiff problem at steps far above 1/lambda"));
+}
+
+void test_step_control(){
+    // the error follows the tolerance, with more steps for tighter ones
+    double previous_error = 1.;
+    size_t previous_steps = 0;
+    for (double tolerance : {1e-3, 1e-5, 1e-7}){
+        SDIRK solver(0., 10., SDIRK::sdirk4());
+        solver.set_time_step(1.);
+        solver.set_tolerances(tolerance, tolerance);
+        const vec& y = solver.solve(OrangeDrumExplorer::sysfunc(_prothero_robinson), {2.});
+        assert((y.size() == 11 && "Solution on the grid of the time step"));
+        double error = 0.;
+        for (size_t i = 0; i < y.size(); ++i){
+            error = std::max(error, std::abs(y[i] - std::cos(i) - std::exp(-lambda*i)));
+        }
+        const SDIRK::Statistics statistics = solver.get_statistics();
+        assert((error < 10.*tolerance && "Error follows the tolerance"));
+        assert((error < previous_error && statistics.steps > previous_steps && "Tighter tolerance"));
+        assert((statistics.jacobians == statistics.steps && "One Jacobian per step"));
+        // L-stable: the transient doesn't need to be resolved at loose tolerances
+        assert((tolerance < 1e-3 || statistics.steps < 20));
+        previous_error = error;
+        previous_steps = statistics.steps;
+    }
+
+    // explicit Euler embedded in the trapezoidal rule
+    SDIRK trapezoidal(0., 10., SDIRK::trapezoidal());
+    trapezoidal.set_tolerances(1e-4, 1e-4);
+    const vec& y = trapezoidal.solve(_forced, {1.});
+    assert((std::abs(y.back() - _forced_solution(10.)) < 1e-3 && "Trapezoidal rule"));
+}
+
+void test_interfaces(){
+    // the Jacobians of EulerImplicit drive the stages
+    OrangeDrumExplorer::sysfunc f = [](double t, const vec& y, vec& dydt){dydt[0] = y[1]; dydt[1] = -y[0];};
+    OrangeDrumExplorer::adsysfunc adf = [](OrangeDrumExplorer::adouble t, const OrangeDrumExplorer::advec& y,
+                                           OrangeDrumExplorer::advec& dydt){dydt[0] = y[1]; dydt[1] = -y[0];};
+    OrangeDrumExplorer::jacfunc jacobian = [](double t, const vec& y, vec& J){J[1] = 1.; J[2] = -1.;};
+    OrangeDrumExplorer::adfunc adg = [](OrangeDrumExplorer::adouble t, const OrangeDrumExplorer::advec& y)
+                                         -> OrangeDrumExplorer::adouble {return -y[0];};
+    SDIRK differences(0., 3., SDIRK::sdirk3()), tape(0., 3., SDIRK::sdirk3()), analytic(0., 3., SDIRK::sdirk3());
+    SDIRK dual(0., 3., SDIRK::sdirk3()), scalar(0., 3., SDIRK::sdirk3());
+    const vec& y = differences.solve(f, {1., 0.});
+    const vec& ady = tape.solve(adf, {1., 0.});
+    const vec& ay = analytic.solve(f, jacobian, {1., 0.});
+    const vec& dy = dual.solve_dual([](auto t, const auto& y, auto& dydt){dydt[0] = y[1]; dydt[1] = -y[0];}, {1., 0.});
+    const vec& sy = scalar.solve(adg, {1., 0.});
+    assert((y.size() == 202 && sy.size() == 101 && "Full state and scalar form"));
+    for (size_t i = 0; i < y.size()/2; ++i){
+        assert((std::abs(y[2*i] - std::cos(0.03*i)) < 1e-5 && "Third order"));
+        assert((std::abs(ady[2*i] - y[2*i]) < 1e-9 && std::abs(ay[2*i] - y[2*i]) < 1e-9
+                && std::abs(dy[2*i] - y[2*i]) < 1e-9 && std::abs(sy[i] - y[2*i]) < 1e-9
+                && "Same stages with any Jacobian"));
+    }
+
+    // banded Jacobian of the method of lines, u = exp(-pi^2 t) sin(pi x)
+    const size_t m = 50;
+    OrangeDrumExplorer::MethodOfLines pde(OrangeDrumExplorer::MethodOfLines::diffusion(1.), 1, m, 0., 1.,
+                                          OrangeDrumExplorer::MethodOfLines::Boundary::dirichlet(0.),
+                                          OrangeDrumExplorer::MethodOfLines::Boundary::dirichlet(0.));
+    SDIRK heat(0., 0.1, SDIRK::sdirk4());
+    heat.set_time_step(0.01);
+    const vec& u = heat.solve(pde, pde.discretize([](double x){ return std::sin(M_PI*x); }));
+    for (size_t i = 0; i < m; ++i){
+        assert((std::abs(u[10*m + i] - std::exp(-M_PI*M_PI*0.1)*std::sin(M_PI*pde.x(i))) < 5e-4 && "Heat equation"));
+    }
+
+    bool thrown = false;
+    SDIRK krylov;
+    krylov.set_newton_krylov(10);
+    try{
+        krylov.solve(f, {1., 0.});
+    }
+    catch (std::invalid_argument&){
+        thrown = true;
+    }
+    assert((thrown && "Newton-Krylov isn't supported"));
+}
+
+void test_arguments(){
+    SDIRK solver;
+    bool thrown = false;
+    try{
+        SDIRK::Tableau varying = SDIRK::sdirk2();
+        varying.a[1][1] = 0.5;
+        solver.set_tableau(varying);
+    }
+    catch (std::invalid_argument&){
+        thrown = true;
+    }
+    assert((thrown && "The diagonal is a single gamma"));
+    thrown = false;
+    try{
+        solver.set_tolerances(1e-6, 0.);
+    }
+    catch (std::invalid_argument&){
+        thrown = true;
+    }
+    assert((thrown && "Absolute tolerance has to be positive"));
+}
+
+int main(int, char**) {
+    test_order();
+    test_one_factorization();
+    test_step_control();
+    test_interfaces();
+    test_arguments();
+}
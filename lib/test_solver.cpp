@@ -1,5 +1,7 @@
 #include <iostream>
 #include <vector>
+#include <sstream>
+#include <cmath>
 #include "Solver.h"
 #include <cassert>
 
@@ -149,6 +151,122 @@ void test_wrong_functiontype(){
     assert((thrown && "Wrong function type doesn't throw the correct exception"));
 }
 
+// Same equation as test_solution as companion system, the state holds f and f'
+template<typename S, typename F = OrangeDrumExplorer::adsysfunc>
+void test_system(double bottom, double top){
+    S solver(0., 4.);
+    solver.set_time_step(4./128);
+    OrangeDrumExplorer::vec y0 = {1., -2.};
+    F f = [](OrangeDrumExplorer::adouble t, const OrangeDrumExplorer::advec& y, OrangeDrumExplorer::advec& dydt)
+            {dydt[0] = y[1]; dydt[1] = t + y[1] - 3*y[0];};
+    OrangeDrumExplorer::vec y1 = solver.solve(f, y0);
+    assert((solver.get_state_size()==2 && y1.size()==2*129 && "System solution stores the full state"));
+    assert(((bottom < y1[2*128] && y1[2*128] < top) && "System solution accuracy"));
+}
+
+template <>
+void test_system<OrangeDrumExplorer::EulerExplicit, OrangeDrumExplorer::sysfunc>(double bottom, double top){
+    OrangeDrumExplorer::EulerExplicit solver(0., 4.);
+    solver.set_time_step(4./128);
+    OrangeDrumExplorer::vec y0 = {1., -2.};
+    OrangeDrumExplorer::sysfunc f = [](double t, const OrangeDrumExplorer::vec& y, OrangeDrumExplorer::vec& dydt)
+            {dydt[0] = y[1]; dydt[1] = t + y[1] - 3*y[0];};
+    OrangeDrumExplorer::vec y1 = solver.solve(f, y0);
+    assert((solver.get_state_size()==2 && y1.size()==2*129 && "System solution stores the full state"));
+    assert(((bottom < y1[2*128] && y1[2*128] < top) && "System solution accuracy"));
+}
+
+// Two uncoupled equations in one system give the solutions of the separate scalar equations
+template<typename S>
+void test_system_coupling(){
+    S scalar(0., 1.);
+    OrangeDrumExplorer::vec single = scalar.solve(f_const, y0_const);
+    S solver(0., 1.);
+    OrangeDrumExplorer::adsysfunc f = [](OrangeDrumExplorer::adouble t, const OrangeDrumExplorer::advec& y,
+                                         OrangeDrumExplorer::advec& dydt)
+            {dydt[0] = 1.; dydt[1] = -y[1];};
+    OrangeDrumExplorer::vec y1 = solver.solve(f, {1., 1.});
+    for (size_t i = 0; i < single.size(); ++i){
+        assert((std::abs(y1[2*i] - single[i]) < 1e-12 && "System component equals the scalar solution"));
+    }
+    assert((y1[2*100+1] > 0.3 && y1[2*100+1] < 0.4 && "Second component decays"));
+}
+
+// The scalar n-th order form is its companion system, storing only the function value
+template <typename S>
+void test_companion(){
+    OrangeDrumExplorer::func f = [](double t, const OrangeDrumExplorer::vec& y){return t + y[1] - 3*y[0];};
+    OrangeDrumExplorer::adfunc adf = [](OrangeDrumExplorer::adouble t, const OrangeDrumExplorer::advec& y)
+            {return OrangeDrumExplorer::adouble(t + y[1] - 3*y[0]);};
+    S scalar(0., 4.), adscalar(0., 4.), system(0., 4.);
+    const OrangeDrumExplorer::vec y_scalar = scalar.solve(f, {1., -2.});
+    const OrangeDrumExplorer::vec y_adscalar = adscalar.solve(adf, {1., -2.});
+    const OrangeDrumExplorer::vec y_system = system.solve(OrangeDrumExplorer::companion(f), {1., -2.});
+    assert((y_scalar.size()*2 == y_system.size() && y_adscalar.size() == y_scalar.size()));
+    for (size_t i = 0; i < y_scalar.size(); ++i){
+        assert((std::abs(y_scalar[i] - y_system[2*i]) < 1e-12 && "Scalar form equals the companion system"));
+        assert((std::abs(y_adscalar[i] - y_system[2*i]) < 1e-12 && "Instrumented scalar form equals the companion system"));
+    }
+}
+
+template <typename S>
+void test_save_system(){
+    const std::string fname = "test_system_solution.txt";
+    S solver(0., 1.);
+    OrangeDrumExplorer::adsysfunc f = [](OrangeDrumExplorer::adouble t, const OrangeDrumExplorer::advec& y,
+                                         OrangeDrumExplorer::advec& dydt)
+            {dydt[0] = y[1]; dydt[1] = -y[0]; dydt[2] = 0.;};
+    solver.solve(f, {1., 0., 2.});
+    _refresh_file(fname);
+    std::ofstream test_out(fname, std::ios::trunc);
+    solver.save_solution(test_out);
+    test_out.close();
+    std::ifstream test_in(fname);
+    std::string line;
+    int rows = 0;
+    while (std::getline(test_in, line)){
+        std::istringstream values(line);
+        double val;
+        int columns = 0;
+        while (values >> val){
+            ++columns;
+        }
+        assert((columns==3 && "One column per state component"));
+        ++rows;
+    }
+    assert((rows==101 && "One row per step"));
+}
+
+// Tridiagonal system large enough for the sparse LU, with and without the sparsity pattern
+void test_sparse_system(){
+    const size_t n = 64;
+    OrangeDrumExplorer::adsysfunc f = [](OrangeDrumExplorer::adouble t, const OrangeDrumExplorer::advec& y,
+                                         OrangeDrumExplorer::advec& dydt){
+        const size_t n = y.size();
+        for (size_t i = 0; i < n; ++i){
+            dydt[i] = -2.*y[i] - y[i]*y[i]*y[i] + (i > 0 ? y[i-1] : 0.) + (i + 1 < n ? y[i+1] : 0.);
+        }
+    };
+    OrangeDrumExplorer::Sparsity pattern(n);
+    for (size_t j = 0; j < n; ++j){
+        for (size_t i = (j > 0 ? j-1 : 0); i <= std::min(j+1, n-1); ++i){
+            pattern[j].push_back(i);
+        }
+    }
+    OrangeDrumExplorer::vec y0(n);
+    for (size_t i = 0; i < n; ++i){
+        y0[i] = std::sin(0.1*i);
+    }
+    OrangeDrumExplorer::EulerImplicit dense(0., 1.), sparse(0., 1.);
+    OrangeDrumExplorer::vec y_dense = dense.solve(f, y0);
+    sparse.set_sparsity(pattern);
+    OrangeDrumExplorer::vec y_sparse = sparse.solve(f, y0);
+    assert((y_sparse.size() == y_dense.size() && "Sparse solution stores the full state"));
+    for (size_t i = 0; i < y_dense.size(); ++i){
+        assert((std::abs(y_dense[i] - y_sparse[i]) < 1e-10 && "Compressed Jacobian and sparse LU give the dense solution"));
+    }
+}
+
 int main(int, char**) {
     typedef OrangeDrumExplorer::EulerExplicit EE;
     test_default<EE>();
@@ -157,9 +275,14 @@ int main(int, char**) {
     test_dt<EE>();
     test_reversed<EE>();
     test_large_dt<EE>();
-    EE solver = test_solution<EE>(5.33506, 5.33508);
-    test_save_to_file(solver, 5.33506, 5.33508);
-    EE solver3 = test_solution<EE, OrangeDrumExplorer::func>(5.33506, 5.33508);
+    EE solver = test_solution<EE>(5.40507, 5.40508);
+    test_save_to_file(solver, 5.40506, 5.40508);
+    EE solver3 = test_solution<EE, OrangeDrumExplorer::func>(5.40507, 5.40508);
+    test_system<EE>(5.40507, 5.40508);
+    test_system<EE, OrangeDrumExplorer::sysfunc>(5.40507, 5.40508);
+    test_system_coupling<EE>();
+    test_companion<EE>();
+    test_save_system<EE>();
     typedef OrangeDrumExplorer::EulerImplicit IE;
     test_default<IE>();
     test_custom<IE>();
@@ -169,4 +292,9 @@ int main(int, char**) {
     test_large_dt<IE>();
     IE solver2 = test_solution<IE>(1.90620,1.90622);
     test_save_to_file(solver2, 1.90620,1.90622);
+    test_system<IE>(1.90620,1.90622);
+    test_system_coupling<IE>();
+    test_companion<IE>();
+    test_save_system<IE>();
+    test_sparse_system();
 }
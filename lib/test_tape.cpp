@@ -0,0 +1,211 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <cassert>
+#include <stdexcept>
+#include "Solver.h"
+#include "Tape.h"
+#include "Dual.h"
+
+using OrangeDrumExplorer::Tape;
+using OrangeDrumExplorer::TapeScalar;
+using OrangeDrumExplorer::vec;
+
+bool _close(double a, double b, double tolerance = 1e-12){
+    return std::abs(a - b) <= tolerance*std::max(1., std::abs(b));
+}
+
+// Every recorded operation on three components, templated on the scalar type
+struct Functions {
+    template <typename T>
+    void operator()(const T& t, const std::vector<T>& y, std::vector<T>& dydt) const {
+        dydt[0] = sqrt(y[0])*exp(y[1]) - log(y[2])/y[1] + t;
+        dydt[1] = sin(y[0])*cos(y[1]) + tan(y[2]) - atan(y[0]*y[2]);
+        dydt[2] = sinh(y[1])/cosh(y[2]) + tanh(-y[0]) + abs(y[1] - 2.) + pow(y[2], 2.5) + pow(y[0], y[2]);
+    }
+};
+
+// Right hand side changing its expression when y[0] falls below 0.3
+struct Switching {
+    template <typename T>
+    void operator()(const T& t, const std::vector<T>& y, std::vector<T>& dydt) const {
+        if (y[0] > 0.3){
+            dydt[0] = -y[0]*y[0];
+        }
+        else{
+            dydt[0] = T(-1.);
+        }
+        dydt[1] = -y[1] + y[0];
+    }
+};
+
+struct VanDerPol {
+    template <typename T>
+    void operator()(const T& t, const std::vector<T>& y, std::vector<T>& dydt) const {
+        dydt[0] = y[1];
+        dydt[1] = 5.*(1. - y[0]*y[0])*y[1] - y[0];
+    }
+};
+
+void test_replay_matches_dual(){
+    Tape tape;
+    tape.record(Functions(), 0.1, {0.7, 1.3, 0.4});
+    const vec y = {1.1, 0.6, 0.9};
+    assert((tape.forward(0.2, y) && "Replay without branches is always valid"));
+    vec f, J;
+    tape.values(f);
+    tape.jacobian(J);
+
+    typedef OrangeDrumExplorer::Dual<double, 3> dual3;
+    std::vector<dual3> yd = {dual3(y[0], 0), dual3(y[1], 1), dual3(y[2], 2)};
+    std::vector<dual3> fd(3);
+    Functions()(dual3(0.2), yd, fd);
+    for (size_t i = 0; i < 3; ++i){
+        assert((_close(f[i], fd[i].value()) && "Replayed values equal a new evaluation"));
+        for (size_t j = 0; j < 3; ++j){
+            assert((_close(J[i*3 + j], fd[i].derivative(j)) && "Reverse sweep gives the forward-mode Jacobian"));
+        }
+    }
+    vec values;
+    tape.compressed_jacobian(values);
+    const auto& pattern = tape.sparsity();
+    size_t k = 0;
+    for (size_t j = 0; j < 3; ++j){
+        for (size_t i : pattern[j]){
+            assert((values[k++] == J[i*3 + j] && "Compressed Jacobian holds the entries of the pattern"));
+        }
+    }
+    assert((k == values.size() && "One value per entry of the pattern"));
+    assert((tape.recordings() == 1 && "Replay doesn't record again"));
+}
+
+void test_branches(){
+    Tape tape;
+    tape.record(Switching(), 0., {1., 0.});
+    vec f, J;
+    assert((tape.forward(0., {2., 1.}) && "Same branch replays"));
+    tape.values(f);
+    tape.jacobian(J);
+    assert((_close(f[0], -4.) && _close(J[0], -4.) && _close(J[2], 1.) && "Values and Jacobian of the recorded branch"));
+    assert((!tape.forward(0., {-2., 1.}) && "Changed branch is detected"));
+    tape.record(Switching(), 0., {-2., 1.});
+    tape.values(f);
+    assert((_close(f[0], -1.) && tape.recordings() == 2 && "Recording again follows the other branch"));
+}
+
+void test_value_guard(){
+    Tape tape;
+    auto scaled = [](const TapeScalar& t, const std::vector<TapeScalar>& y, std::vector<TapeScalar>& dydt){
+        // the factor is a plain double, fixed at the recording
+        dydt[0] = value(y[0]) > 0. ? 2.*y[0] : y[0];
+    };
+    tape.record(scaled, 0., {1.});
+    assert((tape.forward(0., {1.}) && "Same value replays"));
+    assert((!tape.forward(0., {1.5}) && "Another value of an observed scalar needs a new recording"));
+}
+
+void test_lanes(){
+    Tape tape;
+    tape.record(Functions(), 0., {0.7, 1.3, 0.4});
+    const size_t lanes = 5;
+    vec t(lanes), y(3*lanes), f(3*lanes);
+    for (size_t l = 0; l < lanes; ++l){
+        t[l] = 0.1*l;
+        for (size_t j = 0; j < 3; ++j){
+            y[j*lanes + l] = 0.5 + 0.1*l + 0.2*j;
+        }
+    }
+    assert((tape.forward_lanes(t.data(), y.data(), f.data(), lanes) && "Ensemble without branches replays"));
+    for (size_t l = 0; l < lanes; ++l){
+        vec fl;
+        tape.forward(t[l], {y[l], y[lanes + l], y[2*lanes + l]});
+        tape.values(fl);
+        for (size_t i = 0; i < 3; ++i){
+            assert((_close(f[i*lanes + l], fl[i]) && "Every lane equals a single replay"));
+        }
+    }
+
+    Tape switching;
+    switching.record(Switching(), 0., {1., 0.});
+    vec ts = {0., 0.}, ys = {1., -1., 0., 0.}, fs(4);
+    assert((!switching.forward_lanes(ts.data(), ys.data(), fs.data(), 2) && "A lane on another branch is detected"));
+}
+
+void test_outside_recording(){
+    bool thrown = false;
+    try{
+        TapeScalar x(1.);
+    }
+    catch (const std::logic_error&){
+        thrown = true;
+    }
+    assert((thrown && "TapeScalar needs a recording tape"));
+}
+
+// Reaction-diffusion on a line, tridiagonal Jacobian
+struct Diffusion {
+    template <typename T>
+    void operator()(const T& t, const std::vector<T>& y, std::vector<T>& dydt) const {
+        const size_t n = y.size();
+        for (size_t i = 0; i < n; ++i){
+            dydt[i] = -2.*y[i] - y[i]*y[i]*y[i] + sin(t);
+            if (i > 0){
+                dydt[i] += y[i-1];
+            }
+            if (i + 1 < n){
+                dydt[i] += y[i+1];
+            }
+        }
+    }
+};
+
+void test_sparsity(){
+    const size_t n = 40;
+    vec y(n);
+    for (size_t i = 0; i < n; ++i){
+        y[i] = std::cos(0.3*i);
+    }
+    Tape tape;
+    tape.record(Diffusion(), 0.5, y);
+    const auto& pattern = tape.sparsity();
+    assert((pattern.size() == n && "One entry per column"));
+    for (size_t j = 0; j < n; ++j){
+        std::vector<size_t> expected;
+        for (size_t i = (j > 0 ? j-1 : 0); i <= std::min(j+1, n-1); ++i){
+            expected.push_back(i);
+        }
+        assert((pattern[j] == expected && "Tridiagonal pattern from the dependencies, without t"));
+    }
+    vec J;
+    tape.jacobian(J);
+    for (size_t i = 0; i < n; ++i){
+        for (size_t j = 0; j < n; ++j){
+            const double exact = (i == j) ? -2. - 3.*y[i]*y[i] : ((i + 1 == j || j + 1 == i) ? 1. : 0.);
+            assert((_close(J[i*n + j], exact) && "Rows without common columns share a reverse sweep"));
+        }
+    }
+}
+
+template <typename Rhs>
+void test_solve_equals_dual(Rhs rhs, const vec& y0, const char* message){
+    OrangeDrumExplorer::EulerImplicit dual(0., 2.);
+    OrangeDrumExplorer::EulerImplicit taped(0., 2.);
+    vec expected = dual.solve_dual<2>(rhs, y0);
+    vec y = taped.solve_taped(rhs, y0);
+    assert((y.size() == expected.size() && taped.get_state_size() == y0.size() && "Taped solution stores the full state"));
+    for (size_t i = 0; i < y.size(); ++i){
+        assert((_close(y[i], expected[i], 1e-10) && message));
+    }
+}
+
+int main(int, char**) {
+    test_replay_matches_dual();
+    test_branches();
+    test_value_guard();
+    test_lanes();
+    test_outside_recording();
+    test_solve_equals_dual(VanDerPol(), {2., 0.}, "Taped Jacobian gives the dual solution");
+    test_solve_equals_dual(Switching(), {0.5, 1.}, "Re-recording on a branch change gives the dual solution");
+    test_sparsity();
+    test_solve_equals_dual(Diffusion(), vec(64, 0.5), "Detected sparsity and sparse LU give the dual solution");
+}
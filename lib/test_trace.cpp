@@ -0,0 +1,79 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cassert>
+#include "Trace.h"
+
+namespace Trace = OrangeDrumExplorer::Trace;
+
+size_t _count(const std::string& text, const std::string& pattern){
+    size_t found = 0;
+    for (size_t pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos+1)){
+        ++found;
+    }
+    return found;
+}
+
+void _traced_work(int steps){
+    ODE_TRACE_SCOPE("work");
+    for (int i = 0; i < steps; ++i){
+        ODE_TRACE_SCOPE("step");
+    }
+}
+
+void test_scopes(){
+    Trace::clear();
+    _traced_work(3);
+    assert((Trace::size()==4 && "Nested scopes are recorded"));
+    std::stringstream json;
+    Trace::write_chrome_json(json);
+    assert((json.str().rfind("{\"displayTimeUnit\"", 0)==0 && "Chrome trace header"));
+    assert((_count(json.str(), "\"name\":\"step\"")==3 && "Step events in the trace"));
+    assert((_count(json.str(), "\"ph\":\"X\"")==4 && "Complete events in the trace"));
+}
+
+void test_threads(){
+    Trace::clear();
+    std::vector<std::thread> workers;
+    for (int i = 0; i < 4; ++i){
+        workers.emplace_back(_traced_work, 10);
+    }
+    for (auto& w : workers){
+        w.join();
+    }
+    assert((Trace::size()==44 && "Events of joined threads are kept"));
+    std::stringstream json;
+    Trace::write_chrome_json(json);
+    assert((_count(json.str(), "\"name\":\"thread_name\"")>=5 && "One track per thread"));
+}
+
+void test_capacity(){
+    Trace::clear();
+    Trace::set_buffer_capacity(4);
+    std::thread worker(_traced_work, 9);
+    worker.join();
+    assert((Trace::size()==4 && "Full buffer stops recording"));
+    assert((Trace::dropped()==6 && "Events which don't fit are counted"));
+    Trace::set_buffer_capacity(1 << 20);
+}
+
+void test_save(){
+    Trace::clear();
+    _traced_work(1);
+    const std::string fname = "test_trace.json";
+    Trace::save(fname);
+    std::ifstream in(fname);
+    std::stringstream json;
+    json << in.rdbuf();
+    assert((_count(json.str(), "\"name\":\"work\"")==1 && "Trace stored to file"));
+}
+
+int main(int, char**) {
+    test_scopes();
+    test_threads();
+    test_capacity();
+    test_save();
+}
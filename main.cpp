@@ -4,6 +4,8 @@
 #include <memory>
 
 #include "Solver.h"
+#include "Exponential.h"
+#include "Trace.h"
 
 // Helper function to see the solution
 template <typename T>
@@ -20,6 +22,7 @@ int main(int, char**) {
     std::cout << "The following solver options are currently available:" << std::endl << std::endl;
     std::cout << "1) Explicit Euler solver" << std::endl;
     std::cout << "2) Implicit Euler solver (using Newton method with automatic derivatives)" << std::endl;
+    std::cout << "3) Exponential integrator (exact steps for linear equations such as this one)" << std::endl;
     std::cout << std::endl << 
     "The test IVP y(t)'' - y(t)' + 3y(t) = t; y(0)=1; y'(0)=-2; will be solved between t=[0,4] in 128 steps." << std::endl;
     std::cout << "y(t=4) will be displayed. The full solution will be stored in 'Example_solution.txt' in your cwd." << std::endl;
@@ -27,7 +30,7 @@ int main(int, char**) {
     int choice = 0;
     try{
         std::cin>>choice;
-        while(std::cin.fail() || !(choice == 1 || choice == 2) ){
+        while(std::cin.fail() || !(choice == 1 || choice == 2 || choice == 3) ){
             std::cin.clear();
             std::cin.ignore(std::numeric_limits<std::streamsize>::max(),'\n');
             std::cout << "Your choice is not valid. Please try again. "<< std::endl;
@@ -57,6 +60,10 @@ int main(int, char**) {
             //Or can be replaced by an Implicit Euler solver using the Bridge Pattern 
             solver = std::make_unique<OrangeDrumExplorer::EulerImplicit>(0., 4.);
             break;
+        case 3:
+            //The equation is linear, which the Exponential solver detects from the Jacobian
+            solver = std::make_unique<OrangeDrumExplorer::Exponential>(0., 4.);
+            break;
         default:
             throw std::invalid_argument("Should never get here.");
         }
@@ -79,6 +86,8 @@ int main(int, char**) {
             std::ofstream outfile("Example_solution.txt");
             solver->save_solution(outfile);
             outfile.close();
+            // Store the timeline of the solver phases if tracing is compiled in
+            ODE_TRACE_SAVE("Example_trace.json");
             // Print the last value to stdout
             std::cout << y1[y1.size()-1] << std::endl;
         }
@@ -0,0 +1,292 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <stdexcept>
+
+#include "Benchmark.h"
+#include "PerfCounters.h"
+
+#ifndef ODE_BUILD_TYPE
+#define ODE_BUILD_TYPE ""
+#endif
+
+namespace OrangeDrumExplorer{
+namespace Benchmark{
+
+    namespace {
+        void write_string(std::ostream& out, const std::string& s){
+            out << '"';
+            for (char c : s){
+                if (c == '"' || c == '\\'){
+                    out << '\\';
+                }
+                out << c;
+            }
+            out << '"';
+        }
+
+        void write_map(std::ostream& out, const std::map<std::string, double>& values){
+            out << "{";
+            bool first = true;
+            for (auto& v : values){
+                out << (first ? "" : ", ");
+                write_string(out, v.first);
+                out << ": " << v.second;
+                first = false;
+            }
+            out << "}";
+        }
+    }
+
+// -------- FunctionScenario ----------------
+
+    FunctionScenario::FunctionScenario(const std::string& name, const std::string& description,
+                                       std::function<std::function<void()>(double)> prepare_function,
+                                       std::function<double(double)> count_steps_function)
+        : scenario_name(name), scenario_description(description),
+          prepare(prepare_function), count_steps(count_steps_function)
+    {}
+
+    std::string FunctionScenario::name() const {
+        return scenario_name;
+    }
+
+    std::string FunctionScenario::description() const {
+        return scenario_description;
+    }
+
+    void FunctionScenario::setup(double scale){
+        timed = prepare(scale);
+        steps = count_steps(scale);
+    }
+
+    void FunctionScenario::run(){
+        timed();
+    }
+
+    std::map<std::string, double> FunctionScenario::metrics() const {
+        return {{"steps", steps}};
+    }
+
+// -------- Statistics ----------------
+
+    Statistics compute_statistics(std::vector<double> samples){
+        Statistics stats;
+        if (samples.empty()){
+            return stats;
+        }
+        std::sort(samples.begin(), samples.end());
+        const size_t n = samples.size();
+        stats.min = samples.front();
+        stats.max = samples.back();
+        stats.mean = std::accumulate(samples.begin(), samples.end(), 0.)/n;
+        stats.median = n%2 ? samples[n/2] : 0.5*(samples[n/2-1] + samples[n/2]);
+        double sum_squares = 0.;
+        for (auto s : samples){
+            sum_squares += (s - stats.mean)*(s - stats.mean);
+        }
+        stats.stddev = n > 1 ? std::sqrt(sum_squares/(n-1)) : 0.;
+        return stats;
+    }
+
+// -------- Options ----------------
+
+    Options parse_options(int argc, char** argv){
+        Options options;
+        for (int i = 1; i < argc; ++i){
+            const std::string arg = argv[i];
+            if (arg == "--list"){
+                options.list = true;
+                continue;
+            }
+            if (arg == "--counters"){
+                options.counters = true;
+                continue;
+            }
+            if (i+1 >= argc){
+                throw std::invalid_argument("Missing value for option " + arg);
+            }
+            const std::string value = argv[++i];
+            if (arg == "--warmup"){
+                options.warmup = std::stoul(value);
+            }
+            else if (arg == "--repetitions"){
+                options.repetitions = std::stoul(value);
+            }
+            else if (arg == "--scale"){
+                options.scale = std::stod(value);
+            }
+            else if (arg == "--filter"){
+                options.filter = value;
+            }
+            else if (arg == "--json"){
+                options.json = value;
+            }
+            else if (arg == "--stream-size"){
+                options.stream_elements = std::stoul(value);
+            }
+            else{
+                throw std::invalid_argument("Unknown option " + arg);
+            }
+        }
+        if (options.repetitions == 0){
+            throw std::invalid_argument("At least one repetition is needed");
+        }
+        if (options.scale <= 0.){
+            throw std::invalid_argument("scale must be larger than 0");
+        }
+        return options;
+    }
+
+// -------- Suite ----------------
+
+    Suite::Suite(const std::string& name)
+        : suite_name(name)
+    {}
+
+    void Suite::add(std::unique_ptr<Scenario> scenario){
+        scenarios.push_back(std::move(scenario));
+    }
+
+    Result Suite::run(Scenario& scenario, const Options& options){
+        Result result;
+        result.name = scenario.name();
+        result.description = scenario.description();
+        result.warmup = options.warmup;
+        result.repetitions = options.repetitions;
+        scenario.setup(options.scale);
+        for (size_t i = 0; i < options.warmup; ++i){
+            scenario.run();
+        }
+        std::unique_ptr<PerfCounters> counters;
+        if (options.counters){
+            counters = std::make_unique<PerfCounters>();
+            counters->start();
+        }
+        for (size_t i = 0; i < options.repetitions; ++i){
+            auto t0 = std::chrono::steady_clock::now();
+            scenario.run();
+            auto t1 = std::chrono::steady_clock::now();
+            result.samples.push_back(std::chrono::duration<double>(t1 - t0).count());
+        }
+        result.statistics = compute_statistics(result.samples);
+        result.metrics = scenario.metrics();
+        if (counters){
+            counters->stop();
+            for (auto& c : counters->read()){
+                result.counters[c.first] = c.second/options.repetitions;
+            }
+            result.roofline = place(result.counters, result.statistics.mean, machine);
+        }
+        return result;
+    }
+
+    std::vector<Result> Suite::run(const Options& options, std::ostream& log){
+        std::vector<Result> results;
+        if (options.counters){
+            machine = measure_machine(options.stream_elements);
+            log << "STREAM triad bandwidth: " << machine.stream_bandwidth*1e-9 << " GB/s, "
+                << "in-cache multiply-add: " << machine.peak_flops*1e-9 << " GFLOP/s" << std::endl;
+            if (!PerfCounters().available()){
+                log << "Hardware counters are not available (see /proc/sys/kernel/perf_event_paranoid)" << std::endl;
+            }
+        }
+        log << std::left << std::setw(24) << "scenario" << std::right
+            << std::setw(12) << "median [s]" << std::setw(12) << "min [s]"
+            << std::setw(12) << "stddev [s]" << std::endl;
+        for (auto& scenario : scenarios){
+            if (scenario->name().find(options.filter) == std::string::npos){
+                continue;
+            }
+            results.push_back(run(*scenario, options));
+            const Statistics& s = results.back().statistics;
+            log << std::left << std::setw(24) << scenario->name() << std::right << std::fixed
+                << std::setprecision(5) << std::setw(12) << s.median << std::setw(12) << s.min
+                << std::setw(12) << s.stddev << std::defaultfloat << std::endl;
+            for (auto* values : {&results.back().counters, &results.back().roofline}){
+                for (auto& v : *values){
+                    log << "    " << std::left << std::setw(22) << v.first << std::right << v.second << std::endl;
+                }
+            }
+        }
+        return results;
+    }
+
+    void Suite::write_json(std::ostream& out, const Options& options, const std::vector<Result>& results) const {
+        out << std::setprecision(9);
+        out << "{" << std::endl;
+        out << "  \"suite\": ";
+        write_string(out, suite_name);
+        out << "," << std::endl << "  \"build_type\": ";
+        write_string(out, ODE_BUILD_TYPE);
+        out << "," << std::endl << "  \"compiler\": ";
+        write_string(out, __VERSION__);
+        out << "," << std::endl << "  \"scale\": " << options.scale << "," << std::endl;
+        if (options.counters){
+            out << "  \"machine\": {\"stream_bandwidth\": " << machine.stream_bandwidth
+                << ", \"peak_flops\": " << machine.peak_flops << "}," << std::endl;
+        }
+        out << "  \"scenarios\": [";
+        for (size_t i = 0; i < results.size(); ++i){
+            const Result& r = results[i];
+            out << (i ? "," : "") << std::endl << "    {\"name\": ";
+            write_string(out, r.name);
+            out << ", \"description\": ";
+            write_string(out, r.description);
+            out << "," << std::endl << "     \"warmup\": " << r.warmup
+                << ", \"repetitions\": " << r.repetitions
+                << ", \"min\": " << r.statistics.min << ", \"max\": " << r.statistics.max
+                << ", \"mean\": " << r.statistics.mean << ", \"median\": " << r.statistics.median
+                << ", \"stddev\": " << r.statistics.stddev << "," << std::endl << "     \"samples\": [";
+            for (size_t j = 0; j < r.samples.size(); ++j){
+                out << (j ? ", " : "") << r.samples[j];
+            }
+            out << "]," << std::endl << "     \"metrics\": ";
+            write_map(out, r.metrics);
+            if (options.counters){
+                out << "," << std::endl << "     \"counters\": ";
+                write_map(out, r.counters);
+                out << "," << std::endl << "     \"roofline\": ";
+                write_map(out, r.roofline);
+            }
+            out << "}";
+        }
+        out << std::endl << "  ]" << std::endl << "}" << std::endl;
+    }
+
+    int Suite::main(int argc, char** argv){
+        try{
+            Options options = parse_options(argc, argv);
+            if (options.list){
+                for (auto& scenario : scenarios){
+                    std::cout << scenario->name() << ": " << scenario->description() << std::endl;
+                }
+                return 0;
+            }
+            std::vector<Result> results = run(options, std::cout);
+            if (!options.json.empty()){
+                std::ofstream out(options.json);
+                if (!out.is_open()){
+                    std::cerr << "Couldn't open " << options.json << std::endl;
+                    return -1;
+                }
+                write_json(out, options, results);
+            }
+        }
+        catch (std::invalid_argument& e){
+            std::cerr << e.what() << std::endl;
+            return -1;
+        }
+        catch (const std::exception& e){
+            std::cerr << "An unknown exception occured: " << e.what() << std::endl;
+            return -2;
+        }
+        return 0;
+    }
+
+}
+}
@@ -0,0 +1,132 @@
+#ifndef ORANGE_DRUM_EXPLORER_BENCHMARK_H
+#define ORANGE_DRUM_EXPLORER_BENCHMARK_H
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "Roofline.h"
+
+namespace OrangeDrumExplorer
+{
+namespace Benchmark
+{
+    /**
+     * A single benchmark scenario.\n
+     *
+     * setup() prepares the data and is not timed, run() is timed on every repetition.
+     *
+     * @param scale - factor applied to the problem size (e.g. number of steps), 1 reproduces the reference scenario
+     */
+    class Scenario
+    {
+        public:
+            virtual ~Scenario() = default;
+            virtual std::string name() const = 0;
+            virtual std::string description() const = 0;
+            // Untimed preparation, called once before the warmup
+            virtual void setup(double scale) {}
+            // Timed part, called for every warmup run and repetition
+            virtual void run() = 0;
+            // Scenario specific numbers stored together with the timings (e.g. number of steps)
+            virtual std::map<std::string, double> metrics() const { return {}; }
+    };
+
+    // Scenario defined by two lambda functions
+    class FunctionScenario : public Scenario
+    {
+        protected:
+            std::string scenario_name;
+            std::string scenario_description;
+            std::function<std::function<void()>(double)> prepare;
+            std::function<void()> timed;
+            double steps = 0;
+            std::function<double(double)> count_steps;
+        public:
+            /**
+             * @param prepare(scale) - untimed setup returning the timed function
+             * @param count_steps(scale) - number of solver steps of the timed function
+             */
+            FunctionScenario(const std::string& name, const std::string& description,
+                             std::function<std::function<void()>(double)> prepare,
+                             std::function<double(double)> count_steps);
+            std::string name() const override;
+            std::string description() const override;
+            void setup(double scale) override;
+            void run() override;
+            std::map<std::string, double> metrics() const override;
+    };
+
+    struct Statistics
+    {
+        double min = 0.;
+        double max = 0.;
+        double mean = 0.;
+        double median = 0.;
+        double stddev = 0.;
+    };
+
+    // Compute statistics of the timing samples
+    Statistics compute_statistics(std::vector<double> samples);
+
+    struct Result
+    {
+        std::string name;
+        std::string description;
+        size_t warmup = 0;
+        size_t repetitions = 0;
+        // wall time of each repetition in seconds
+        std::vector<double> samples;
+        Statistics statistics;
+        std::map<std::string, double> metrics;
+        // hardware counters per repetition, empty if not measured
+        std::map<std::string, double> counters;
+        // placement in the roofline model, see Roofline.h
+        std::map<std::string, double> roofline;
+    };
+
+    struct Options
+    {
+        size_t warmup = 1;
+        size_t repetitions = 5;
+        double scale = 1.;
+        // only run scenarios with names containing the filter
+        std::string filter;
+        // store the results as JSON to this file
+        std::string json;
+        bool list = false;
+        // read the hardware counters and place the scenarios in the roofline model
+        bool counters = false;
+        // size of the STREAM arrays measuring the memory bandwidth
+        size_t stream_elements = 1 << 23;
+    };
+
+    // Parse --warmup N --repetitions N --scale X --filter S --json FILE --list --counters --stream-size N
+    Options parse_options(int argc, char** argv);
+
+    class Suite
+    {
+        protected:
+            std::string suite_name;
+            std::vector<std::unique_ptr<Scenario>> scenarios;
+            // only measured if counters are requested
+            Machine machine;
+        public:
+            explicit Suite(const std::string& name);
+            void add(std::unique_ptr<Scenario> scenario);
+            // Run a single scenario: setup, warmup, timed repetitions
+            Result run(Scenario& scenario, const Options& options);
+            // Run all scenarios selected by the options and report to the stream
+            std::vector<Result> run(const Options& options, std::ostream& log);
+            // Serialize results as JSON
+            void write_json(std::ostream& out, const Options& options, const std::vector<Result>& results) const;
+            // Command line entry point
+            int main(int argc, char** argv);
+    };
+}
+}
+
+#endif /*ORANGE_DRUM_EXPLORER_BENCHMARK_H*/
@@ -0,0 +1,153 @@
+#include <cctype>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include "Json.h"
+
+namespace OrangeDrumExplorer{
+namespace Benchmark{
+
+    namespace {
+        class Parser {
+            private:
+                std::istream& in;
+
+                void skip_whitespace(){
+                    while (std::isspace(in.peek())){
+                        in.get();
+                    }
+                }
+
+                void expect(char c){
+                    skip_whitespace();
+                    if (in.get() != c){
+                        throw std::invalid_argument(std::string("Malformed JSON, expected ") + c);
+                    }
+                }
+
+                void expect_word(const std::string& word){
+                    for (char c : word){
+                        if (in.get() != c){
+                            throw std::invalid_argument("Malformed JSON, expected " + word);
+                        }
+                    }
+                }
+
+                std::string parse_string(){
+                    expect('"');
+                    std::string s;
+                    for (int c = in.get(); c != '"'; c = in.get()){
+                        if (c == EOF){
+                            throw std::invalid_argument("Malformed JSON, unterminated string");
+                        }
+                        if (c == '\\'){
+                            c = in.get();
+                            switch (c){
+                                case 'n': c = '\n'; break;
+                                case 't': c = '\t'; break;
+                                case 'r': c = '\r'; break;
+                                case 'b': c = '\b'; break;
+                                case 'f': c = '\f'; break;
+                                case 'u': throw std::invalid_argument("Unicode escapes are not supported");
+                                default: break;
+                            }
+                        }
+                        s.push_back(static_cast<char>(c));
+                    }
+                    return s;
+                }
+
+            public:
+                explicit Parser(std::istream& input)
+                    : in(input)
+                {}
+
+                Json parse_value(){
+                    Json value;
+                    skip_whitespace();
+                    const int c = in.peek();
+                    if (c == '{'){
+                        value.type = Json::Type::Object;
+                        in.get();
+                        skip_whitespace();
+                        if (in.peek() == '}'){
+                            in.get();
+                            return value;
+                        }
+                        while (true){
+                            std::string key = parse_string();
+                            expect(':');
+                            value.object[key] = parse_value();
+                            skip_whitespace();
+                            if (in.peek() != ','){
+                                break;
+                            }
+                            in.get();
+                        }
+                        expect('}');
+                    }
+                    else if (c == '['){
+                        value.type = Json::Type::Array;
+                        in.get();
+                        skip_whitespace();
+                        if (in.peek() == ']'){
+                            in.get();
+                            return value;
+                        }
+                        while (true){
+                            value.array.push_back(parse_value());
+                            skip_whitespace();
+                            if (in.peek() != ','){
+                                break;
+                            }
+                            in.get();
+                        }
+                        expect(']');
+                    }
+                    else if (c == '"'){
+                        value.type = Json::Type::String;
+                        value.string = parse_string();
+                    }
+                    else if (c == 't' || c == 'f'){
+                        value.type = Json::Type::Bool;
+                        value.boolean = c == 't';
+                        expect_word(value.boolean ? "true" : "false");
+                    }
+                    else if (c == 'n'){
+                        expect_word("null");
+                    }
+                    else{
+                        value.type = Json::Type::Number;
+                        if (!(in >> value.number)){
+                            throw std::invalid_argument("Malformed JSON, expected a value");
+                        }
+                    }
+                    return value;
+                }
+        };
+    }
+
+    Json Json::parse(std::istream& in){
+        Parser parser(in);
+        return parser.parse_value();
+    }
+
+    Json Json::parse_file(const std::string& filename){
+        std::ifstream in(filename);
+        if (!in.is_open()){
+            throw std::invalid_argument("Couldn't open " + filename);
+        }
+        return parse(in);
+    }
+
+    const Json& Json::operator[](const std::string& key) const {
+        return object.at(key);
+    }
+
+    bool Json::has(const std::string& key) const {
+        return object.count(key) > 0;
+    }
+
+}
+}
@@ -0,0 +1,37 @@
+#ifndef ORANGE_DRUM_EXPLORER_JSON_H
+#define ORANGE_DRUM_EXPLORER_JSON_H
+
+#include <istream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace OrangeDrumExplorer
+{
+namespace Benchmark
+{
+    /**
+     * Minimal JSON document, sufficient to read back the benchmark results.
+     */
+    class Json
+    {
+        public:
+            enum class Type {Null, Bool, Number, String, Array, Object};
+            Type type = Type::Null;
+            bool boolean = false;
+            double number = 0.;
+            std::string string;
+            std::vector<Json> array;
+            std::map<std::string, Json> object;
+
+            // Parse a document, throws std::invalid_argument on malformed input
+            static Json parse(std::istream&);
+            static Json parse_file(const std::string& filename);
+            // Member of an object, throws std::out_of_range if missing
+            const Json& operator[](const std::string& key) const;
+            bool has(const std::string& key) const;
+    };
+}
+}
+
+#endif /*ORANGE_DRUM_EXPLORER_JSON_H*/
@@ -0,0 +1,132 @@
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+#include "PerfCounters.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace OrangeDrumExplorer{
+namespace Benchmark{
+
+#ifdef __linux__
+    namespace {
+        int open_event(std::uint32_t type, std::uint64_t config){
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = type;
+            attr.config = config;
+            attr.disabled = 1;
+            // user space only, allowed with the default perf_event_paranoid level
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+        }
+
+        std::uint64_t cache_miss(std::uint64_t cache){
+            return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        }
+
+        bool is_intel(){
+            std::ifstream cpuinfo("/proc/cpuinfo");
+            std::string line;
+            while (std::getline(cpuinfo, line)){
+                if (line.rfind("vendor_id", 0) == 0){
+                    return line.find("GenuineIntel") != std::string::npos;
+                }
+            }
+            return false;
+        }
+    }
+
+    PerfCounters::PerfCounters(){
+        struct Event {
+            const char* name;
+            std::uint32_t type;
+            std::uint64_t config;
+            double flops_per_count;
+        };
+        std::vector<Event> events = {
+            {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, 0.},
+            {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, 0.},
+            {"l1d_misses", PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_L1D), 0.},
+            {"llc_misses", PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_LL), 0.},
+            {"branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, 0.},
+        };
+        if (is_intel()){
+            // FP_ARITH_INST_RETIRED (event 0xC7) by vector width, FMA instructions count twice
+            events.push_back({"fp_scalar_double", PERF_TYPE_RAW, 0x01C7, 1.});
+            events.push_back({"fp_128b_packed_double", PERF_TYPE_RAW, 0x04C7, 2.});
+            events.push_back({"fp_256b_packed_double", PERF_TYPE_RAW, 0x10C7, 4.});
+            events.push_back({"fp_512b_packed_double", PERF_TYPE_RAW, 0x40C7, 8.});
+        }
+        for (auto& e : events){
+            const int fd = open_event(e.type, e.config);
+            if (fd >= 0){
+                counters.push_back({e.name, fd, e.flops_per_count});
+            }
+        }
+        values.assign(counters.size(), 0.);
+    }
+
+    PerfCounters::~PerfCounters(){
+        for (auto& c : counters){
+            close(c.fd);
+        }
+    }
+
+    void PerfCounters::start(){
+        for (auto& c : counters){
+            ioctl(c.fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(c.fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+
+    void PerfCounters::stop(){
+        for (auto& c : counters){
+            ioctl(c.fd, PERF_EVENT_IOC_DISABLE, 0);
+        }
+        for (size_t i = 0; i < counters.size(); ++i){
+            // value, time enabled, time running
+            std::uint64_t data[3] = {0, 0, 0};
+            if (::read(counters[i].fd, data, sizeof(data)) != sizeof(data) || data[2] == 0){
+                values[i] = 0.;
+                continue;
+            }
+            values[i] = static_cast<double>(data[0])*data[1]/data[2];
+        }
+    }
+#else
+    PerfCounters::PerfCounters() {}
+    PerfCounters::~PerfCounters() {}
+    void PerfCounters::start() {}
+    void PerfCounters::stop() {}
+#endif /*__linux__*/
+
+    bool PerfCounters::available() const {
+        return !counters.empty();
+    }
+
+    std::map<std::string, double> PerfCounters::read() const {
+        std::map<std::string, double> out;
+        for (size_t i = 0; i < counters.size(); ++i){
+            if (counters[i].flops_per_count > 0.){
+                out["fp_ops"] += counters[i].flops_per_count*values[i];
+            }
+            else{
+                out[counters[i].name] = values[i];
+            }
+        }
+        return out;
+    }
+
+}
+}
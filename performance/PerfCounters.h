@@ -0,0 +1,50 @@
+#ifndef ORANGE_DRUM_EXPLORER_PERF_COUNTERS_H
+#define ORANGE_DRUM_EXPLORER_PERF_COUNTERS_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace OrangeDrumExplorer
+{
+namespace Benchmark
+{
+    /**
+     * Hardware performance counters of the calling thread, read through perf_event_open.\n
+     *
+     * Each event is opened on its own, events which the CPU, the kernel or the
+     * permissions (see /proc/sys/kernel/perf_event_paranoid) don't allow are skipped.
+     * Counts are scaled if the kernel had to multiplex the counters.
+     *
+     * Events: cycles, instructions, l1d_misses, llc_misses, branch_misses and
+     * fp_ops (double precision operations, Intel FP_ARITH_INST_RETIRED only)
+     */
+    class PerfCounters
+    {
+        protected:
+            struct Counter {
+                std::string name;
+                int fd;
+                // FLOPs per counted instruction, 0 for regular events
+                double flops_per_count;
+            };
+            std::vector<Counter> counters;
+            std::vector<double> values;
+        public:
+            PerfCounters();
+            ~PerfCounters();
+            PerfCounters(const PerfCounters&) = delete;
+            PerfCounters& operator=(const PerfCounters&) = delete;
+            // At least one counter could be opened
+            bool available() const;
+            // Reset and start counting
+            void start();
+            // Stop counting and store the values
+            void stop();
+            // Counted events, fp_ops summed over the vector widths
+            std::map<std::string, double> read() const;
+    };
+}
+}
+
+#endif /*ORANGE_DRUM_EXPLORER_PERF_COUNTERS_H*/
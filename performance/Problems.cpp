@@ -0,0 +1,274 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "Problems.h"
+
+namespace OrangeDrumExplorer{
+namespace Benchmark{
+
+    namespace {
+        // The RHS are templates over double and adouble. Mathematical functions are
+        // called unqualified, adept defines its overloads in the global namespace.
+
+        // y'' - y' + 3y = t, the demo equation of main.cpp
+        struct Demo {
+            template <typename T>
+            T operator()(const T& t, const std::vector<T>& y) const {
+                return t + y[1] - 3.0*y[0];
+            }
+        };
+
+        // y'' = -y
+        struct Oscillator {
+            template <typename T>
+            T operator()(const T& t, const std::vector<T>& y) const {
+                return -y[0];
+            }
+        };
+
+        // y' = lambda*(y - cos t) - sin t with the smooth solution y = cos t
+        struct ProtheroRobinson {
+            double lambda = -1e4;
+            template <typename T>
+            T operator()(const T& t, const std::vector<T>& y) const {
+                return lambda*(y[0] - cos(t)) - sin(t);
+            }
+        };
+
+        // y'' = mu*(1 - y^2)*y' - y
+        struct VanDerPol {
+            double mu = 1e3;
+            template <typename T>
+            T operator()(const T& t, const std::vector<T>& y) const {
+                return mu*(1.0 - y[0]*y[0])*y[1] - y[0];
+            }
+        };
+
+        struct Robertson {
+            template <typename T>
+            void operator()(const T& t, const std::vector<T>& y, std::vector<T>& dydt) const {
+                dydt[0] = -0.04*y[0] + 1e4*y[1]*y[2];
+                dydt[1] = 0.04*y[0] - 1e4*y[1]*y[2] - 3e7*y[1]*y[1];
+                dydt[2] = 3e7*y[1]*y[1];
+            }
+        };
+
+        // High irradiance response of photomorphogenesis (8 equations)
+        struct Hires {
+            template <typename T>
+            void operator()(const T& t, const std::vector<T>& y, std::vector<T>& dydt) const {
+                dydt[0] = -1.71*y[0] + 0.43*y[1] + 8.32*y[2] + 0.0007;
+                dydt[1] = 1.71*y[0] - 8.75*y[1];
+                dydt[2] = -10.03*y[2] + 0.43*y[3] + 0.035*y[4];
+                dydt[3] = 8.32*y[1] + 1.71*y[2] - 1.12*y[3];
+                dydt[4] = -1.745*y[4] + 0.43*y[5] + 0.43*y[6];
+                dydt[5] = -280.0*y[5]*y[7] + 0.69*y[3] + 1.71*y[4] - 0.43*y[5] + 0.69*y[6];
+                dydt[6] = 280.0*y[5]*y[7] - 1.81*y[6];
+                dydt[7] = -dydt[6];
+            }
+        };
+
+        // Brusselator reaction with A = 1, B = 3
+        struct Brusselator {
+            template <typename T>
+            void operator()(const T& t, const std::vector<T>& y, std::vector<T>& dydt) const {
+                dydt[0] = 1.0 + y[0]*y[0]*y[1] - 4.0*y[0];
+                dydt[1] = 3.0*y[0] - y[0]*y[0]*y[1];
+            }
+        };
+
+        // Brusselator with diffusion on m interior points of [0, 1], u and v interleaved
+        struct Brusselator1D {
+            double alpha = 0.02;
+            template <typename T>
+            void operator()(const T& t, const std::vector<T>& y, std::vector<T>& dydt) const {
+                const size_t m = y.size()/2;
+                const double c = alpha*(m+1)*(m+1);
+                for (size_t i = 0; i < m; ++i){
+                    const T u = y[2*i];
+                    const T v = y[2*i+1];
+                    const T u_left = i > 0 ? y[2*i-2] : T(1.0);
+                    const T u_right = i+1 < m ? y[2*i+2] : T(1.0);
+                    const T v_left = i > 0 ? y[2*i-1] : T(3.0);
+                    const T v_right = i+1 < m ? y[2*i+3] : T(3.0);
+                    dydt[2*i] = 1.0 + u*u*v - 4.0*u + c*(u_left - 2.0*u + u_right);
+                    dydt[2*i+1] = 3.0*u - u*u*v + c*(v_left - 2.0*v + v_right);
+                }
+            }
+        };
+
+        struct Lorenz {
+            template <typename T>
+            void operator()(const T& t, const std::vector<T>& y, std::vector<T>& dydt) const {
+                dydt[0] = 10.0*(y[1] - y[0]);
+                dydt[1] = y[0]*(28.0 - y[2]) - y[1];
+                dydt[2] = y[0]*y[1] - 8.0/3.0*y[2];
+            }
+        };
+
+        // 7 bodies in the plane with masses 1..7: positions x, y then velocities x, y
+        struct Pleiades {
+            template <typename T>
+            void operator()(const T& t, const std::vector<T>& y, std::vector<T>& dydt) const {
+                for (size_t i = 0; i < 7; ++i){
+                    dydt[i] = y[14+i];
+                    dydt[7+i] = y[21+i];
+                    dydt[14+i] = 0.0;
+                    dydt[21+i] = 0.0;
+                }
+                for (size_t i = 0; i < 7; ++i){
+                    for (size_t j = 0; j < 7; ++j){
+                        if (i == j){
+                            continue;
+                        }
+                        const T dx = y[j] - y[i];
+                        const T dy = y[7+j] - y[7+i];
+                        const T r2 = dx*dx + dy*dy;
+                        const T r3 = r2*sqrt(r2);
+                        dydt[14+i] += (j+1.0)*dx/r3;
+                        dydt[21+i] += (j+1.0)*dy/r3;
+                    }
+                }
+            }
+        };
+
+        // Companion system of an n-th order equation
+        template <typename Rhs, typename T>
+        void companion(const Rhs& rhs, const T& t, const std::vector<T>& y, std::vector<T>& dydt){
+            const size_t n = y.size();
+            for (size_t j = 0; j + 1 < n; ++j){
+                dydt[j] = y[j+1];
+            }
+            dydt[n-1] = rhs(t, y);
+        }
+
+        template <typename Rhs>
+        Problem scalar_problem(const std::string& name, const std::string& description, bool stiff,
+                               double t_end, vec y0, vec reference, size_t steps, Rhs rhs = Rhs()){
+            Problem p;
+            p.name = name;
+            p.description = description;
+            p.stiff = stiff;
+            p.t_end = t_end;
+            p.y0 = y0;
+            p.reference = reference;
+            p.steps = steps;
+            p.scalar = [rhs](double t, const vec& y){ return rhs(t, y); };
+            p.adscalar = [rhs](adouble t, const advec& y){ return rhs(t, y); };
+            p.system = [rhs](double t, const vec& y, vec& dydt){ companion(rhs, t, y, dydt); };
+            p.adsystem = [rhs](adouble t, const advec& y, advec& dydt){ companion(rhs, t, y, dydt); };
+            return p;
+        }
+
+        template <typename Rhs>
+        Problem system_problem(const std::string& name, const std::string& description, bool stiff,
+                               double t_end, vec y0, vec reference, size_t steps, Rhs rhs = Rhs()){
+            Problem p;
+            p.name = name;
+            p.description = description;
+            p.stiff = stiff;
+            p.t_end = t_end;
+            p.y0 = y0;
+            p.reference = reference;
+            p.steps = steps;
+            p.system = [rhs](double t, const vec& y, vec& dydt){ rhs(t, y, dydt); };
+            p.adsystem = [rhs](adouble t, const advec& y, advec& dydt){ rhs(t, y, dydt); };
+            return p;
+        }
+
+        vec brusselator_1d_y0(size_t m){
+            const double pi = std::acos(-1.);
+            vec y0(2*m);
+            for (size_t i = 0; i < m; ++i){
+                y0[2*i] = 1. + std::sin(2*pi*(i+1.)/(m+1));
+                y0[2*i+1] = 3.;
+            }
+            return y0;
+        }
+
+        double demo_solution(double t){
+            // particular solution t/3 + 1/9 and the growing oscillation of y'' - y' + 3y = 0
+            const double w = std::sqrt(11.)/2;
+            return t/3 + 1./9 + std::exp(t/2)*(8./9*std::cos(w*t) - 25./(9*w)*std::sin(w*t));
+        }
+    }
+
+    std::vector<Problem> corpus(){
+        std::vector<Problem> problems;
+        problems.push_back(scalar_problem<Demo>("demo",
+            "y'' - y' + 3y = t of main.cpp, analytic solution", false,
+            4., {1., -2.}, {demo_solution(4.)}, 128));
+        problems.push_back(scalar_problem<Oscillator>("oscillator",
+            "Harmonic oscillator y'' = -y, analytic solution", false,
+            10., {1., 0.}, {std::cos(10.)}, 100));
+        problems.push_back(scalar_problem<ProtheroRobinson>("prothero_robinson",
+            "y' = -1e4 (y - cos t) - sin t, stiff with the analytic solution cos t", true,
+            10., {1.}, {std::cos(10.)}, 100));
+        problems.push_back(scalar_problem<VanDerPol>("vanderpol",
+            "Van der Pol oscillator with mu = 1e3 over one relaxation", true,
+            1000., {2., 0.}, {-1.8636462548084904e+00, 7.5354308654328151e-04}, 1000));
+        problems.push_back(system_problem<Robertson>("robertson",
+            "Robertson chemical kinetics", true,
+            40., {1., 0., 0.},
+            {7.1582706871969670e-01, 9.1855347645693195e-06, 2.8416374574554065e-01}, 400));
+        problems.push_back(system_problem<Hires>("hires",
+            "High irradiance response, 8 equations", true,
+            321.8122, {1., 0., 0., 0., 0., 0., 0., 0.0057},
+            {7.3713125733076003e-04, 1.4424857263126175e-04, 5.8887297409342292e-05, 1.1756513432797414e-03,
+             2.3863561987785371e-03, 6.2389682525811159e-03, 2.8499983951461869e-03, 2.8500016048538428e-03}, 1000));
+        problems.push_back(system_problem<Brusselator>("brusselator",
+            "Brusselator reaction A = 1, B = 3", false,
+            20., {1.5, 3.}, {4.9863707126832985e-01, 4.5967803494520165e+00}, 200));
+        problems.push_back(system_problem<Brusselator1D>("brusselator_1d",
+            "Brusselator with diffusion alpha = 1/50 on 32 grid points, 64 equations", true,
+            10., brusselator_1d_y0(32),
+            {9.2171999756340917e-01, 3.0988158709846383e+00, 8.4631393280602019e-01, 3.1938982018775692e+00,
+             7.7608845843203478e-01, 3.2821827586722843e+00, 7.1262458334553058e-01, 3.3615077890739968e+00,
+             6.5676461735911495e-01, 3.4306678723533741e+00, 6.0871036135160672e-01, 3.4893233402152526e+00,
+             5.6818133810908023e-01, 3.5378227443531598e+00, 5.3458550755068002e-01, 3.5769947503275334e+00,
+             5.0717026276145405e-01, 3.6079505350920722e+00, 4.8513865756705393e-01, 3.6319190700431965e+00,
+             4.6772886042500084e-01, 3.6501224351908119e+00, 4.5426221098942399e-01, 3.6636887721864930e+00,
+             4.4416799865083206e-01, 3.6735959936426656e+00, 4.3699297631979261e-01, 3.6806382579269412e+00,
+             4.3240220526991391e-01, 3.6854079291500850e+00, 4.3017607514756323e-01, 3.6882872010333418e+00,
+             4.3020673585166375e-01, 3.6894451831908688e+00, 4.3249586336960666e-01, 3.6888377808749513e+00,
+             4.3715462764883573e-01, 3.6862090936768768e+00, 4.4440582164614278e-01, 3.6810943625268817e+00,
+             4.5458720182278461e-01, 3.6728257929038781e+00, 4.6815403871756012e-01, 3.6605439588974313e+00,
+             4.8567757334944550e-01, 3.6432189891220763e+00, 5.0783450208176550e-01, 3.6196872896715298e+00,
+             5.3538093770407402e-01, 3.5887109069069854e+00, 5.6910302034168669e-01, 3.5490671689020541e+00,
+             6.0973647145374399e-01, 3.4996748928845265e+00, 6.5785041569243374e-01, 3.4397586781529661e+00,
+             7.1369843112211939e-01, 3.3690430698867706e+00, 7.7705284260528951e-01, 3.2879532542240586e+00,
+             8.4705490641820924e-01, 3.1977809591586208e+00, 9.2212764594252206e-01, 3.1007604045020485e+00}, 200));
+        problems.push_back(system_problem<Lorenz>("lorenz",
+            "Lorenz attractor sigma = 10, rho = 28, beta = 8/3 over a short horizon", false,
+            2., {1., 1., 1.}, {-8.1734999322418798e+00, -9.5620236867987369e+00, 2.4620702049678993e+01}, 200));
+        problems.push_back(system_problem<Pleiades>("pleiades",
+            "Pleiades: 7 bodies in the plane, 28 equations", false,
+            3., {3., 3., -1., -3., 2., -2., 2.,
+                 3., -3., 2., 0., 0., -4., 4.,
+                 0., 0., 0., 0., 0., 1.75, -1.5,
+                 0., 0., 0., -1.25, 1., 0., 0.},
+            {3.7061391439001889e-01, 3.2372840920575565e+00, -3.2225590324209916e+00, 6.5970914557869087e-01,
+             3.4255817071715661e-01, 1.5621721014007950e+00, -7.0030929222107319e-01, -3.9434375855144523e+00,
+             -3.2713809739720991e+00, 5.2250818434470236e+00, -2.5906124349777091e+00, 1.1982136933946410e+00,
+             -2.4296823449382110e-01, 1.0914492404311662e+00, 3.4170038063029220e+00, 1.3545845016257996e+00,
+             -2.5900655978097835e+00, 2.0250537347169564e+00, -1.1558151001557173e+00, -8.0729881702144501e-01,
+             5.9523963541632074e-01, -3.7412449612386167e+00, 3.7734596857559050e-01, 9.3868588694686383e-01,
+             3.6679222272110984e-01, -3.4740463537663258e-01, 2.3449154481805556e+00, -1.9470204342625363e+00}, 300));
+        return problems;
+    }
+
+    double solution_error(const Problem& problem, const vec& y, double floor){
+        const size_t n = std::min(y.size(), problem.reference.size());
+        double error = 0.;
+        for (size_t i = 0; i < n; ++i){
+            if (!std::isfinite(y[i])){
+                return std::numeric_limits<double>::infinity();
+            }
+            error = std::max(error, std::abs(y[i] - problem.reference[i])/std::max(std::abs(problem.reference[i]), floor));
+        }
+        return error;
+    }
+
+}
+}
@@ -0,0 +1,56 @@
+#ifndef ORANGE_DRUM_EXPLORER_PROBLEMS_H
+#define ORANGE_DRUM_EXPLORER_PROBLEMS_H
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "Solver.h"
+
+namespace OrangeDrumExplorer
+{
+namespace Benchmark
+{
+    /**
+     * Initial value problem of the work-precision corpus.\n
+     *
+     * Every problem is available as first-order system y' = f(t, y). Problems which
+     * are a single n-th order equation are additionally available in the scalar form
+     * of the Solver interface, where y0 holds the function and its n-1 lowest derivatives.
+     * The reference is the solution at t_end, analytic or computed by reference_solutions.py
+     */
+    struct Problem
+    {
+        std::string name;
+        std::string description;
+        bool stiff = false;
+        double t0 = 0.;
+        double t_end = 1.;
+        vec y0;
+        vec reference;
+        // number of steps of the coarsest fixed step run
+        size_t steps = 100;
+        // n-th order scalar form, empty if the problem is only a system
+        func scalar;
+        adfunc adscalar;
+        // first-order system form
+        std::function<void(double, const vec&, vec&)> system;
+        std::function<void(adouble, const advec&, advec&)> adsystem;
+
+        bool has_scalar_form() const { return static_cast<bool>(scalar); }
+    };
+
+    // All problems of the corpus
+    std::vector<Problem> corpus();
+
+    /**
+     * Mixed relative error of a solution at t_end.\n
+     *
+     * max_i |y_i - ref_i|/max(|ref_i|, floor), infinite if the solution isn't finite.
+     * For the scalar form only the function value y[0] is compared.
+     */
+    double solution_error(const Problem& problem, const vec& y, double floor = 1e-10);
+}
+}
+
+#endif /*ORANGE_DRUM_EXPLORER_PROBLEMS_H*/
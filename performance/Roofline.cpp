@@ -0,0 +1,93 @@
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <vector>
+
+#include "Roofline.h"
+
+namespace OrangeDrumExplorer{
+namespace Benchmark{
+
+    namespace {
+        const double cache_line = 64.;
+
+        // Best of several runs of the STREAM triad a = b + s*c
+        double stream_triad(size_t n){
+            std::vector<double> a(n, 0.), b(n, 1.), c(n, 2.);
+            volatile double scalar = 3.;
+            const double s = scalar;
+            double best = std::numeric_limits<double>::max();
+            for (int rep = 0; rep < 5; ++rep){
+                auto t0 = std::chrono::steady_clock::now();
+                for (size_t i = 0; i < n; ++i){
+                    a[i] = b[i] + s*c[i];
+                }
+                auto t1 = std::chrono::steady_clock::now();
+                best = std::min(best, std::chrono::duration<double>(t1 - t0).count());
+            }
+            volatile double sink = a[n/2];
+            (void)sink;
+            // STREAM counts two loads and one store, without write allocate
+            return 3.*sizeof(double)*n/best;
+        }
+
+        // Independent multiply-add chains on an L1 resident array
+        double multiply_add(){
+            const size_t n = 512;
+            const size_t reps = 20000;
+            std::vector<double> x(n, 1.);
+            volatile double va = 0.999999, vb = 1e-6;
+            const double a = va, b = vb;
+            double best = std::numeric_limits<double>::max();
+            for (int trial = 0; trial < 3; ++trial){
+                auto t0 = std::chrono::steady_clock::now();
+                for (size_t r = 0; r < reps; ++r){
+                    for (size_t i = 0; i < n; ++i){
+                        x[i] = x[i]*a + b;
+                    }
+                }
+                auto t1 = std::chrono::steady_clock::now();
+                best = std::min(best, std::chrono::duration<double>(t1 - t0).count());
+            }
+            volatile double sink = x[n/2];
+            (void)sink;
+            return 2.*n*reps/best;
+        }
+    }
+
+    Machine measure_machine(size_t stream_elements){
+        Machine machine;
+        machine.stream_bandwidth = stream_triad(stream_elements);
+        machine.peak_flops = multiply_add();
+        return machine;
+    }
+
+    std::map<std::string, double> place(const std::map<std::string, double>& counters, double seconds,
+                                        const Machine& machine){
+        std::map<std::string, double> out;
+        if (seconds <= 0. || counters.count("llc_misses") == 0){
+            return out;
+        }
+        const double bytes = cache_line*counters.at("llc_misses");
+        out["bytes"] = bytes;
+        out["bandwidth"] = bytes/seconds;
+        out["bandwidth_fraction"] = bytes/seconds/machine.stream_bandwidth;
+        if (counters.count("fp_ops") == 0 || counters.at("fp_ops") <= 0.){
+            return out;
+        }
+        const double flops = counters.at("fp_ops");
+        out["flops"] = flops;
+        out["gflops"] = flops/seconds*1e-9;
+        if (bytes > 0.){
+            const double intensity = flops/bytes;
+            const double attainable = std::min(machine.peak_flops, intensity*machine.stream_bandwidth);
+            out["arithmetic_intensity"] = intensity;
+            out["attainable_gflops"] = attainable*1e-9;
+            out["roofline_fraction"] = flops/seconds/attainable;
+            out["memory_bound"] = intensity*machine.stream_bandwidth < machine.peak_flops;
+        }
+        return out;
+    }
+
+}
+}
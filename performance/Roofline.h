@@ -0,0 +1,44 @@
+#ifndef ORANGE_DRUM_EXPLORER_ROOFLINE_H
+#define ORANGE_DRUM_EXPLORER_ROOFLINE_H
+
+#include <cstddef>
+#include <map>
+#include <string>
+
+namespace OrangeDrumExplorer
+{
+namespace Benchmark
+{
+    // Single core limits of the machine running the benchmarks
+    struct Machine
+    {
+        // STREAM triad bandwidth in bytes/s
+        double stream_bandwidth = 0.;
+        // floating point operations per second of an in-cache multiply-add kernel
+        double peak_flops = 0.;
+    };
+
+    /**
+     * Measure the roofs of the machine.\n
+     *
+     * @param stream_elements - size of each of the three STREAM arrays, should be well beyond the last level cache
+     */
+    Machine measure_machine(size_t stream_elements);
+
+    /**
+     * Place a measurement in the roofline model of the machine.\n
+     *
+     * Memory traffic is estimated as one cache line per last level cache miss.
+     * The entries depending on fp_ops are only computed if the counter is available.
+     *
+     * @param counters - hardware counters per repetition (see PerfCounters)
+     * @param seconds - wall time per repetition
+     * @return bytes, bandwidth, bandwidth_fraction, and if available flops, gflops,
+     *         arithmetic_intensity, attainable_gflops, roofline_fraction and memory_bound (1 or 0)
+     */
+    std::map<std::string, double> place(const std::map<std::string, double>& counters, double seconds,
+                                        const Machine& machine);
+}
+}
+
+#endif /*ORANGE_DRUM_EXPLORER_ROOFLINE_H*/
@@ -0,0 +1,100 @@
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+
+#include "Json.h"
+
+using OrangeDrumExplorer::Benchmark::Json;
+
+// Compare benchmark results against a baseline and fail if a scenario regressed
+//
+// bench_compare baseline.json results.json [--threshold 0.25] [--strict]
+//
+// Measured scenarios without a baseline are listed; with --strict they fail the comparison as well.
+int main(int argc, char** argv) {
+    if (argc < 3){
+        std::cerr << "Usage: bench_compare baseline.json results.json [--threshold fraction] [--strict]" << std::endl;
+        return -1;
+    }
+    double threshold = 0.25;
+    bool strict = false;
+    for (int i = 3; i < argc; ++i){
+        const std::string option = argv[i];
+        if (option == "--threshold" && i + 1 < argc){
+            threshold = std::stod(argv[++i]);
+        }
+        else if (option == "--strict"){
+            strict = true;
+        }
+        else{
+            std::cerr << "Unknown option " << option << std::endl;
+            return -1;
+        }
+    }
+    try{
+        const Json baseline = Json::parse_file(argv[1]);
+        const Json results = Json::parse_file(argv[2]);
+        if (baseline["build_type"].string != results["build_type"].string){
+            std::cout << "Warning: comparing a " << results["build_type"].string << " build against a "
+                      << baseline["build_type"].string << " baseline" << std::endl;
+        }
+        if (baseline["scale"].number != results["scale"].number){
+            std::cout << "Warning: comparing results at scale " << results["scale"].number
+                      << " against a baseline at scale " << baseline["scale"].number << std::endl;
+        }
+        std::map<std::string, const Json*> measured;
+        for (auto& s : results["scenarios"].array){
+            measured[s["name"].string] = &s;
+        }
+        std::set<std::string> baselined;
+        for (auto& s : baseline["scenarios"].array){
+            baselined.insert(s["name"].string);
+        }
+        int regressions = 0;
+        std::cout << std::left << std::setw(24) << "scenario" << std::right << std::setw(14) << "baseline [s]"
+                  << std::setw(14) << "median [s]" << std::setw(10) << "ratio" << std::endl;
+        for (auto& s : baseline["scenarios"].array){
+            const std::string& name = s["name"].string;
+            if (measured.count(name) == 0){
+                std::cout << std::left << std::setw(24) << name << " not measured" << std::endl;
+                continue;
+            }
+            // the median is robust against single outliers of a noisy machine
+            const double reference = s["median"].number;
+            const double current = (*measured[name])["median"].number;
+            const double ratio = current/reference;
+            const bool regressed = ratio > 1. + threshold;
+            regressions += regressed;
+            std::cout << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(5)
+                      << std::setw(14) << reference << std::setw(14) << current << std::setprecision(3)
+                      << std::setw(10) << ratio << (regressed ? "  REGRESSION" : "") << std::defaultfloat << std::endl;
+        }
+        // a scenario added without refreshing the baseline would never be compared
+        int unbaselined = 0;
+        for (auto& s : results["scenarios"].array){
+            const std::string& name = s["name"].string;
+            if (baselined.count(name) == 0){
+                std::cout << std::left << std::setw(24) << name << " not in the baseline" << std::endl;
+                ++unbaselined;
+            }
+        }
+        if (unbaselined){
+            std::cout << unbaselined << " scenario(s) without baseline, store a new one with the bench_baseline target"
+                      << std::endl;
+        }
+        if (regressions){
+            std::cout << regressions << " scenario(s) regressed by more than " << 100*threshold << "%" << std::endl;
+            return 1;
+        }
+        if (strict && unbaselined){
+            return 1;
+        }
+    }
+    catch (const std::exception& e){
+        std::cerr << "Couldn't compare the benchmark results: " << e.what() << std::endl;
+        return -1;
+    }
+    return 0;
+}
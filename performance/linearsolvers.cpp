@@ -0,0 +1,205 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Solver.h"
+#include "LinearSolver.h"
+
+using namespace OrangeDrumExplorer;
+
+// Cost of one factorization and solve of the Newton matrix dt*J - I by every LinearSolver
+//
+// Two Jacobians: the tridiagonal heat equation, where the banded and sparse solvers pay off, and a dense,
+// symmetric negative definite one. Both make I - dt*J positive definite, so the Cholesky solver applies.
+
+namespace {
+    struct Matrix {
+        std::string name;
+        vec J;
+        Sparsity pattern;
+    };
+
+    Matrix heat(size_t n){
+        Matrix m{"tridiagonal", vec(n*n, 0.), Sparsity(n)};
+        for (size_t i = 0; i < n; ++i){
+            m.J[i*n + i] = -2.;
+            m.pattern[i].push_back(i);
+            if (i > 0){
+                m.J[i*n + i - 1] = 1.;
+                m.pattern[i-1].push_back(i);
+            }
+            if (i + 1 < n){
+                m.J[i*n + i + 1] = 1.;
+                m.pattern[i+1].push_back(i);
+            }
+        }
+        return m;
+    }
+
+    // -exp(-|i - j|/4), the negative of a positive definite kernel
+    Matrix dense(size_t n){
+        Matrix m{"dense", vec(n*n), Sparsity(n)};
+        for (size_t i = 0; i < n; ++i){
+            for (size_t j = 0; j < n; ++j){
+                m.J[i*n + j] = -std::exp(-std::abs(double(i) - double(j))/4.);
+                m.pattern[j].push_back(i);
+            }
+        }
+        return m;
+    }
+
+    struct Strategy {
+        std::string name;
+        std::function<std::shared_ptr<LinearSolver>()> make;
+    };
+
+    std::vector<Strategy> strategies(){
+        return {
+            {"full_piv_lu", [](){ return std::make_shared<FullPivLUSolver>(); }},
+            {"partial_piv_lu", [](){ return std::make_shared<PartialPivLUSolver>(); }},
+            {"cholesky", [](){ return std::make_shared<CholeskySolver>(); }},
+            {"banded_lu", [](){ return std::make_shared<BandedLUSolver>(); }},
+            {"sparse_lu", [](){ return std::make_shared<SparseLUSolver>(); }},
+            {"automatic", [](){ return std::make_shared<AutomaticSolver>(); }},
+        };
+    }
+
+    // Seconds per factorization and solve, the best of the repetitions
+    double measure(LinearSolver& solver, const Matrix& m, size_t n, double min_time, size_t repetitions){
+        const double dt = 0.1;
+        vec b(n), x(n);
+        for (size_t i = 0; i < n; ++i){
+            b[i] = std::cos(0.3*i);
+        }
+        double best = std::numeric_limits<double>::infinity();
+        for (size_t r = 0; r < repetitions; ++r){
+            size_t count = 0;
+            double seconds = 0.;
+            auto t0 = std::chrono::steady_clock::now();
+            do {
+                if (!solver.factorize(m.J, n, dt, m.pattern) || !solver.solve(b, x)){
+                    throw std::runtime_error("The factorization failed");
+                }
+                ++count;
+                seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            } while (seconds < min_time);
+            best = std::min(best, seconds/count);
+        }
+        return best;
+    }
+
+    std::vector<std::string> split(const std::string& list){
+        std::vector<std::string> out;
+        std::stringstream ss(list);
+        std::string item;
+        while (std::getline(ss, item, ',')){
+            out.push_back(item);
+        }
+        return out;
+    }
+
+    struct Point {
+        std::string matrix;
+        std::string solver;
+        size_t n;
+        double seconds;
+    };
+}
+
+int main(int argc, char** argv) {
+    std::vector<size_t> sizes = {2, 5, 10, 20, 50, 100, 200, 500};
+    double min_time = 0.05;
+    size_t repetitions = 3;
+    std::vector<std::string> filter;
+    std::string json;
+    try{
+        for (int i = 1; i < argc; ++i){
+            const std::string arg = argv[i];
+            if (i+1 >= argc){
+                throw std::invalid_argument("Missing value for option " + arg);
+            }
+            const std::string value = argv[++i];
+            if (arg == "--sizes"){
+                sizes.clear();
+                for (auto& s : split(value)){
+                    sizes.push_back(std::stoul(s));
+                }
+            }
+            else if (arg == "--min-time"){
+                min_time = std::stod(value);
+            }
+            else if (arg == "--repetitions"){
+                repetitions = std::stoul(value);
+            }
+            else if (arg == "--solvers"){
+                filter = split(value);
+            }
+            else if (arg == "--json"){
+                json = value;
+            }
+            else{
+                throw std::invalid_argument("Unknown option " + arg);
+            }
+        }
+    }
+    catch (std::exception& e){
+        std::cerr << e.what() << std::endl << "Usage: bench_linear_solvers [--sizes 2,5,10] [--min-time S] "
+                  << "[--repetitions N] [--solvers a,b] [--json FILE]" << std::endl;
+        return -1;
+    }
+
+    std::vector<Strategy> selected;
+    for (const Strategy& s : strategies()){
+        if (filter.empty() || std::find(filter.begin(), filter.end(), s.name) != filter.end()){
+            selected.push_back(s);
+        }
+    }
+
+    std::vector<Point> points;
+    for (auto make_matrix : {heat, dense}){
+        std::cout << make_matrix(1).name << " Jacobian, seconds per factorization and solve" << std::endl
+                  << std::setw(6) << "n";
+        for (const Strategy& s : selected){
+            std::cout << std::setw(16) << s.name;
+        }
+        std::cout << std::endl;
+        for (size_t n : sizes){
+            const Matrix m = make_matrix(n);
+            std::cout << std::setw(6) << n;
+            for (const Strategy& s : selected){
+                auto solver = s.make();
+                const double seconds = measure(*solver, m, n, min_time, repetitions);
+                points.push_back({m.name, s.name, n, seconds});
+                std::cout << std::setw(16) << seconds;
+            }
+            std::cout << std::endl;
+        }
+        std::cout << std::endl;
+    }
+
+    if (!json.empty()){
+        std::ofstream out(json);
+        if (!out.is_open()){
+            std::cerr << "Couldn't open " << json << std::endl;
+            return -1;
+        }
+        out << std::setprecision(9) << "{\"points\": [";
+        for (size_t i = 0; i < points.size(); ++i){
+            const Point& p = points[i];
+            out << (i ? "," : "") << std::endl << "  {\"matrix\": \"" << p.matrix << "\", \"solver\": \"" << p.solver
+                << "\", \"n\": " << p.n << ", \"seconds\": " << p.seconds << "}";
+        }
+        out << std::endl << "]}" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,96 @@
+#!/usr/bin/env python3
+"""Compute the reference solutions of the work-precision corpus (Problems.cpp).
+
+The stiff problems are integrated with scipy's Radau IIA, the others with
+DOP853, both at rtol = atol = 1e-13. Problems with an analytic solution
+are not listed here. Prints the values to paste into Problems.cpp.
+"""
+import numpy as np
+from scipy.integrate import solve_ivp
+
+
+def robertson(t, y):
+    return [-0.04*y[0] + 1e4*y[1]*y[2],
+            0.04*y[0] - 1e4*y[1]*y[2] - 3e7*y[1]**2,
+            3e7*y[1]**2]
+
+
+def vanderpol(t, y, mu=1e3):
+    return [y[1], mu*(1 - y[0]**2)*y[1] - y[0]]
+
+
+def hires(t, y):
+    f = np.empty(8)
+    f[0] = -1.71*y[0] + 0.43*y[1] + 8.32*y[2] + 0.0007
+    f[1] = 1.71*y[0] - 8.75*y[1]
+    f[2] = -10.03*y[2] + 0.43*y[3] + 0.035*y[4]
+    f[3] = 8.32*y[1] + 1.71*y[2] - 1.12*y[3]
+    f[4] = -1.745*y[4] + 0.43*y[5] + 0.43*y[6]
+    f[5] = -280*y[5]*y[7] + 0.69*y[3] + 1.71*y[4] - 0.43*y[5] + 0.69*y[6]
+    f[6] = 280*y[5]*y[7] - 1.81*y[6]
+    f[7] = -f[6]
+    return f
+
+
+def brusselator(t, y, a=1., b=3.):
+    return [a + y[0]**2*y[1] - (b + 1)*y[0], b*y[0] - y[0]**2*y[1]]
+
+
+def brusselator_1d(t, y, m=32, alpha=0.02):
+    # u and v interleaved, Dirichlet boundaries u = 1, v = 3 on x = 0, 1
+    u, v = y[0::2], y[1::2]
+    c = alpha*(m + 1)**2
+    up = np.concatenate(([1.], u, [1.]))
+    vp = np.concatenate(([3.], v, [3.]))
+    f = np.empty_like(y)
+    f[0::2] = 1 + u**2*v - 4*u + c*(up[:-2] - 2*u + up[2:])
+    f[1::2] = 3*u - u**2*v + c*(vp[:-2] - 2*v + vp[2:])
+    return f
+
+
+def brusselator_1d_y0(m=32):
+    x = np.arange(1, m + 1)/(m + 1)
+    y0 = np.empty(2*m)
+    y0[0::2] = 1 + np.sin(2*np.pi*x)
+    y0[1::2] = 3.
+    return y0
+
+
+def lorenz(t, y, sigma=10., rho=28., beta=8./3.):
+    return [sigma*(y[1] - y[0]), y[0]*(rho - y[2]) - y[1], y[0]*y[1] - beta*y[2]]
+
+
+def pleiades(t, y):
+    # positions x (7), y (7), velocities x (7), y (7), masses i
+    x, yy = y[0:7], y[7:14]
+    ax, ay = np.zeros(7), np.zeros(7)
+    for i in range(7):
+        for j in range(7):
+            if i != j:
+                r3 = ((x[i] - x[j])**2 + (yy[i] - yy[j])**2)**1.5
+                ax[i] += (j + 1)*(x[j] - x[i])/r3
+                ay[i] += (j + 1)*(yy[j] - yy[i])/r3
+    return np.concatenate((y[14:21], y[21:28], ax, ay))
+
+
+PLEIADES_Y0 = [3, 3, -1, -3, 2, -2, 2,
+               3, -3, 2, 0, 0, -4, 4,
+               0, 0, 0, 0, 0, 1.75, -1.5,
+               0, 0, 0, -1.25, 1, 0, 0]
+
+PROBLEMS = [
+    ("robertson", robertson, [1., 0., 0.], 40., "Radau"),
+    ("vanderpol", vanderpol, [2., 0.], 1000., "Radau"),
+    ("hires", hires, [1., 0., 0., 0., 0., 0., 0., 0.0057], 321.8122, "Radau"),
+    ("brusselator", brusselator, [1.5, 3.], 20., "DOP853"),
+    ("brusselator_1d", brusselator_1d, brusselator_1d_y0(), 10., "Radau"),
+    ("lorenz", lorenz, [1., 1., 1.], 2., "DOP853"),
+    ("pleiades", pleiades, PLEIADES_Y0, 3., "DOP853"),
+]
+
+if __name__ == "__main__":
+    for name, f, y0, t_end, method in PROBLEMS:
+        sol = solve_ivp(f, (0., t_end), np.asarray(y0, dtype=float), method=method,
+                        rtol=1e-13, atol=1e-13)
+        values = ", ".join("%.16e" % v for v in sol.y[:, -1])
+        print("%s: {%s}" % (name, values))
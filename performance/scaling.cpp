@@ -0,0 +1,413 @@
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Solver.h"
+#include "LowStorageRK.h"
+#include "MethodOfLines.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#define ODE_SCALING_FORK
+#endif
+
+using namespace OrangeDrumExplorer;
+
+// Scaling of the solvers over the number of steps, the order of the equation and the dimension of a system
+//
+// Every point runs in a forked process, so the peak resident memory (RSS) belongs to that run only.
+// The local exponent between neighbouring points shows where the cost grows faster than linear.
+
+namespace {
+    struct Measurement {
+        bool ok = false;
+        double seconds = 0.;
+        // peak resident set size in bytes, 0 if unknown
+        double peak_rss = 0.;
+    };
+
+    Measurement measure(const std::function<void()>& run){
+        Measurement m;
+#ifdef ODE_SCALING_FORK
+        int fd[2];
+        if (pipe(fd) != 0){
+            throw std::runtime_error("Couldn't create a pipe");
+        }
+        const pid_t pid = fork();
+        if (pid < 0){
+            throw std::runtime_error("Couldn't fork the measurement");
+        }
+        if (pid == 0){
+            close(fd[0]);
+            double seconds = -1.;
+            try{
+                auto t0 = std::chrono::steady_clock::now();
+                run();
+                seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            }
+            catch (...){
+            }
+            ssize_t written = write(fd[1], &seconds, sizeof(seconds));
+            _exit(written == sizeof(seconds) ? 0 : 1);
+        }
+        close(fd[1]);
+        double seconds = -1.;
+        const bool received = read(fd[0], &seconds, sizeof(seconds)) == sizeof(seconds);
+        close(fd[0]);
+        int status = 0;
+        struct rusage usage;
+        wait4(pid, &status, 0, &usage);
+        m.ok = received && seconds >= 0. && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+        m.seconds = seconds;
+#ifdef __APPLE__
+        m.peak_rss = usage.ru_maxrss;
+#else
+        m.peak_rss = 1024.*usage.ru_maxrss;
+#endif
+#else
+        try{
+            auto t0 = std::chrono::steady_clock::now();
+            run();
+            m.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            m.ok = true;
+        }
+        catch (...){
+        }
+#endif
+        return m;
+    }
+
+    // y^(n) = -y^(n-1) - eps*sum_j y^(j): every derivative enters the function, the solution stays bounded
+    double order_n (double t, const vec& y){
+        const size_t n = y.size();
+        double lower = 0.;
+        for (size_t j = 0; j + 1 < n; ++j){
+            lower += y[j];
+        }
+        return -y[n-1] - 1e-3/n*lower;
+    }
+
+    adouble adorder_n (adouble t, const advec& y){
+        const size_t n = y.size();
+        adouble lower = 0.;
+        for (size_t j = 0; j + 1 < n; ++j){
+            lower += y[j];
+        }
+        return -y[n-1] - 1e-3/n*lower;
+    }
+
+    // order_n as first-order system, templated on the scalar type for the tape
+    template <typename T>
+    void order_n_system (const T& t, const std::vector<T>& y, std::vector<T>& dydt){
+        const size_t n = y.size();
+        T lower = 0.;
+        for (size_t j = 0; j + 1 < n; ++j){
+            dydt[j] = y[j+1];
+            lower += y[j];
+        }
+        dydt[n-1] = -y[n-1] - 1e-3/n*lower;
+    }
+
+    // heat equation on d points with fixed zero ends: every component is coupled to its neighbours
+    template <typename T>
+    void heat_chain (const T& t, const std::vector<T>& y, std::vector<T>& dydt){
+        const size_t d = y.size();
+        for (size_t i = 0; i < d; ++i){
+            dydt[i] = -2.*y[i];
+            if (i > 0){
+                dydt[i] += y[i-1];
+            }
+            if (i + 1 < d){
+                dydt[i] += y[i+1];
+            }
+        }
+    }
+
+    vec initial_values(size_t n){
+        vec y0(n, 0.);
+        y0[n-1] = 1.;
+        return y0;
+    }
+
+    struct Method {
+        std::string name;
+        // solve the equation of order n with the given number of steps over [0, 1]
+        std::function<void(size_t n, size_t steps)> run;
+        // solve the system of dimension d with the given number of steps over [0, 1]
+        std::function<void(size_t d, size_t steps)> run_system;
+    };
+
+    // heat_chain as method of lines, the ends mirrored around zero
+    MethodOfLines heat_lines(size_t d){
+        return MethodOfLines([](double, double, const double* u, double){ return u[-1] - 2.*u[0] + u[1]; }, 1, d,
+                             0., 1., MethodOfLines::Boundary::dirichlet(0.), MethodOfLines::Boundary::dirichlet(0.));
+    }
+
+    std::vector<Method> methods(){
+        return {
+            {"euler_explicit", [](size_t n, size_t steps){
+                EulerExplicit solver(0., 1.);
+                solver.set_time_step(1./steps);
+                solver.solve(order_n, initial_values(n));
+            }, [](size_t d, size_t steps){
+                EulerExplicit solver(0., 1.);
+                solver.set_time_step(1./steps);
+                solver.solve(sysfunc(heat_chain<double>), vec(d, 1.));
+            }},
+            {"euler_explicit_adouble", [](size_t n, size_t steps){
+                EulerExplicit solver(0., 1.);
+                solver.set_time_step(1./steps);
+                solver.solve(adorder_n, initial_values(n));
+            }, [](size_t d, size_t steps){
+                EulerExplicit solver(0., 1.);
+                solver.set_time_step(1./steps);
+                solver.solve(adsysfunc(heat_chain<adouble>), vec(d, 1.));
+            }},
+            // the system streams its states into a sink instead of storing them
+            {"low_storage_rk4", [](size_t n, size_t steps){
+                LowStorageRK solver(0., 1.);
+                solver.set_time_step(1./steps);
+                solver.solve(order_n, initial_values(n));
+            }, [](size_t d, size_t steps){
+                LowStorageRK solver(0., 1.);
+                solver.set_time_step(1./steps);
+                double sum = 0.;
+                solver.solve(sysfunc(heat_chain<double>), vec(d, 1.), [&sum](double, const vec& y){ sum += y[0]; });
+            }},
+            {"euler_implicit", [](size_t n, size_t steps){
+                EulerImplicit solver(0., 1.);
+                solver.set_time_step(1./steps);
+                solver.solve(adorder_n, initial_values(n));
+            }, [](size_t d, size_t steps){
+                EulerImplicit solver(0., 1.);
+                solver.set_time_step(1./steps);
+                solver.solve(adsysfunc(heat_chain<adouble>), vec(d, 1.));
+            }},
+            {"euler_implicit_krylov", [](size_t n, size_t steps){
+                EulerImplicit solver(0., 1.);
+                solver.set_time_step(1./steps);
+                solver.set_newton_krylov(30);
+                solver.solve(adorder_n, initial_values(n));
+            }, [](size_t d, size_t steps){
+                EulerImplicit solver(0., 1.);
+                solver.set_time_step(1./steps);
+                solver.set_newton_krylov(30);
+                solver.solve(adsysfunc(heat_chain<adouble>), vec(d, 1.));
+            }},
+            {"euler_implicit_taped", [](size_t n, size_t steps){
+                EulerImplicit solver(0., 1.);
+                solver.set_time_step(1./steps);
+                solver.solve_taped([](const auto& t, const auto& y, auto& dydt){ order_n_system(t, y, dydt); },
+                                   initial_values(n));
+            }, [](size_t d, size_t steps){
+                EulerImplicit solver(0., 1.);
+                solver.set_time_step(1./steps);
+                solver.solve_taped([](const auto& t, const auto& y, auto& dydt){ heat_chain(t, y, dydt); },
+                                   vec(d, 1.));
+            }},
+            // banded Jacobian of the heat chain, there is no method of lines form of the equation of order n
+            {"euler_implicit_lines", nullptr, [](size_t d, size_t steps){
+                EulerImplicit solver(0., 1.);
+                solver.set_time_step(1./steps);
+                solver.solve(heat_lines(d), vec(d, 1.));
+            }},
+        };
+    }
+
+    struct Point {
+        std::string sweep;
+        std::string method;
+        double size;
+        size_t n;
+        size_t steps;
+        Measurement m;
+        double exponent;
+        bool superlinear;
+    };
+
+    std::vector<std::string> split(const std::string& list){
+        std::vector<std::string> out;
+        std::stringstream ss(list);
+        std::string item;
+        while (std::getline(ss, item, ',')){
+            out.push_back(item);
+        }
+        return out;
+    }
+
+    bool selected(const std::string& name, const std::vector<std::string>& filter){
+        if (filter.empty()){
+            return true;
+        }
+        for (auto& f : filter){
+            if (name == f){
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+int main(int argc, char** argv) {
+    std::string sweep = "all";
+    double max_steps = 1e7;
+    size_t max_order = 64;
+    size_t order_steps = 10000;
+    size_t max_dimension = 128;
+    size_t dimension_steps = 100;
+    double superlinear = 1.2;
+    std::string json;
+    std::vector<std::string> method_filter;
+    try{
+        for (int i = 1; i < argc; ++i){
+            const std::string arg = argv[i];
+            if (i+1 >= argc){
+                throw std::invalid_argument("Missing value for option " + arg);
+            }
+            const std::string value = argv[++i];
+            if (arg == "--sweep"){
+                sweep = value;
+            }
+            else if (arg == "--max-steps"){
+                max_steps = std::stod(value);
+            }
+            else if (arg == "--max-order"){
+                max_order = std::stoul(value);
+            }
+            else if (arg == "--order-steps"){
+                order_steps = std::stoul(value);
+            }
+            else if (arg == "--max-dimension"){
+                max_dimension = std::stoul(value);
+            }
+            else if (arg == "--dimension-steps"){
+                dimension_steps = std::stoul(value);
+            }
+            else if (arg == "--superlinear"){
+                superlinear = std::stod(value);
+            }
+            else if (arg == "--methods"){
+                method_filter = split(value);
+            }
+            else if (arg == "--json"){
+                json = value;
+            }
+            else{
+                throw std::invalid_argument("Unknown option " + arg);
+            }
+        }
+        if (sweep != "all" && sweep != "steps" && sweep != "order" && sweep != "dimension"){
+            throw std::invalid_argument("Unknown sweep " + sweep);
+        }
+    }
+    catch (std::exception& e){
+        std::cerr << e.what() << std::endl << "Usage: bench_scaling [--sweep all|steps|order|dimension] [--max-steps N] "
+                  << "[--max-order N] [--order-steps N] [--max-dimension N] [--dimension-steps N] "
+                  << "[--superlinear X] [--methods a,b] [--json FILE]" << std::endl;
+        return -1;
+    }
+
+    // memory of the process without any solution, subtracted for the bytes per step
+    const double base_rss = measure([](){}).peak_rss;
+    std::vector<Point> points;
+    for (const Method& method : methods()){
+        if (!selected(method.name, method_filter)){
+            continue;
+        }
+        std::vector<std::vector<Point>> sweeps;
+        if (method.run && (sweep == "all" || sweep == "steps")){
+            // the Implicit Euler method is about two orders of magnitude slower per step
+            const double limit = method.name.find("euler_implicit") == 0 ? max_steps/100 : max_steps;
+            std::vector<Point> s;
+            for (double steps = 1e3; steps <= limit*1.0001; steps *= std::sqrt(10.)){
+                s.push_back({"steps", method.name, std::round(steps), 2, static_cast<size_t>(std::round(steps))});
+            }
+            if (!s.empty()){
+                sweeps.push_back(s);
+            }
+        }
+        if (method.run && (sweep == "all" || sweep == "order")){
+            std::vector<Point> s;
+            for (size_t n = 1; n <= max_order; n *= 2){
+                s.push_back({"order", method.name, static_cast<double>(n), n, order_steps});
+            }
+            sweeps.push_back(s);
+        }
+        if (sweep == "all" || sweep == "dimension"){
+            std::vector<Point> s;
+            for (size_t d = 1; d <= max_dimension; d *= 2){
+                s.push_back({"dimension", method.name, static_cast<double>(d), d, dimension_steps});
+            }
+            sweeps.push_back(s);
+        }
+        for (auto& s : sweeps){
+            std::cout << method.name << " over " << s.front().sweep << std::endl
+                      << std::setw(12) << s.front().sweep << std::setw(16) << "time/step [s]"
+                      << std::setw(16) << "bytes/step" << std::setw(14) << "peak RSS [MB]"
+                      << std::setw(10) << "exponent" << std::endl;
+            for (size_t i = 0; i < s.size(); ++i){
+                Point& p = s[i];
+                p.m = measure([&](){
+                    if (p.sweep == "dimension"){
+                        method.run_system(p.n, p.steps);
+                    }
+                    else{
+                        method.run(p.n, p.steps);
+                    }
+                });
+                p.exponent = std::nan("");
+                p.superlinear = false;
+                // local exponent of the total time, skipped for timings dominated by noise
+                if (i > 0 && s[i-1].m.ok && p.m.ok && s[i-1].m.seconds > 1e-3){
+                    p.exponent = std::log(p.m.seconds/s[i-1].m.seconds)/std::log(p.size/s[i-1].size);
+                    p.superlinear = p.exponent > superlinear;
+                }
+                if (!p.m.ok){
+                    std::cout << std::setw(12) << p.size << "  failed (out of memory?)" << std::endl;
+                    continue;
+                }
+                std::cout << std::setw(12) << p.size << std::setw(16) << p.m.seconds/p.steps
+                          << std::setw(16) << (p.m.peak_rss - base_rss)/p.steps
+                          << std::setw(14) << p.m.peak_rss/1048576. << std::setw(10) << p.exponent
+                          << (p.superlinear ? "  SUPERLINEAR" : "") << std::endl;
+            }
+            std::cout << std::endl;
+            points.insert(points.end(), s.begin(), s.end());
+        }
+    }
+
+    if (!json.empty()){
+        std::ofstream out(json);
+        if (!out.is_open()){
+            std::cerr << "Couldn't open " << json << std::endl;
+            return -1;
+        }
+        out << std::setprecision(9) << "{\"superlinear_threshold\": " << superlinear << ", \"points\": [";
+        for (size_t i = 0; i < points.size(); ++i){
+            const Point& p = points[i];
+            out << (i ? "," : "") << std::endl << "  {\"sweep\": \"" << p.sweep << "\", \"method\": \"" << p.method
+                << "\", \"" << (p.sweep == "dimension" ? "dimension" : "order") << "\": " << p.n
+                << ", \"steps\": " << p.steps << ", \"ok\": " << (p.m.ok ? "true" : "false");
+            if (p.m.ok){
+                out << ", \"seconds\": " << p.m.seconds << ", \"seconds_per_step\": " << p.m.seconds/p.steps
+                    << ", \"peak_rss\": " << p.m.peak_rss << ", \"bytes_per_step\": " << (p.m.peak_rss - base_rss)/p.steps;
+                if (std::isfinite(p.exponent)){
+                    out << ", \"exponent\": " << p.exponent;
+                }
+                out << ", \"superlinear\": " << (p.superlinear ? "true" : "false");
+            }
+            out << "}";
+        }
+        out << std::endl << "]}" << std::endl;
+    }
+    return 0;
+}
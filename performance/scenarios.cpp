@@ -0,0 +1,380 @@
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "Solver.h"
+#include "Adams.h"
+#include "AdditiveRK.h"
+#include "Benchmark.h"
+#include "Exponential.h"
+#include "Parareal.h"
+#include "SDC.h"
+
+using namespace OrangeDrumExplorer;
+
+namespace {
+    // Number of steps of a scenario, the solvers need at least two
+    size_t scaled(size_t steps, double scale){
+        return std::max<size_t>(2, static_cast<size_t>(steps*scale));
+    }
+
+    // Create lightweight function to solve
+    // y'' - y' + 3y = t -> y'' = t + y' - 3y
+    double f (double t , const vec& y){
+        return t + y[1] - 3*y[0];
+    }
+
+    adouble adf (adouble t , const advec& y){
+        return t + y[1] - 3.0*y[0];
+    }
+
+    // Linear equation of order n with the characteristic polynomial (x+1)^n
+    // y^(n) = t - sum_j binomial(n, j) y^(j)
+    adouble adf_high_order (adouble t, const advec& y){
+        const size_t n = y.size();
+        adouble out = t;
+        double binomial = 1.;
+        for (size_t j = 0; j < n; ++j){
+            out -= binomial*y[j];
+            binomial = binomial*(n-j)/(j+1);
+        }
+        return out;
+    }
+
+    // The Scenario 2 equation and the order n equation as first-order systems, templated on the scalar
+    // type to be instantiated with adouble, Dual or TapeScalar
+    struct System2 {
+        template <typename T>
+        void operator()(const T& t, const std::vector<T>& y, std::vector<T>& dydt) const {
+            dydt[0] = y[1];
+            dydt[1] = t + y[1] - 3.0*y[0];
+        }
+    };
+
+    struct SystemHighOrder {
+        template <typename T>
+        void operator()(const T& t, const std::vector<T>& y, std::vector<T>& dydt) const {
+            const size_t n = y.size();
+            for (size_t j = 0; j + 1 < n; ++j){
+                dydt[j] = y[j+1];
+            }
+            T out = t;
+            double binomial = 1.;
+            for (size_t j = 0; j < n; ++j){
+                out -= binomial*y[j];
+                binomial = binomial*(n-j)/(j+1);
+            }
+            dydt[n-1] = out;
+        }
+    };
+
+    // Scenario 1 as the linear system y' = A y + b(t)
+    void affine1 (double t, vec& A, vec& b){
+        A[0*2 + 1] = 1.;
+        A[1*2 + 0] = -3.;
+        A[1*2 + 1] = 1.;
+        b[1] = t;
+    }
+
+    // Jacobian of the Scenario 2 system
+    void jacobian2 (double t, const vec& y, vec& J){
+        J[0*2 + 1] = 1.;
+        J[1*2 + 0] = -3.;
+        J[1*2 + 1] = 1.;
+    }
+
+    // some parameters for the computationally intesive function
+    const double package_length = 3.0;
+    const size_t N_rollers = 10000;
+    std::vector<double> roller_locations;
+    std::vector<double> roller_forces;
+
+    void setup_rollers(){
+        std::mt19937 eng(42);
+        std::uniform_real_distribution<double> dist_force(-5, 5);
+        roller_forces.resize(N_rollers);
+        std::generate_n(roller_forces.begin(), N_rollers, [&](){return dist_force(eng);});
+        std::uniform_real_distribution<double> dist_loc(-1000.,1000.);
+        roller_locations.resize(N_rollers);
+        std::generate_n(roller_locations.begin(), N_rollers, [&](){return dist_loc(eng);});
+    }
+
+    // computationally intensive function
+    // roughly models movement of a package on powered rollers with random speeds
+    // computation comes from detection of rollers to be taken into account
+    // sorting the locations is purposefully ignored as an option to optimize.
+    double compute(double t, const vec& y){
+        double acceleration = 0;
+        for (size_t i=0; i<N_rollers; i++){
+            if ( std::abs(roller_locations[i] - y[0] ) < package_length ){
+                acceleration += roller_forces[i];
+            }
+        }
+        return acceleration;
+    }
+
+    // masked accumulation variant of compute, vectorized by gcc (see performance.md)
+    std::vector<double> mask(N_rollers, 0.);
+    std::vector<double> accumulator(N_rollers, 0.);
+    double compute_vector(double t, const vec& y){
+        for (size_t i=0; i<N_rollers; i++){
+            mask[i] = std::abs(roller_locations[i] - y[0] ) < package_length;
+        }
+        for (size_t i=0; i<N_rollers; i++){
+            accumulator[i] = roller_forces[i]*mask[i];
+        }
+        double acceleration = 0;
+        for (size_t i=0; i<N_rollers; i++){
+            acceleration += accumulator[i];
+        }
+        return acceleration;
+    }
+
+    // Scenario 3 with stiff linear damping of the highest derivative, y^(3) = compute(t, y) - damping*y''
+    const double damping = 1e3;
+
+    adouble damping_force(adouble t, const advec& y){
+        return -damping*y[2];
+    }
+
+    double compute_damped(double t, const vec& y){
+        return compute(t, y) - damping*y[2];
+    }
+
+    // Solve between 0 and 10 with the given solver, function and number of steps
+    template <typename S, typename F>
+    std::unique_ptr<Benchmark::Scenario> scenario(const std::string& name, const std::string& description,
+                                                  F function, vec y0, size_t steps,
+                                                  std::function<void()> prepare = [](){}){
+        return std::make_unique<Benchmark::FunctionScenario>(name, description,
+            [=](double scale){
+                prepare();
+                const size_t N = scaled(steps, scale);
+                return std::function<void()>([=](){
+                    S solver(0., 10.);
+                    solver.set_time_step(10./N);
+                    solver.solve(function, y0);
+                });
+            },
+            [=](double scale){ return static_cast<double>(scaled(steps, scale)); });
+    }
+
+    // Solve between 0 and 10*scale with the Adams-Bashforth-Moulton method at the default tolerances,
+    // output every 10/steps. Its steps follow the tolerances, so the scale shortens the domain instead.
+    std::unique_ptr<Benchmark::Scenario> adams_scenario(const std::string& name, const std::string& description,
+                                                        func function, vec y0, size_t steps,
+                                                        std::function<void()> prepare = [](){}){
+        return std::make_unique<Benchmark::FunctionScenario>(name, description,
+            [=](double scale){
+                prepare();
+                const size_t N = scaled(steps, scale);
+                return std::function<void()>([=](){
+                    AdamsPECE solver(0., 10.*N/steps);
+                    solver.set_time_step(10./steps);
+                    solver.solve(function, y0);
+                });
+            },
+            [=](double scale){ return static_cast<double>(scaled(steps, scale)); });
+    }
+
+    // Solve between 0 and 10 with the IMEX ARS(4,4,3) pair, the stiff part implicit and the non-stiff part explicit
+    std::unique_ptr<Benchmark::Scenario> imex_scenario(const std::string& name, const std::string& description,
+                                                       adfunc stiff, func nonstiff, vec y0, size_t steps,
+                                                       std::function<void()> prepare = [](){}){
+        return std::make_unique<Benchmark::FunctionScenario>(name, description,
+            [=](double scale){
+                prepare();
+                const size_t N = scaled(steps, scale);
+                return std::function<void()>([=](){
+                    AdditiveRK solver(0., 10.);
+                    solver.set_time_step(10./N);
+                    solver.solve(stiff, nonstiff, y0);
+                });
+            },
+            [=](double scale){ return static_cast<double>(scaled(steps, scale)); });
+    }
+
+    // Solve a linear system between 0 and 10 with the Explicit Euler method, its steps scanned on `threads` threads
+    std::unique_ptr<Benchmark::Scenario> affine_scenario(const std::string& name, const std::string& description,
+                                                         affinefunc coefficients, vec y0, size_t steps, size_t threads){
+        return std::make_unique<Benchmark::FunctionScenario>(name, description,
+            [=](double scale){
+                const size_t N = scaled(steps, scale);
+                return std::function<void()>([=](){
+                    EulerExplicit solver(0., 10.);
+                    solver.set_time_step(10./N);
+                    solver.set_scan_threads(threads);
+                    solver.solve_affine(coefficients, y0);
+                });
+            },
+            [=](double scale){ return static_cast<double>(scaled(steps, scale)); });
+    }
+
+    // Solve between 0 and 10 with Parareal on all cores, 16 slices with 64 coarse steps each of the same solver S,
+    // iterated to the default tolerance
+    template <typename S, typename F>
+    std::unique_ptr<Benchmark::Scenario> parareal_scenario(const std::string& name, const std::string& description,
+                                                           F function, vec y0, size_t steps){
+        return std::make_unique<Benchmark::FunctionScenario>(name, description,
+            [=](double scale){
+                const size_t N = scaled(steps, scale);
+                return std::function<void()>([=](){
+                    Parareal::Propagator propagator = [](){ return std::make_unique<S>(); };
+                    Parareal solver(0., 10., propagator, propagator);
+                    solver.set_time_step(10./N);
+                    solver.set_slices(16);
+                    solver.set_coarse_steps(64);
+                    solver.solve(function, y0);
+                });
+            },
+            [=](double scale){ return static_cast<double>(scaled(steps, scale)); });
+    }
+
+    // Solve between 0 and 10 with four sweeps of spectral deferred corrections over three nodes and a
+    // user-supplied Jacobian, the nodes of a sweep updated on `threads` threads or 0 for the sequential sweeps
+    std::unique_ptr<Benchmark::Scenario> sdc_scenario(const std::string& name, const std::string& description,
+                                                      sysfunc function, jacfunc jacobian, vec y0, size_t steps,
+                                                      size_t threads){
+        return std::make_unique<Benchmark::FunctionScenario>(name, description,
+            [=](double scale){
+                const size_t N = scaled(steps, scale);
+                return std::function<void()>([=](){
+                    SDC solver(0., 10.);
+                    solver.set_time_step(10./N);
+                    solver.set_parallel_sweeps(threads);
+                    solver.solve(function, jacobian, y0);
+                });
+            },
+            [=](double scale){ return static_cast<double>(scaled(steps, scale)); });
+    }
+
+    // Solve between 0 and 10 with the Implicit Euler method and forward-mode Jacobians by Dual<double, N>
+    template <size_t N, typename Rhs>
+    std::unique_ptr<Benchmark::Scenario> dual_scenario(const std::string& name, const std::string& description,
+                                                       Rhs function, vec y0, size_t steps){
+        return std::make_unique<Benchmark::FunctionScenario>(name, description,
+            [=](double scale){
+                const size_t N_steps = scaled(steps, scale);
+                return std::function<void()>([=](){
+                    EulerImplicit solver(0., 10.);
+                    solver.set_time_step(10./N_steps);
+                    solver.solve_dual<N>(function, y0);
+                });
+            },
+            [=](double scale){ return static_cast<double>(scaled(steps, scale)); });
+    }
+
+    // Solve between 0 and 10 with the Implicit Euler method, the function recorded once on a Tape
+    template <typename Rhs>
+    std::unique_ptr<Benchmark::Scenario> taped_scenario(const std::string& name, const std::string& description,
+                                                        Rhs function, vec y0, size_t steps){
+        return std::make_unique<Benchmark::FunctionScenario>(name, description,
+            [=](double scale){
+                const size_t N = scaled(steps, scale);
+                return std::function<void()>([=](){
+                    EulerImplicit solver(0., 10.);
+                    solver.set_time_step(10./N);
+                    solver.solve_taped(function, y0);
+                });
+            },
+            [=](double scale){ return static_cast<double>(scaled(steps, scale)); });
+    }
+
+    // Solve between 0 and 10 with the Implicit Euler method and a user-supplied Jacobian
+    std::unique_ptr<Benchmark::Scenario> analytic_scenario(const std::string& name, const std::string& description,
+                                                           sysfunc function, jacfunc jacobian, vec y0, size_t steps){
+        return std::make_unique<Benchmark::FunctionScenario>(name, description,
+            [=](double scale){
+                const size_t N = scaled(steps, scale);
+                return std::function<void()>([=](){
+                    EulerImplicit solver(0., 10.);
+                    solver.set_time_step(10./N);
+                    solver.solve(function, jacobian, y0);
+                });
+            },
+            [=](double scale){ return static_cast<double>(scaled(steps, scale)); });
+    }
+}
+
+int main(int argc, char** argv) {
+    Benchmark::Suite suite("Orange-Drum-Explorer");
+    suite.add(scenario<EulerExplicit, func>("scenario1",
+        "Light-weight function integrated with the Explicit Euler method",
+        f, {1., -2.}, 1024*1024*2));
+    suite.add(affine_scenario("scenario1_affine",
+        "Scenario 1 as linear system integrated with the Explicit Euler method from its coefficients",
+        affine1, {1., -2.}, 1024*1024*2, 1));
+    suite.add(affine_scenario("scenario1_scan",
+        "Scenario 1 as linear system, the Explicit Euler steps evaluated by a parallel scan on all cores",
+        affine1, {1., -2.}, 1024*1024*2, std::max(1u, std::thread::hardware_concurrency())));
+    suite.add(scenario<EulerImplicit, adfunc>("scenario2",
+        "Light-weight function integrated with the Implicit Euler method with automatic differentiation",
+        adf, {1., -2.}, 1024*256));
+    suite.add(parareal_scenario<EulerExplicit, func>("scenario1_parareal",
+        "Scenario 1 parallel in time by Parareal, coarse and fine Explicit Euler method",
+        f, {1., -2.}, 1024*1024*2));
+    suite.add(parareal_scenario<EulerImplicit, adfunc>("scenario2_parareal",
+        "Scenario 2 parallel in time by Parareal, coarse and fine Implicit Euler method",
+        adf, {1., -2.}, 1024*256));
+    suite.add(scenario<EulerExplicit, func>("scenario3",
+        "Computationally intensive function integrated with the Explicit Euler method",
+        compute, {0., 10., -1.}, 1024*64, setup_rollers));
+    suite.add(scenario<EulerExplicit, func>("scenario3_vectorized",
+        "Masked accumulation variant of the scenario3 function",
+        compute_vector, {0., 10., -1.}, 1024*64, setup_rollers));
+    suite.add(adams_scenario("scenario3_adams",
+        "Scenario 3 integrated with the variable order Adams-Bashforth-Moulton method",
+        compute, {0., 10., -1.}, 1024*64, setup_rollers));
+    suite.add(scenario<EulerExplicit, func>("scenario3_damped",
+        "Scenario 3 with stiff damping integrated with the Explicit Euler method, steps below its stability limit",
+        compute_damped, {0., 10., -1.}, 1024*8, setup_rollers));
+    suite.add(scenario<EulerImplicit, func>("scenario3_damped_implicit",
+        "Scenario 3 with stiff damping integrated with the Implicit Euler method, Jacobian by finite differences",
+        compute_damped, {0., 10., -1.}, 1024, setup_rollers));
+    suite.add(imex_scenario("scenario3_damped_imex",
+        "Scenario 3 with stiff damping integrated with the IMEX ARS(4,4,3) pair, the roller force explicit",
+        damping_force, compute, {0., 10., -1.}, 1024, setup_rollers));
+    suite.add(scenario<EulerExplicit, adfunc>("explicit_adouble",
+        "Light-weight function instrumented for automatic differentiation with the Explicit Euler method",
+        adf, {1., -2.}, 1024*1024));
+    suite.add(scenario<EulerImplicit, adfunc>("implicit_order8",
+        "Linear equation of order 8 integrated with the Implicit Euler method",
+        adf_high_order, vec(8, 1.), 1024*32));
+    suite.add(scenario<EulerImplicit, adsysfunc>("scenario2_system",
+        "Scenario 2 as first-order system, Jacobian from the adept tape",
+        adsysfunc(System2()), {1., -2.}, 1024*256));
+    suite.add(scenario<EulerImplicit, func>("scenario2_fd",
+        "Scenario 2 without automatic differentiation, Jacobian by finite differences",
+        f, {1., -2.}, 1024*256));
+    suite.add(analytic_scenario("scenario2_analytic",
+        "Scenario 2 as first-order system with the analytic Jacobian",
+        sysfunc(System2()), jacobian2, {1., -2.}, 1024*256));
+    suite.add(sdc_scenario("scenario2_sdc",
+        "Scenario 2 as first-order system with spectral deferred corrections of order 4, 1/256 of the steps",
+        sysfunc(System2()), jacobian2, {1., -2.}, 1024, 0));
+    suite.add(sdc_scenario("scenario2_sdc_parallel",
+        "Scenario 2 with spectral deferred corrections, the nodes of every sweep updated in parallel on all cores",
+        sysfunc(System2()), jacobian2, {1., -2.}, 1024, std::max(1u, std::thread::hardware_concurrency())));
+    suite.add(dual_scenario<2>("scenario2_dual",
+        "Scenario 2 as first-order system, Jacobian by forward-mode Dual numbers",
+        System2(), {1., -2.}, 1024*256));
+    suite.add(dual_scenario<8>("implicit_order8_dual",
+        "Order 8 equation as first-order system, Jacobian by forward-mode Dual numbers",
+        SystemHighOrder(), vec(8, 1.), 1024*32));
+    suite.add(taped_scenario("scenario2_taped",
+        "Scenario 2 as first-order system, recorded once and replayed from a Tape",
+        System2(), {1., -2.}, 1024*256));
+    suite.add(taped_scenario("implicit_order8_taped",
+        "Order 8 equation as first-order system, recorded once and replayed from a Tape",
+        SystemHighOrder(), vec(8, 1.), 1024*32));
+    suite.add(scenario<Exponential, adfunc>("scenario2_exponential",
+        "Scenario 2 detected as linear and integrated with exact exponential steps",
+        adf, {1., -2.}, 1024*256));
+    suite.add(scenario<Exponential, adfunc>("order8_exponential",
+        "Order 8 equation detected as linear and integrated with exact exponential steps",
+        adf_high_order, vec(8, 1.), 1024*32));
+    return suite.main(argc, argv);
+}
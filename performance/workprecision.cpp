@@ -0,0 +1,460 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Solver.h"
+#include "Adams.h"
+#include "ExplicitRK.h"
+#include "Exponential.h"
+#include "LowStorageRK.h"
+#include "RadauIIA.h"
+#include "RKC.h"
+#include "SDC.h"
+#include "SDIRK.h"
+#include "Problems.h"
+
+using namespace OrangeDrumExplorer;
+using namespace OrangeDrumExplorer::Benchmark;
+
+// Work-precision diagrams of all solvers over the problem corpus
+//
+// Every solver integrates every problem it supports with the number of steps doubled
+// on each level. Error at t_end, wall time and number of RHS evaluations are recorded,
+// and the observed order of convergence is estimated from the finest levels.
+
+namespace {
+    struct Point {
+        size_t steps;
+        double error;
+        double seconds;
+        size_t evaluations;
+    };
+
+    /**
+     * Solver under test
+     *
+     * @param order - expected order of convergence, 0 for adaptive methods, which aren't checked
+     * @param run(problem, steps, evaluations) - solve with a fixed number of steps, count the RHS evaluations
+     *      and return y(t_end); only the function value for the scalar form, the full state for systems.
+     *      Adaptive methods solve with the tolerance of the level instead, see level_tolerance.
+     */
+    struct Method {
+        std::string name;
+        int order;
+        std::function<bool(const Problem&)> supports;
+        std::function<vec(const Problem&, size_t, size_t&)> run;
+    };
+
+    // Integrate the scalar form of a problem with a solver of type S
+    template <typename S, typename F>
+    vec solve_scalar(const Problem& p, const F& f, size_t steps){
+        S solver(p.t0, p.t_end);
+        solver.set_time_step((p.t_end - p.t0)/steps);
+        const vec& y = solver.solve(f, p.y0);
+        return {y.back()};
+    }
+
+    // Integrate the first-order system form of a problem with a solver of type S
+    template <typename S, typename F>
+    vec solve_system(const Problem& p, const F& f, size_t steps){
+        S solver(p.t0, p.t_end);
+        solver.set_time_step((p.t_end - p.t0)/steps);
+        const vec& y = solver.solve(f, p.y0);
+        return vec(y.end() - p.y0.size(), y.end());
+    }
+
+    // Tolerance of adaptive methods on the level with the given number of steps, divided by 16 per level
+    double level_tolerance(const Problem& p, size_t steps){
+        return 1e-3*std::pow(static_cast<double>(p.steps)/steps, 4);
+    }
+
+    // Integrate the system form of a problem with the explicit Runge-Kutta method of a tableau, without storing
+    template <const auto& Tableau>
+    vec solve_tableau(const Problem& p, size_t steps, size_t& evaluations){
+        ExplicitRK<Tableau> solver(p.t0, p.t_end);
+        solver.set_time_step((p.t_end - p.t0)/steps);
+        auto f = [&](double t, const vec& y, vec& dydt){ ++evaluations; p.system(t, y, dydt); };
+        return solver.solve(f, p.y0, [](double, const vec&){});
+    }
+
+    /**
+     * Integrate the system form of a problem with an SDIRK tableau and the Jacobian from the adept tape
+     *
+     * @param adaptive - step control at the tolerance of the level instead of fixed steps
+     */
+    vec solve_sdirk(const Problem& p, const SDIRK::Tableau& tableau, size_t steps, size_t& evaluations, bool adaptive){
+        adsysfunc f = [&](adouble t, const advec& y, advec& dydt){ ++evaluations; p.adsystem(t, y, dydt); };
+        SDIRK solver(p.t0, p.t_end, tableau);
+        if (adaptive){
+            solver.set_time_step((p.t_end - p.t0)/2);
+            solver.set_tolerances(level_tolerance(p, steps), level_tolerance(p, steps));
+        }
+        else{
+            solver.set_time_step((p.t_end - p.t0)/steps);
+        }
+        const vec& y = solver.solve(f, p.y0);
+        return vec(y.end() - p.y0.size(), y.end());
+    }
+
+    /**
+     * Integrate the system form of a problem with Radau IIA and the Jacobian from the adept tape
+     *
+     * @param adaptive - step control at the tolerance of the level instead of fixed steps
+     */
+    vec solve_radau(const Problem& p, size_t steps, size_t& evaluations, bool adaptive){
+        adsysfunc f = [&](adouble t, const advec& y, advec& dydt){ ++evaluations; p.adsystem(t, y, dydt); };
+        RadauIIA solver(p.t0, p.t_end);
+        if (adaptive){
+            solver.set_time_step((p.t_end - p.t0)/2);
+            solver.set_tolerances(level_tolerance(p, steps), level_tolerance(p, steps));
+        }
+        else{
+            solver.set_time_step((p.t_end - p.t0)/steps);
+        }
+        const vec& y = solver.solve(f, p.y0);
+        return vec(y.end() - p.y0.size(), y.end());
+    }
+
+    /**
+     * Integrate the system form of a problem with an exponential integrator and the Jacobian from the adept tape
+     *
+     * Linear problems are detected and take exact steps.
+     */
+    vec solve_exponential(const Problem& p, Exponential::Method method, size_t steps, size_t& evaluations){
+        adsysfunc f = [&](adouble t, const advec& y, advec& dydt){ ++evaluations; p.adsystem(t, y, dydt); };
+        Exponential solver(p.t0, p.t_end, method);
+        solver.set_time_step((p.t_end - p.t0)/steps);
+        const vec& y = solver.solve(f, p.y0);
+        return vec(y.end() - p.y0.size(), y.end());
+    }
+
+    /**
+     * Integrate the system form of a problem with three sweeps of spectral deferred corrections over three
+     * Gauss-Lobatto nodes, with the Jacobian from the adept tape for the implicit sweeps
+     *
+     * Three sweeps stay below the collocation order 4. With four, the errors of the sweeps and of the
+     * collocation cancel on the demo equation, and the observed order scatters.
+     */
+    vec solve_sdc(const Problem& p, SDC::Sweeper sweeper, size_t steps, size_t& evaluations){
+        adsysfunc f = [&](adouble t, const advec& y, advec& dydt){ ++evaluations; p.adsystem(t, y, dydt); };
+        SDC solver(p.t0, p.t_end, 3, 3, sweeper);
+        solver.set_time_step((p.t_end - p.t0)/steps);
+        const vec& y = solver.solve(f, p.y0);
+        return vec(y.end() - p.y0.size(), y.end());
+    }
+
+    std::vector<Method> methods(){
+        std::vector<Method> out;
+        out.push_back({"euler_explicit", 1,
+            [](const Problem& p){ return p.has_scalar_form(); },
+            [](const Problem& p, size_t steps, size_t& evaluations){
+                func f = [&](double t, const vec& y){ ++evaluations; return p.scalar(t, y); };
+                return solve_scalar<EulerExplicit>(p, f, steps);
+            }});
+        out.push_back({"euler_implicit", 1,
+            [](const Problem& p){ return p.has_scalar_form(); },
+            [](const Problem& p, size_t steps, size_t& evaluations){
+                adfunc f = [&](adouble t, const advec& y){ ++evaluations; return p.adscalar(t, y); };
+                return solve_scalar<EulerImplicit>(p, f, steps);
+            }});
+        out.push_back({"euler_explicit_system", 1,
+            [](const Problem& p){ return true; },
+            [](const Problem& p, size_t steps, size_t& evaluations){
+                sysfunc f = [&](double t, const vec& y, vec& dydt){ ++evaluations; p.system(t, y, dydt); };
+                return solve_system<EulerExplicit>(p, f, steps);
+            }});
+        out.push_back({"euler_implicit_system", 1,
+            [](const Problem& p){ return true; },
+            [](const Problem& p, size_t steps, size_t& evaluations){
+                adsysfunc f = [&](adouble t, const advec& y, advec& dydt){ ++evaluations; p.adsystem(t, y, dydt); };
+                return solve_system<EulerImplicit>(p, f, steps);
+            }});
+        out.push_back({"euler_implicit_finite_difference", 1,
+            [](const Problem& p){ return true; },
+            [](const Problem& p, size_t steps, size_t& evaluations){
+                sysfunc f = [&](double t, const vec& y, vec& dydt){ ++evaluations; p.system(t, y, dydt); };
+                return solve_system<EulerImplicit>(p, f, steps);
+            }});
+        out.push_back({"tr_bdf2_system", 2,
+            [](const Problem& p){ return true; },
+            [](const Problem& p, size_t steps, size_t& evaluations){
+                return solve_sdirk(p, SDIRK::tr_bdf2(), steps, evaluations, false);
+            }});
+        out.push_back({"sdirk4_system", 4,
+            [](const Problem& p){ return true; },
+            [](const Problem& p, size_t steps, size_t& evaluations){
+                return solve_sdirk(p, SDIRK::sdirk4(), steps, evaluations, false);
+            }});
+        out.push_back({"sdirk4_adaptive_system", 0,
+            [](const Problem& p){ return true; },
+            [](const Problem& p, size_t steps, size_t& evaluations){
+                return solve_sdirk(p, SDIRK::sdirk4(), steps, evaluations, true);
+            }});
+        out.push_back({"radau5_system", 5,
+            [](const Problem& p){ return true; },
+            [](const Problem& p, size_t steps, size_t& evaluations){
+                return solve_radau(p, steps, evaluations, false);
+            }});
+        out.push_back({"radau5_adaptive_system", 0,
+            [](const Problem& p){ return true; },
+            [](const Problem& p, size_t steps, size_t& evaluations){
+                return solve_radau(p, steps, evaluations, true);
+            }});
+        out.push_back({"exponential_euler_system", 2,
+            [](const Problem& p){ return true; },
+            [](const Problem& p, size_t steps, size_t& evaluations){
+                return solve_exponential(p, Exponential::Method::rosenbrock_euler, steps, evaluations);
+            }});
+        out.push_back({"exprb32_system", 3,
+            [](const Problem& p){ return true; },
+            [](const Problem& p, size_t steps, size_t& evaluations){
+                return solve_exponential(p, Exponential::Method::exprb32, steps, evaluations);
+            }});
+        out.push_back({"sdc_system", 3,
+            [](const Problem& p){ return true; },
+            [](const Problem& p, size_t steps, size_t& evaluations){
+                return solve_sdc(p, SDC::Sweeper::implicit_euler, steps, evaluations);
+            }});
+        out.push_back({"sdc_explicit_system", 3,
+            [](const Problem& p){ return !p.stiff; },
+            [](const Problem& p, size_t steps, size_t& evaluations){
+                return solve_sdc(p, SDC::Sweeper::explicit_euler, steps, evaluations);
+            }});
+        out.push_back({"heun_system", 2,
+            [](const Problem& p){ return true; },
+            [](const Problem& p, size_t steps, size_t& evaluations){
+                return solve_tableau<Tableaus::heun>(p, steps, evaluations);
+            }});
+        out.push_back({"ssprk3_system", 3,
+            [](const Problem& p){ return true; },
+            [](const Problem& p, size_t steps, size_t& evaluations){
+                return solve_tableau<Tableaus::ssprk3>(p, steps, evaluations);
+            }});
+        out.push_back({"rk4_system", 4,
+            [](const Problem& p){ return true; },
+            [](const Problem& p, size_t steps, size_t& evaluations){
+                return solve_tableau<Tableaus::rk4>(p, steps, evaluations);
+            }});
+        out.push_back({"low_storage_rk3_system", 3,
+            [](const Problem& p){ return true; },
+            [](const Problem& p, size_t steps, size_t& evaluations){
+                sysfunc f = [&](double t, const vec& y, vec& dydt){ ++evaluations; p.system(t, y, dydt); };
+                LowStorageRK solver(p.t0, p.t_end, LowStorageRK::williamson3());
+                solver.set_time_step((p.t_end - p.t0)/steps);
+                return solver.solve(f, p.y0, [](double, const vec&){});
+            }});
+        out.push_back({"low_storage_rk4_system", 4,
+            [](const Problem& p){ return true; },
+            [](const Problem& p, size_t steps, size_t& evaluations){
+                sysfunc f = [&](double t, const vec& y, vec& dydt){ ++evaluations; p.system(t, y, dydt); };
+                LowStorageRK solver(p.t0, p.t_end, LowStorageRK::carpenter_kennedy4());
+                solver.set_time_step((p.t_end - p.t0)/steps);
+                return solver.solve(f, p.y0, [](double, const vec&){});
+            }});
+        out.push_back({"rkc_system", 2,
+            [](const Problem& p){ return true; },
+            [](const Problem& p, size_t steps, size_t& evaluations){
+                sysfunc f = [&](double t, const vec& y, vec& dydt){ ++evaluations; p.system(t, y, dydt); };
+                RKC solver(p.t0, p.t_end);
+                solver.set_time_step((p.t_end - p.t0)/steps);
+                return solver.solve(f, p.y0, [](double, const vec&){});
+            }});
+        out.push_back({"adams_pece_system", 0,
+            [](const Problem& p){ return !p.stiff; },
+            [](const Problem& p, size_t steps, size_t& evaluations){
+                sysfunc f = [&](double t, const vec& y, vec& dydt){ ++evaluations; p.system(t, y, dydt); };
+                AdamsPECE solver(p.t0, p.t_end);
+                solver.set_tolerances(level_tolerance(p, steps), level_tolerance(p, steps));
+                return solver.solve(f, p.y0, [](double, const vec&){});
+            }});
+        return out;
+    }
+
+    // Observed order from the two finest levels with a finite error above round-off
+    double observed_order(const std::vector<Point>& points){
+        for (size_t i = points.size(); i-- > 1;){
+            const Point& fine = points[i];
+            const Point& coarse = points[i-1];
+            if (std::isfinite(coarse.error) && std::isfinite(fine.error) && fine.error > 1e-12 && coarse.error < 1.){
+                return std::log(coarse.error/fine.error)/std::log(static_cast<double>(fine.steps)/coarse.steps);
+            }
+        }
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+
+    std::vector<std::string> split(const std::string& list){
+        std::vector<std::string> out;
+        std::stringstream ss(list);
+        std::string item;
+        while (std::getline(ss, item, ',')){
+            out.push_back(item);
+        }
+        return out;
+    }
+
+    bool selected(const std::string& name, const std::vector<std::string>& filter){
+        if (filter.empty()){
+            return true;
+        }
+        for (auto& f : filter){
+            if (name == f){
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void write_number(std::ostream& out, double value){
+        if (std::isfinite(value)){
+            out << value;
+        }
+        else{
+            out << "null";
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    size_t levels = 8;
+    std::string json;
+    std::vector<std::string> problem_filter, method_filter;
+    bool check_order = false;
+    double order_tolerance = 0.2;
+    try{
+        for (int i = 1; i < argc; ++i){
+            const std::string arg = argv[i];
+            if (arg == "--check-order"){
+                check_order = true;
+                continue;
+            }
+            if (i+1 >= argc){
+                throw std::invalid_argument("Missing value for option " + arg);
+            }
+            const std::string value = argv[++i];
+            if (arg == "--levels"){
+                levels = std::stoul(value);
+            }
+            else if (arg == "--problems"){
+                problem_filter = split(value);
+            }
+            else if (arg == "--methods"){
+                method_filter = split(value);
+            }
+            else if (arg == "--json"){
+                json = value;
+            }
+            else if (arg == "--order-tolerance"){
+                order_tolerance = std::stod(value);
+            }
+            else{
+                throw std::invalid_argument("Unknown option " + arg);
+            }
+        }
+    }
+    catch (std::exception& e){
+        std::cerr << e.what() << std::endl << "Usage: bench_workprecision [--levels N] [--problems a,b] "
+                  << "[--methods a,b] [--json FILE] [--check-order] [--order-tolerance X]" << std::endl;
+        return -1;
+    }
+
+    std::ofstream out;
+    if (!json.empty()){
+        out.open(json);
+        if (!out.is_open()){
+            std::cerr << "Couldn't open " << json << std::endl;
+            return -1;
+        }
+        out << std::setprecision(9) << "{\"runs\": [";
+    }
+    bool first_run = true;
+    int order_failures = 0;
+    for (const Problem& problem : corpus()){
+        if (!selected(problem.name, problem_filter)){
+            continue;
+        }
+        for (const Method& method : methods()){
+            if (!selected(method.name, method_filter)){
+                continue;
+            }
+            if (!method.supports(problem)){
+                std::cout << problem.name << " / " << method.name << ": not supported" << std::endl;
+                continue;
+            }
+            std::cout << problem.name << " / " << method.name << std::endl
+                      << std::setw(12) << "steps" << std::setw(14) << "error"
+                      << std::setw(14) << "time [s]" << std::setw(14) << "RHS evals" << std::endl;
+            std::vector<Point> points;
+            for (size_t level = 0; level < levels; ++level){
+                Point point;
+                point.steps = problem.steps << level;
+                point.evaluations = 0;
+                auto t0 = std::chrono::steady_clock::now();
+                vec y;
+                try{
+                    y = method.run(problem, point.steps, point.evaluations);
+                }
+                catch (const std::exception& e){
+                    y = vec(problem.y0.size(), std::nan(""));
+                }
+                auto t1 = std::chrono::steady_clock::now();
+                point.seconds = std::chrono::duration<double>(t1 - t0).count();
+                point.error = solution_error(problem, y);
+                points.push_back(point);
+                std::cout << std::setw(12) << point.steps << std::setw(14) << point.error
+                          << std::setw(14) << point.seconds << std::setw(14) << point.evaluations << std::endl;
+            }
+            const double order = observed_order(points);
+            // e.g. exponential integrators on linear problems, there is no order to observe
+            const bool exact = std::all_of(points.begin(), points.end(), [](const Point& point){
+                return point.error <= 1e-12;
+            });
+            const bool order_ok = method.order == 0 || exact || std::abs(order - method.order) <= order_tolerance;
+            if (method.order == 0){
+                std::cout << "adaptive, steps of the level set the tolerance" << std::endl << std::endl;
+            }
+            else if (exact){
+                std::cout << "exact to round-off on every level" << std::endl << std::endl;
+            }
+            else{
+                std::cout << "observed order " << order << " (expected " << method.order << ")"
+                          << (order_ok ? "" : "  MISMATCH") << std::endl << std::endl;
+            }
+            // stiff problems reach the asymptotic regime late, only non-stiff ones are checked
+            if (check_order && !problem.stiff && !order_ok){
+                ++order_failures;
+            }
+            if (out.is_open()){
+                out << (first_run ? "" : ",") << std::endl << "  {\"problem\": \"" << problem.name
+                    << "\", \"method\": \"" << method.name << "\", \"stiff\": " << (problem.stiff ? "true" : "false")
+                    << ", \"expected_order\": " << method.order << ", \"observed_order\": ";
+                write_number(out, order);
+                out << "," << std::endl << "   \"points\": [";
+                for (size_t i = 0; i < points.size(); ++i){
+                    out << (i ? ", " : "") << "{\"steps\": " << points[i].steps << ", \"error\": ";
+                    write_number(out, points[i].error);
+                    out << ", \"seconds\": " << points[i].seconds << ", \"rhs_evaluations\": "
+                        << points[i].evaluations << "}";
+                }
+                out << "]}";
+                first_run = false;
+            }
+        }
+    }
+    if (out.is_open()){
+        out << std::endl << "]}" << std::endl;
+    }
+    if (order_failures){
+        std::cout << order_failures << " run(s) didn't reach the expected order" << std::endl;
+        return 1;
+    }
+    return 0;
+}